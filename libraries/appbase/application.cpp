@@ -4,6 +4,7 @@
 #include <hive/utilities/notifications.hpp>
 #include <hive/utilities/options_description_ex.hpp>
 
+#include <fc/log/async_log_queue.hpp>
 #include <fc/thread/thread.hpp>
 
 #include <boost/algorithm/string.hpp>
@@ -67,7 +68,10 @@ application::application()
 {
 }
 
-application::~application() { }
+application::~application()
+{
+  fc::async_log_queue::stop();
+}
 
 void application::init_signals_handler()
 {
@@ -98,6 +102,11 @@ fc::optional< fc::logging_config > application::load_logging_config()
       wlog( "Error parsing logging config. ${e}", ("e", e.to_string()) );
     }
   }).wait();
+
+  const uint32_t async_queue_size = args.count( "log-async-queue-size" ) ? args.at( "log-async-queue-size" ).as< uint32_t >() : 0;
+  if( async_queue_size > 0 )
+    fc::async_log_queue::start( async_queue_size );
+
   ilog("Logging thread started");
   return logging_config;
 }
@@ -376,6 +385,8 @@ void application::finish()
       pre_shutdown( _actual_plugin_name );
       shutdown( _actual_plugin_name );
 
+      fc::async_log_queue::stop();
+
       fc::promise<void>::ptr quitDone( new fc::promise<void>("Logging thread quit") );
       my->_logging_thread.quit( quitDone.get() );
       quitDone->wait();
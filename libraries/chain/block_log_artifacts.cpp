@@ -17,7 +17,10 @@
 #include <boost/interprocess/sync/file_lock.hpp>
 
 #include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <map>
@@ -171,6 +174,8 @@ inline size_t calculate_block_serialized_data_size(const artifact_file_chunk& ne
   return next_chunk.block_log_offset - this_chunk.block_log_offset - sizeof(uint64_t);
 }
 
+static_assert(sizeof(artifact_file_header) % alignof(artifact_file_chunk) == 0, "Chunks read from mapped file have to be properly aligned");
+
 } /// anonymous
 
 
@@ -189,7 +194,7 @@ public:
 
   uint32_t read_head_block_num() const
   {
-    return _header.head_block_num;
+    return _head_block_num.load(std::memory_order_acquire);
   }
 
   /** Chunk processor arguments:
@@ -210,7 +215,7 @@ public:
   void update_head_block(uint32_t block_num)
   {
     FC_ASSERT(_is_writable, "Block log artifacts was opened in read only mode.");
-    _header.head_block_num = block_num;
+    set_head_block_num(block_num);
   }
 
   bool is_open() const
@@ -229,6 +234,7 @@ public:
     HANDLE_IO((::close(_storage_fd)), "Closing the artifact file");
 
     _storage_fd = -1;
+    unmap_file();
 
     ilog("Block log artifact file closed.");
   }
@@ -251,8 +257,18 @@ public:
 private:
   bool load_header();
 
+  /// Header copy is only touched by writer, readers rely on head block number published after artifacts are written
+  void set_head_block_num(uint32_t block_num)
+  {
+    _header.head_block_num = block_num;
+    _head_block_num.store(block_num, std::memory_order_release);
+  }
+
+  void ensure_mapped(size_t file_size);
+  void unmap_file();
+
   void generate_artifacts_file(const block_log& source_block_provider, hive::chain::blockchain_worker_thread_pool& thread_pool);
-  void verify_if_blocks_from_block_log_matches_artifacts(const block_log& source_block_provider, const bool full_match_verification, const bool use_block_log_head_num) const;
+  void verify_if_blocks_from_block_log_matches_artifacts(const block_log& source_block_provider, const bool full_match_verification, const bool use_block_log_head_num, hive::chain::blockchain_worker_thread_pool& thread_pool) const;
   
   template <class Data>
   void write_data(const Data& buffer, off_t offset, const std::string& description) const
@@ -299,10 +315,27 @@ private:
     return _block_num_to_file_pos_offset + new_tail;
   }
 
+  /// Read only mapping of (part of) artifacts file, possibly extending past its current end.
+  struct file_mapping
+  {
+    const char* data = nullptr;
+    size_t size = 0;
+  };
+
 private:
   fc::path _artifact_file_name;
   int _storage_fd = -1; /// file descriptor to the opened file.
   artifact_file_header _header;
+  std::atomic<uint32_t> _head_block_num = { 0 };
+  /** Artifacts are read directly from mapped file, so block num to offset/id resolution takes no syscalls.
+  *   When writes outgrow current mapping, bigger one is created and published, but the old ones stay valid until
+  *   the file is closed, so concurrent readers never wait for the writer.
+  */
+  std::atomic<const file_mapping*> _mapping = { nullptr };
+  std::vector<std::unique_ptr<file_mapping>> _all_mappings;
+  /// Writable mapping extends past end of file and accessing pages there raises SIGBUS, so reads are also checked
+  /// against size of written (and not truncated) part of the file.
+  std::atomic<size_t> _file_size = { 0 };
   const size_t header_pack_size = sizeof(_header);
   const size_t artifact_chunk_size = sizeof(artifact_file_chunk);
   boost::interprocess::file_lock _flock;
@@ -403,7 +436,7 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
       FC_THROW("Artifacts file generating process is not finished.");
     }
     
-    verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, false);
+    verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, false, thread_pool);
   }
 
   else
@@ -432,7 +465,7 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
         if (block_log_head_block_num > 0)
         {
           _header.tail_block_num = calculate_tail_block_num(1);
-          _header.head_block_num = block_log_head_block_num;
+          set_head_block_num(block_log_head_block_num);
           flush_header();
           generate_artifacts_file(source_block_provider, thread_pool);
         }
@@ -461,7 +494,7 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
           if (_header.generating_interrupted_at_block > block_log_head_block_num)
             FC_THROW("Artifacts file has been filled up to ${interrupted_at_block} block, truncating artifacts file will result an empty file. Remove artifacts file and create artifacts from the beggining.", ("interrupted_at_block", _header.generating_interrupted_at_block));
 
-          verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, true);
+          verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, true, thread_pool);
           truncate_file(block_log_head_block_num);
 
           if (_header.generating_interrupted_at_block)
@@ -469,7 +502,7 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
         }
         else
         {
-          verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, false);
+          verify_if_blocks_from_block_log_matches_artifacts(source_block_provider, full_match_verification, false, thread_pool);
 
           if (_header.generating_interrupted_at_block)
             generate_artifacts_file(source_block_provider, thread_pool);
@@ -480,7 +513,7 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
                 ("header_head_block_num", _header.head_block_num)(block_log_head_block_num));
 
             _header.tail_block_num = _header.head_block_num ? _header.head_block_num : calculate_tail_block_num(1);
-            _header.head_block_num = block_log_head_block_num;
+            set_head_block_num(block_log_head_block_num);
             flush_header();
             generate_artifacts_file(source_block_provider, thread_pool);
           }
@@ -497,14 +530,16 @@ void block_log_artifacts::impl::open(const fc::path& block_log_file_path, const
           FC_THROW("Error creating block artifacts file ${_artifact_file_name}: ${error}", (_artifact_file_name)("error", strerror(errno)));
         else
         {
+          unmap_file();
           _header = artifact_file_header();
+          set_head_block_num(0);
           _header.dirty_close = 1;
           flush_header();
 
           if (block_log_head_block_num)
           {
             _header.tail_block_num = calculate_tail_block_num(1);
-            _header.head_block_num = block_log_head_block_num;
+            set_head_block_num(block_log_head_block_num);
             flush_header();
             generate_artifacts_file(source_block_provider, thread_pool);
           }
@@ -527,14 +562,20 @@ bool block_log_artifacts::impl::load_header()
     ilog("Loaded header containing: git rev: ${gr}, format version: ${major}.${minor}, head_block_num: ${hb}, tail_block_num: ${tbn}, generating_interrupted_at_block: ${giat}, dirty_closed: ${dc}",
          ("gr", _header.git_version)("major", _header.format_major_version)("minor", _header.format_minor_version)("hb", _header.head_block_num)("tbn", _header.tail_block_num)
          ("giat", _header.generating_interrupted_at_block)("dc", _header.dirty_close));
-
-    return true;
   }
   catch (const fc::exception& e)
   {
     wlog("Loading the artifact file header failed: ${e}", ("e", e.to_detail_string()));
     return false;
   }
+
+  struct stat file_stats;
+  if (fstat(_storage_fd, &file_stats) == -1)
+    FC_THROW("Error getting info on file: ${error}", ("error", strerror(errno)));
+  ensure_mapped(file_stats.st_size);
+  set_head_block_num(_header.head_block_num);
+
+  return true;
 }
 
 void block_log_artifacts::impl::flush_header() const
@@ -554,6 +595,38 @@ void block_log_artifacts::impl::flush_header() const
   //  ("gr", _h2.git_version)("major", _h2.format_major_version)("minor", _h2.format_minor_version)("hb", _h2.head_block_num)("d", _h2.dirty_close));
 } FC_CAPTURE_AND_RETHROW() }
 
+void block_log_artifacts::impl::ensure_mapped(size_t file_size)
+{
+  /// data up to file_size is already written, so it is published before (possibly) bigger mapping
+  if (file_size > _file_size.load(std::memory_order_relaxed))
+    _file_size.store(file_size, std::memory_order_release);
+
+  const file_mapping* current = _mapping.load(std::memory_order_relaxed);
+  if (file_size == 0 || (current != nullptr && current->size >= file_size))
+    return;
+
+  /// File of writable artifacts grows with every block, so reserve room for more to avoid remapping too often.
+  /// Pages past the end of file are never touched, since readers only access artifacts of blocks below head.
+  constexpr size_t MIN_WRITABLE_MAPPING_SIZE = 64 * 1024 * 1024;
+  const size_t mapping_size = _is_writable ? std::max(2 * file_size, MIN_WRITABLE_MAPPING_SIZE) : file_size;
+
+  void* data = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, _storage_fd, 0);
+  if (data == MAP_FAILED)
+    FC_THROW("Error mapping block artifacts file ${_artifact_file_name}: ${error}", (_artifact_file_name)("error", strerror(errno)));
+
+  _all_mappings.emplace_back(std::make_unique<file_mapping>(file_mapping{static_cast<const char*>(data), mapping_size}));
+  _mapping.store(_all_mappings.back().get(), std::memory_order_release);
+}
+
+void block_log_artifacts::impl::unmap_file()
+{
+  _mapping.store(nullptr, std::memory_order_release);
+  _file_size.store(0, std::memory_order_release);
+  for (const auto& mapping : _all_mappings)
+    HANDLE_IO((munmap(const_cast<char*>(mapping->data), mapping->size)), "Unmapping the artifact file");
+  _all_mappings.clear();
+}
+
 void block_log_artifacts::impl::generate_artifacts_file(const block_log& source_block_provider, hive::chain::blockchain_worker_thread_pool& thread_pool)
 {
   const uint32_t starting_block_num = _header.generating_interrupted_at_block ? _header.generating_interrupted_at_block : _header.head_block_num;
@@ -665,7 +738,7 @@ void block_log_artifacts::impl::generate_artifacts_file(const block_log& source_
     (elapsed_time)(processed_blocks_count)("was_interrupted", (static_cast<bool>(_header.generating_interrupted_at_block))));
 }
 
-void block_log_artifacts::impl::verify_if_blocks_from_block_log_matches_artifacts(const block_log& source_block_provider, const bool full_match_verification, const bool use_block_log_head_num) const
+void block_log_artifacts::impl::verify_if_blocks_from_block_log_matches_artifacts(const block_log& source_block_provider, const bool full_match_verification, const bool use_block_log_head_num, hive::chain::blockchain_worker_thread_pool& thread_pool) const
 {
   constexpr uint32_t BLOCKS_SAMPLE_AMOUNT = 10;
 
@@ -695,34 +768,58 @@ void block_log_artifacts::impl::verify_if_blocks_from_block_log_matches_artifact
 
   try
   {
+    /// Blocks are read in batches and handed over to the worker pool, so their ids (the expensive part: decompression
+    /// and header hashing) are computed in parallel while checks below stay in block order.
+    constexpr uint32_t VERIFICATION_BATCH_SIZE = 10000;
+
+    struct block_to_verify
+    {
+      artifacts_t block_artifacts;
+      std::shared_ptr<full_block_type> full_block;
+    };
+
+    std::vector<block_to_verify> batch;
+    batch.reserve(std::min(VERIFICATION_BATCH_SIZE, first_block_to_verify - last_block_num_to_verify));
     uint32_t counter = 0;
 
     while(block_num > last_block_num_to_verify)
     {
-      const auto block_artifacts = read_block_artifacts(block_num);
-      const auto full_block = source_block_provider.read_block_by_offset(block_artifacts.block_log_file_pos, block_artifacts.block_serialized_data_size, block_artifacts.attributes);
-      if (full_block->get_block_id() != block_artifacts.block_id)
-        FC_THROW("Full block got by offset has malformed ID");
-      if (full_block->has_compressed_block_data())
+      const uint32_t batch_first_block_num = block_num;
+      batch.clear();
+      for (; block_num > last_block_num_to_verify && batch.size() < VERIFICATION_BATCH_SIZE; --block_num)
       {
-        const auto& compressed_block_data = full_block->get_compressed_block();
-        if (compressed_block_data.compressed_size != block_artifacts.block_serialized_data_size)
-          FC_THROW("Full block got by offset has malformed compress block size!");
-        if (compressed_block_data.compression_attributes.flags != block_artifacts.attributes.flags)
-          FC_THROW("Full block got by offset has malformed compress block attributes flags!");
-        if (compressed_block_data.compression_attributes.dictionary_number != block_artifacts.attributes.dictionary_number)
-          FC_THROW("Full block got by offset has malformed compress block attributes dictionary number!");
+        auto block_artifacts = read_block_artifacts(block_num);
+        auto full_block = source_block_provider.read_block_by_offset(block_artifacts.block_log_file_pos, block_artifacts.block_serialized_data_size, block_artifacts.attributes);
+        thread_pool.enqueue_work(full_block, blockchain_worker_thread_pool::data_source_type::block_log_for_artifact_generation);
+        batch.push_back({ std::move(block_artifacts), std::move(full_block) });
       }
-      else if (full_block->get_uncompressed_block_size() != block_artifacts.block_serialized_data_size)
-        FC_THROW("Full block got by offset has malformed uncompressed block size!");
-
-      --block_num;
-      ++counter;
 
-      if (counter >= 1000000)
+      block_num = batch_first_block_num;
+      for (const auto& [block_artifacts, full_block] : batch)
       {
-        dlog("artifacts verification in progress - just verified artifacts for block number: ${block_num}", (block_num));
-        counter = 0;
+        if (full_block->get_block_id() != block_artifacts.block_id)
+          FC_THROW("Full block got by offset has malformed ID");
+        if (full_block->has_compressed_block_data())
+        {
+          const auto& compressed_block_data = full_block->get_compressed_block();
+          if (compressed_block_data.compressed_size != block_artifacts.block_serialized_data_size)
+            FC_THROW("Full block got by offset has malformed compress block size!");
+          if (compressed_block_data.compression_attributes.flags != block_artifacts.attributes.flags)
+            FC_THROW("Full block got by offset has malformed compress block attributes flags!");
+          if (compressed_block_data.compression_attributes.dictionary_number != block_artifacts.attributes.dictionary_number)
+            FC_THROW("Full block got by offset has malformed compress block attributes dictionary number!");
+        }
+        else if (full_block->get_uncompressed_block_size() != block_artifacts.block_serialized_data_size)
+          FC_THROW("Full block got by offset has malformed uncompressed block size!");
+
+        --block_num;
+        ++counter;
+
+        if (counter >= 1000000)
+        {
+          dlog("artifacts verification in progress - just verified artifacts for block number: ${block_num}", (block_num));
+          counter = 0;
+        }
       }
     }
   }
@@ -759,11 +856,15 @@ void block_log_artifacts::impl::truncate_file(uint32_t last_block)
   /// File truncate should be done just after last data chunk stored.
   auto truncate_position = last_chunk_position + artifact_chunk_size;
 
+  /// head_block_num and file size must be updated before truncation, so mapped chunks past new end of file are no
+  /// longer read
+  update_head_block(last_block);
+  if (truncate_position < _file_size.load(std::memory_order_relaxed))
+    _file_size.store(truncate_position, std::memory_order_release);
+
   if (ftruncate(_storage_fd, truncate_position) == -1)
     FC_THROW("Error truncating block artifact file: ${error}", ("error", strerror(errno)));
 
-  /// head_block_num must be updated
-  update_head_block(last_block);
   if (_header.generating_interrupted_at_block > _header.head_block_num)
     _header.generating_interrupted_at_block = _header.head_block_num;
 
@@ -772,19 +873,25 @@ void block_log_artifacts::impl::truncate_file(uint32_t last_block)
 
 void block_log_artifacts::impl::process_block_artifacts(uint32_t block_num, uint32_t count, artifact_file_chunk_processor_t processor) const
 {
-  FC_ASSERT(block_num != _header.head_block_num, "It's not possible to read head block artifacts.");
-
+  const uint32_t head_block_num = read_head_block_num();
+  FC_ASSERT(block_num != head_block_num, "It's not possible to read head block artifacts.");
+  /// chunk following last requested one is also needed (to calculate block size), so it has to be present in the file
+  FC_ASSERT(block_num > _block_num_to_file_pos_offset && count > 0 && uint64_t(block_num) + count <= head_block_num,
+    "Artifacts of blocks ${block_num}..${last_block_num} are out of stored range (head block: ${head_block_num})",
+    (block_num)("last_block_num", uint64_t(block_num) + count - 1)(head_block_num));
+
+  const file_mapping* mapping = _mapping.load(std::memory_order_acquire);
+  const size_t file_size = _file_size.load(std::memory_order_acquire);
   auto chunk_position = calculate_offset(block_num);
+  const size_t chunks_size = (count + 1) * artifact_chunk_size;
+  FC_ASSERT(mapping != nullptr && chunk_position + chunks_size <= mapping->size, "Artifacts of block ${block_num} are not mapped", (block_num));
+  FC_ASSERT(chunk_position + chunks_size <= file_size, "Artifacts of block ${block_num} are past end of artifacts file (size: ${file_size})",
+    (block_num)(file_size));
 
-  std::vector<artifact_file_chunk> chunk_buffer;
-
-  chunk_buffer.resize(count + 1);
-
-  read_data(chunk_buffer.data(), chunk_buffer.size(), chunk_position, "Reading an artifact data chunk");
-
-  const artifact_file_chunk& next_chunk = chunk_buffer.back();
+  /// file keeps properly aligned chunks just after the header, so they can be processed in place
+  const artifact_file_chunk* chunk_buffer = reinterpret_cast<const artifact_file_chunk*>(mapping->data + chunk_position);
 
-  processor(block_num, chunk_buffer.data(), count, next_chunk);
+  processor(block_num, chunk_buffer, count, chunk_buffer[count]);
 }
 
 void block_log_artifacts::impl::store_block_artifacts(uint32_t block_num, uint64_t block_log_file_pos,
@@ -804,6 +911,7 @@ void block_log_artifacts::impl::store_block_artifacts(uint32_t block_num, uint64
 
   auto write_position = calculate_offset(block_num);
   write_data(data_chunk, write_position, "Wrting the artifact file datachunk");
+  ensure_mapped(write_position + artifact_chunk_size);
 }
 
 void block_log_artifacts::impl::store_block_artifacts(artifact_data_container_t& artifacts_data)
@@ -834,6 +942,7 @@ void block_log_artifacts::impl::store_block_artifacts(artifact_data_container_t&
     uint32_t first_block_num = std::get<0>(artifacts_data.front());
     auto write_position = calculate_offset(first_block_num);
     write_data<artifact_file_chunk>(*(the_buffer.get()), count, write_position, "Writing a batch of artifact file datachunks");
+    ensure_mapped(write_position + count * artifact_chunk_size);
   }
   FC_CAPTURE_LOG_AND_RETHROW((count))
 }
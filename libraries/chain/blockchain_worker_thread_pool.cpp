@@ -317,6 +317,15 @@ void blockchain_worker_thread_pool::impl::perform_work(const work_request_type::
         {
         }
       }
+
+      // RC usage is counted for every transaction, regardless of validation settings
+      try
+      {
+        full_transaction->compute_rc_resource_scan();
+      }
+      catch (...)
+      {
+      }
       break;
     case blockchain_worker_thread_pool::data_source_type::transaction_inside_block_for_replay:
       // by default very little checking is done during replay, unless you specify --validate_during_replay
@@ -353,6 +362,14 @@ void blockchain_worker_thread_pool::impl::perform_work(const work_request_type::
         catch (...)
         {
         }
+
+        try
+        {
+          full_transaction->compute_rc_resource_scan();
+        }
+        catch (...)
+        {
+        }
       }
       break;
     case blockchain_worker_thread_pool::data_source_type::standalone_transaction_received_from_p2p:
@@ -380,6 +397,14 @@ void blockchain_worker_thread_pool::impl::perform_work(const work_request_type::
       catch (...)
       {
       }
+
+      try
+      {
+        full_transaction->compute_rc_resource_scan();
+      }
+      catch (...)
+      {
+      }
       break;
     default:
       elog("invalid data source type for transaction");
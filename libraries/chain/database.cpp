@@ -171,6 +171,8 @@ void database::pre_open( const open_args& args )
                                                 theApp.get_plugins_names(),
                                                 []( const std::string& message ){ wlog( message.c_str() ); }
                                               );
+    set_numa_nodes( args.shared_file_numa_nodes );
+    set_max_shared_file_size( args.shared_file_max_size );
     chainbase::database::open( args.shared_mem_dir, args.chainbase_flags, args.shared_file_size, args.database_cfg, &environment_extension, args.force_replay /* wipe_shared_file */ );
     initialize_irreversible_storage();
   }
@@ -320,6 +322,8 @@ void database::close()
     // DB state (issue #336).
     clear_pending();
 
+    _notification_observers.flush();
+
     chainbase::database::flush();
 
     auto lib = this->get_last_irreversible_block_num();
@@ -846,6 +850,14 @@ void database::notify_pre_apply_operation( const operation_notification& note )
 void database::notify_post_apply_operation( const operation_notification& note )
 {
   HIVE_TRY_NOTIFY( _post_apply_operation_signal, note )
+  // observers have no undo, so they only see operations of blocks being applied - not of pending transactions
+  // (which are applied again in a block) nor of block production (which is reverted and then applied as a block)
+  if( !_post_apply_operation_observation_signal.empty() && is_processing_block() && !is_producing_block() )
+  {
+    // observers see notification after state-mutating handlers did; one copy is shared by all of them
+    auto observation = std::make_shared< const operation_observation >( note );
+    HIVE_TRY_NOTIFY( _post_apply_operation_observation_signal, observation )
+  }
 }
 
 void database::notify_pre_apply_block( const block_notification& note )
@@ -856,6 +868,7 @@ void database::notify_pre_apply_block( const block_notification& note )
 void database::notify_irreversible_block( uint32_t block_num )
 {
   HIVE_TRY_NOTIFY( _on_irreversible_block, block_num )
+  HIVE_TRY_NOTIFY( _irreversible_block_observation_signal, block_num )
 }
 
 void database::notify_switch_fork( uint32_t block_num )
@@ -866,6 +879,11 @@ void database::notify_switch_fork( uint32_t block_num )
 void database::notify_post_apply_block( const block_notification& note )
 {
   HIVE_TRY_NOTIFY( _post_apply_block_signal, note )
+  if( !_post_apply_block_observation_signal.empty() )
+  {
+    auto observation = std::make_shared< const block_observation >( note );
+    HIVE_TRY_NOTIFY( _post_apply_block_observation_signal, observation )
+  }
 }
 
 void database::notify_fail_apply_block( const block_notification& note )
@@ -3874,7 +3892,9 @@ void database::check_free_memory( bool force_print, uint32_t current_block_num )
 
     wlog( "Memory is almost full, increasing to ${mem}M", ("mem", new_max / (1024*1024)) );
 
-    resize( new_max );
+    // in place growth works also when there are active undo sessions (live mode), full resize is a fallback
+    if( !grow( new_max ) )
+      resize( new_max );
 
     uint32_t free_mb = uint32_t( get_free_memory() / (1024*1024) );
     wlog( "Free memory is now ${free}M", ("free", free_mb) );
@@ -4494,7 +4514,10 @@ void database::_apply_transaction(const std::shared_ptr<full_transaction_type>&
     ++_current_op_in_trx;
   } FC_CAPTURE_AND_RETHROW( (op) ) }
 
-  rc.finalize_transaction( *full_transaction.get() );
+  {
+    util::operation_profiler::scope profile( _operation_profiler, util::operation_profiler::rc );
+    rc.finalize_transaction( *full_transaction.get() );
+  }
   notify_post_apply_transaction( note );
 
 } FC_CAPTURE_AND_RETHROW( (full_transaction->get_transaction()) ) }
@@ -4533,9 +4556,15 @@ void database::apply_operation(const operation& op)
   }
 
   if( has_hardfork( HIVE_HARDFORK_0_20 ) )
+  {
+    util::operation_profiler::scope profile( _operation_profiler, op, util::operation_profiler::rc );
     rc.handle_operation_discount< operation >( op );
+  }
 
-  _my->_evaluator_registry.get_evaluator( op ).apply( op );
+  {
+    util::operation_profiler::scope profile( _operation_profiler, op, util::operation_profiler::evaluator );
+    _my->_evaluator_registry.get_evaluator( op ).apply( op );
+  }
 
   if( _benchmark_dumper.is_enabled() )
     _benchmark_dumper.end( name );
@@ -4596,7 +4625,8 @@ boost::signals2::connection database::any_apply_operation_handler_impl( const ap
   const abstract_plugin& plugin, int32_t group )
 {
   std::string context = util::advanced_benchmark_dumper::generate_context_desc< IS_PRE_OPERATION >( plugin.get_name() );
-  auto complex_func = [this, func, &plugin, context]( const operation_notification& o )
+  const uint16_t profiler_handler = _operation_profiler.register_handler( plugin.get_name() );
+  auto complex_func = [this, func, &plugin, context, profiler_handler]( const operation_notification& o )
   {
     std::string name;
 
@@ -4606,7 +4636,11 @@ boost::signals2::connection database::any_apply_operation_handler_impl( const ap
       _benchmark_dumper.begin();
     }
 
-    func( o );
+    {
+      util::operation_profiler::scope profile( _operation_profiler, o.op,
+        IS_PRE_OPERATION ? util::operation_profiler::pre_handler : util::operation_profiler::post_handler, profiler_handler );
+      func( o );
+    }
 
     if (_benchmark_dumper.is_enabled())
       _benchmark_dumper.end( context, name );
@@ -4727,6 +4761,42 @@ boost::signals2::connection database::add_end_of_syncing_handler(const end_of_sy
   return connect_impl<false>(_end_of_syncing_signal, func, plugin, group, "->syncing_end");
 }
 
+template< typename TSignal, typename TObserver >
+boost::signals2::connection connect_observer( TSignal& signal, util::notification_observers& observers,
+  const TObserver& func, const abstract_plugin& plugin )
+{
+  auto queue = observers.get_queue( plugin.get_name() );
+  auto observer = std::make_shared< const TObserver >( func );
+  // observation is created once per notification (see notify_post_apply_operation) and shared by all queues
+  return signal.connect( [queue, observer]( const auto& observation )
+  {
+    queue->push( [observer, observation]() { ( *observer )( *observation ); } );
+  } );
+}
+
+boost::signals2::connection database::add_post_apply_operation_observer( const apply_operation_observer_t& func,
+  const abstract_plugin& plugin )
+{
+  return connect_observer( _post_apply_operation_observation_signal, _notification_observers, func, plugin );
+}
+
+boost::signals2::connection database::add_post_apply_block_observer( const apply_block_observer_t& func,
+  const abstract_plugin& plugin )
+{
+  return connect_observer( _post_apply_block_observation_signal, _notification_observers, func, plugin );
+}
+
+boost::signals2::connection database::add_irreversible_block_observer( const irreversible_block_handler_t& func,
+  const abstract_plugin& plugin )
+{
+  auto queue = _notification_observers.get_queue( plugin.get_name() );
+  auto observer = std::make_shared< const irreversible_block_handler_t >( func );
+  return _irreversible_block_observation_signal.connect( [queue, observer]( uint32_t block_num )
+  {
+    queue->push( [observer, block_num]() { ( *observer )( block_num ); } );
+  } );
+}
+
 const witness_object& database::validate_block_header( uint32_t skip, const std::shared_ptr<full_block_type>& full_block )const
 { try {
   const signed_block_header& next_block_header = full_block->get_block_header();
@@ -5413,7 +5483,10 @@ void database::modify_balance( const account_object& a, const asset& delta, bool
       op_context = "No operation context";
   }
 
-  modify( a, [&]( account_object& acnt )
+  // interest is paid while the account is being modified, but reported once it is written back
+  optional< asset > interest_paid;
+
+  modify_partial( a, [&]( account_object::undo_partial_type& acnt )
   {
     switch( delta.symbol.asset_num )
     {
@@ -5426,7 +5499,7 @@ void database::modify_balance( const account_object& a, const asset& delta, bool
 
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_balance().amount.value >= 0, "Insufficient HIVE funds" );
+          FC_ASSERT( acnt.balance.amount.value >= 0, "Insufficient HIVE funds" );
         }
         break;
       }
@@ -5443,19 +5516,10 @@ void database::modify_balance( const account_object& a, const asset& delta, bool
             auto interest = acnt.hbd_seconds / HIVE_SECONDS_PER_YEAR;
             interest *= get_dynamic_global_properties().get_hbd_interest_rate();
             interest /= HIVE_100_PERCENT;
-            asset interest_paid(fc::uint128_to_uint64(interest), HBD_SYMBOL);
-            acnt.hbd_balance += interest_paid;
+            interest_paid = asset(fc::uint128_to_uint64(interest), HBD_SYMBOL);
+            acnt.hbd_balance += *interest_paid;
             acnt.hbd_seconds = 0;
             acnt.hbd_last_interest_payment = head_block_time();
-
-            if(interest > 0)
-              push_virtual_operation( interest_operation( a.get_name(), interest_paid, true ) );
-
-            modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& props)
-            {
-              props.current_hbd_supply += interest_paid;
-              props.virtual_supply += interest_paid * get_feed_history().current_median_history;
-            } );
           }
         }
 
@@ -5467,7 +5531,7 @@ void database::modify_balance( const account_object& a, const asset& delta, bool
 
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_hbd_balance().amount.value >= 0, "Insufficient HBD funds" );
+          FC_ASSERT( acnt.hbd_balance.amount.value >= 0, "Insufficient HBD funds" );
         }
         break;
       }
@@ -5475,18 +5539,30 @@ void database::modify_balance( const account_object& a, const asset& delta, bool
         acnt.vesting_shares += delta;
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_vesting().amount.value >= 0, "Insufficient VESTS funds" );
+          FC_ASSERT( acnt.vesting_shares.amount.value >= 0, "Insufficient VESTS funds" );
         }
         break;
       default:
         FC_ASSERT( false, "invalid symbol" );
     }
   } );
+
+  if( interest_paid.valid() )
+  {
+    if( interest_paid->amount > 0 )
+      push_virtual_operation( interest_operation( a.get_name(), *interest_paid, true ) );
+
+    modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& props)
+    {
+      props.current_hbd_supply += *interest_paid;
+      props.virtual_supply += *interest_paid * get_feed_history().current_median_history;
+    } );
+  }
 }
 
 void database::modify_reward_balance( const account_object& a, const asset& value_delta, const asset& share_delta, bool check_balance )
 {
-  modify( a, [&]( account_object& acnt )
+  modify_partial( a, [&]( account_object::undo_partial_type& acnt )
   {
     switch( value_delta.symbol.asset_num )
     {
@@ -5496,7 +5572,7 @@ void database::modify_reward_balance( const account_object& a, const asset& valu
           acnt.reward_hive_balance += value_delta;
           if( check_balance )
           {
-            FC_ASSERT( acnt.get_rewards().amount.value >= 0, "Insufficient reward HIVE funds" );
+            FC_ASSERT( acnt.reward_hive_balance.amount.value >= 0, "Insufficient reward HIVE funds" );
           }
         }
         else
@@ -5505,7 +5581,7 @@ void database::modify_reward_balance( const account_object& a, const asset& valu
           acnt.reward_vesting_balance += share_delta;
           if( check_balance )
           {
-            FC_ASSERT( acnt.get_vest_rewards().amount.value >= 0, "Insufficient reward VESTS funds" );
+            FC_ASSERT( acnt.reward_vesting_balance.amount.value >= 0, "Insufficient reward VESTS funds" );
           }
         }
         break;
@@ -5514,7 +5590,7 @@ void database::modify_reward_balance( const account_object& a, const asset& valu
         acnt.reward_hbd_balance += value_delta;
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_hbd_rewards().amount.value >= 0, "Insufficient reward HBD funds" );
+          FC_ASSERT( acnt.reward_hbd_balance.amount.value >= 0, "Insufficient reward HBD funds" );
         }
         break;
       default:
@@ -5567,7 +5643,10 @@ void database::adjust_savings_balance( const account_object& a, const asset& del
 {
   bool check_balance = has_hardfork( HIVE_HARDFORK_0_20__1811 );
 
-  modify( a, [&]( account_object& acnt )
+  // interest is paid while the account is being modified, but reported once it is written back
+  optional< asset > interest_paid;
+
+  modify_partial( a, [&]( account_object::undo_partial_type& acnt )
   {
     switch( delta.symbol.asset_num )
     {
@@ -5575,7 +5654,7 @@ void database::adjust_savings_balance( const account_object& a, const asset& del
         acnt.savings_balance += delta;
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_savings().amount.value >= 0, "Insufficient savings HIVE funds" );
+          FC_ASSERT( acnt.savings_balance.amount.value >= 0, "Insufficient savings HIVE funds" );
         }
         break;
       case HIVE_ASSET_NUM_HBD:
@@ -5590,31 +5669,34 @@ void database::adjust_savings_balance( const account_object& a, const asset& del
             auto interest = acnt.savings_hbd_seconds / HIVE_SECONDS_PER_YEAR;
             interest *= get_dynamic_global_properties().get_hbd_interest_rate();
             interest /= HIVE_100_PERCENT;
-            asset interest_paid(fc::uint128_to_uint64(interest), HBD_SYMBOL);
-            acnt.savings_hbd_balance += interest_paid;
+            interest_paid = asset(fc::uint128_to_uint64(interest), HBD_SYMBOL);
+            acnt.savings_hbd_balance += *interest_paid;
             acnt.savings_hbd_seconds = 0;
             acnt.savings_hbd_last_interest_payment = head_block_time();
-
-            if(interest > 0)
-              push_virtual_operation( interest_operation( a.get_name(), interest_paid, false ) );
-
-            modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& props)
-            {
-              props.current_hbd_supply += interest_paid;
-              props.virtual_supply += interest_paid * get_feed_history().current_median_history;
-            } );
           }
         }
         acnt.savings_hbd_balance += delta;
         if( check_balance )
         {
-          FC_ASSERT( acnt.get_hbd_savings().amount.value >= 0, "Insufficient savings HBD funds" );
+          FC_ASSERT( acnt.savings_hbd_balance.amount.value >= 0, "Insufficient savings HBD funds" );
         }
         break;
       default:
         FC_ASSERT( !"invalid symbol" );
     }
   } );
+
+  if( interest_paid.valid() )
+  {
+    if( interest_paid->amount > 0 )
+      push_virtual_operation( interest_operation( a.get_name(), *interest_paid, false ) );
+
+    modify( get_dynamic_global_properties(), [&]( dynamic_global_property_object& props)
+    {
+      props.current_hbd_supply += *interest_paid;
+      props.virtual_supply += *interest_paid * get_feed_history().current_median_history;
+    } );
+  }
 }
 
 void database::adjust_reward_balance( const account_object& a, const asset& value_delta,
@@ -20,6 +20,8 @@ std::atomic<uint32_t> cached_get_signature_keys_calls = {0};
 std::atomic<uint32_t> non_cached_get_signature_keys_calls = {0};
 std::atomic<uint32_t> cached_get_required_authorities_calls = {0};
 std::atomic<uint32_t> non_cached_get_required_authorities_calls = {0};
+std::atomic<uint32_t> cached_get_rc_resource_scan_calls = {0};
+std::atomic<uint32_t> non_cached_get_rc_resource_scan_calls = {0};
 
 /* static */ std::atomic<uint32_t> full_transaction_type::number_of_instances_created = {0};
 /* static */ std::atomic<uint32_t> full_transaction_type::number_of_instances_destroyed = {0};
@@ -43,6 +45,8 @@ full_transaction_type::~full_transaction_type()
     fc_ilog(fc::logger::get("worker_thread"), "transaction signature keys pre-computed, but full_transaction_type::get_signature_keys() was never called");
   if (has_required_authorities.load(std::memory_order_relaxed) && !required_authorities_accessed.load(std::memory_order_relaxed))
     fc_ilog(fc::logger::get("worker_thread"), "transaction required authorities pre-computed, but full_transaction_type::get_required_authorities() was never called");
+  if (has_rc_resource_scan.load(std::memory_order_relaxed) && !rc_resource_scan_accessed.load(std::memory_order_relaxed))
+    fc_ilog(fc::logger::get("worker_thread"), "transaction RC resources pre-computed, but full_transaction_type::get_rc_resource_scan() was never called");
 }
 
 const signed_transaction& full_transaction_type::get_transaction() const
@@ -259,6 +263,34 @@ const hive::protocol::required_authorities_type& full_transaction_type::get_requ
   return required_authorities;
 }
 
+void full_transaction_type::compute_rc_resource_scan() const
+{
+  std::lock_guard<std::mutex> guard(results_mutex);
+  if (!has_rc_resource_scan.load(std::memory_order_consume))
+  {
+    transaction_resource_scan new_rc_resource_scan;
+    scan_resources(get_transaction(), new_rc_resource_scan);
+    rc_resource_scan = std::move(new_rc_resource_scan);
+
+    has_rc_resource_scan.store(true, std::memory_order_release);
+  }
+}
+
+const transaction_resource_scan& full_transaction_type::get_rc_resource_scan() const
+{
+  if (!has_rc_resource_scan.load(std::memory_order_consume))
+  {
+    compute_rc_resource_scan();
+    non_cached_get_rc_resource_scan_calls.fetch_add(1, std::memory_order_relaxed);
+  }
+  else
+  {
+    cached_get_rc_resource_scan_calls.fetch_add(1, std::memory_order_relaxed);
+  }
+  rc_resource_scan_accessed.store(true, std::memory_order_relaxed);
+  return rc_resource_scan;
+}
+
 bool full_transaction_type::is_legacy_pack() const
 {
   if (!has_is_packed_in_legacy_format.load(std::memory_order_consume))
@@ -1538,7 +1538,7 @@ void pre_hf20_vote_evaluator( const vote_operation& o, database& _db )
     }
   }
 
-  _db.modify( voter, [&]( account_object& a )
+  _db.modify_partial( voter, [&]( account_object::undo_partial_type& a )
   {
     a.voting_manabar.current_mana = current_power - used_power; // always nonnegative
     a.last_vote_time = _now;
@@ -1864,7 +1864,7 @@ void hf20_vote_evaluator( const vote_operation& o, database& _db )
     abs_rshares = (int64_t) fc::uint128_to_uint64( ( uint128_t( abs_rshares ) * cashout_delta ) / HIVE_UPVOTE_LOCKOUT_SECONDS );
   }
 
-  _db.modify( voter, [&]( account_object& a )
+  _db.modify_partial( voter, [&]( account_object::undo_partial_type& a )
   {
     if( dgpo.downvote_pool_percent && o.weight < 0 )
     {
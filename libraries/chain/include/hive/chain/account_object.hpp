@@ -262,6 +262,18 @@ namespace hive { namespace chain {
       */
       t_delayed_votes   delayed_votes;
 
+      //members changed by balance, manabar and RC updates in nearly every block; use modify_partial() to change them
+      //when nothing else changes, so undo state only holds copy of this group instead of whole account
+      CHAINBASE_UNDO_PARTIAL( account_object,
+        (hbd_seconds)(savings_hbd_seconds)
+        (voting_manabar)(downvote_manabar)(rc_manabar)
+        (hbd_balance)(savings_hbd_balance)(reward_hbd_balance)
+        (reward_hive_balance)(reward_vesting_hive)(balance)(savings_balance)
+        (reward_vesting_balance)(vesting_shares)
+        (last_max_rc)
+        (hbd_seconds_last_update)(hbd_last_interest_payment)(savings_hbd_seconds_last_update)(savings_hbd_last_interest_payment)
+        (last_vote_time) );
+
       //methods
 
       time_point_sec get_governance_vote_expiration_ts() const
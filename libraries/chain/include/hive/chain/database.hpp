@@ -13,6 +13,8 @@
 #include <hive/chain/rc/rc_utility.hpp>
 
 #include <hive/chain/util/advanced_benchmark_dumper.hpp>
+#include <hive/chain/util/notification_observers.hpp>
+#include <hive/chain/util/operation_profiler.hpp>
 #include <hive/chain/util/signal.hpp>
 #include <hive/chain/util/type_registrar.hpp>
 
@@ -85,9 +87,11 @@ namespace chain {
     fc::path data_dir;
     fc::path shared_mem_dir;
     uint64_t shared_file_size = 0;
+    uint64_t shared_file_max_size = 0;
     uint16_t shared_file_full_threshold = 0;
     uint16_t shared_file_scale_rate = 0;
     uint32_t chainbase_flags = 0;
+    uint64_t shared_file_numa_nodes = 0;
     bool do_validate_invariants = false;
     bool benchmark_is_enabled = false;
     fc::variant database_cfg;
@@ -369,6 +373,8 @@ namespace chain {
       using load_snapshot_data_supplement_handler_t = std::function < void(const load_snapshot_supplement_notification&) >;
       using comment_reward_notification_handler_t = std::function < void(const comment_reward_notification&) >;
       using end_of_syncing_notification_handler_t = std::function < void(void) >;
+      using apply_operation_observer_t = std::function< void(const operation_observation&) >;
+      using apply_block_observer_t = std::function< void(const block_observation&) >;
 
       void notify_prepare_snapshot_data_supplement(const prepare_snapshot_supplement_notification& n);
       void notify_load_snapshot_data_supplement(const load_snapshot_supplement_notification& n);
@@ -426,6 +432,25 @@ namespace chain {
 
       boost::signals2::connection add_end_of_syncing_handler            (const end_of_syncing_notification_handler_t& func, const abstract_plugin& plugin, int32_t group = -1);
 
+      /**
+        * Observers are alternative to handlers for plugins that only read notification data and never access
+        * database state. They receive immutable copy of notification (made once and shared by all observers)
+        * on separate thread (one per plugin, shared by all observers of that plugin, so they are called in the same
+        * order as notifications were emitted), therefore they don't add to block processing time. Since observers
+        * run with a delay, plugin should call flush_observers() after disconnecting them in its shutdown.
+        * Operation observers only receive operations applied as part of a block (never those of pending transactions),
+        * but like block observers they are not told when a block is popped on fork switch - data of reversible
+        * blocks may later be reverted and replaced by that of blocks from the other fork.
+        */
+      boost::signals2::connection add_post_apply_operation_observer     ( const apply_operation_observer_t&          func, const abstract_plugin& plugin );
+      boost::signals2::connection add_post_apply_block_observer         ( const apply_block_observer_t&              func, const abstract_plugin& plugin );
+      boost::signals2::connection add_irreversible_block_observer       ( const irreversible_block_handler_t&        func, const abstract_plugin& plugin );
+
+      /// waits until all observers process notifications emitted so far
+      void flush_observers() { _notification_observers.flush(); }
+      /// applies to observer queues created afterwards (set by chain_plugin from observer-queue-limit option)
+      void set_observer_queue_limit( size_t limit ) { _notification_observers.set_queue_limit( limit ); }
+
       //////////////////// db_witness_schedule.cpp ////////////////////
 
       /**
@@ -764,6 +789,11 @@ namespace chain {
         return _benchmark_dumper;
       }
 
+      util::operation_profiler& get_operation_profiler()
+      {
+        return _operation_profiler;
+      }
+
       const hardfork_versions& get_hardfork_versions()
       {
         return _hardfork_versions;
@@ -786,9 +816,12 @@ namespace chain {
 
       block_write_i*                _block_writer;
 
-      // this function needs access to _plugin_index_signal
+      // these functions need access to _plugin_index_signal
       template< typename MultiIndexType >
       friend void add_plugin_index( database& db );
+      template< typename MultiIndexType >
+      friend void add_plugin_secondary_index( database& db,
+        std::shared_ptr< chainbase::secondary_index< typename MultiIndexType::value_type > > secondary );
 
       transaction_status            _current_tx_status = TX_STATUS_NONE;
       transaction_id_type           _current_trx_id;
@@ -830,6 +863,8 @@ namespace chain {
       std::string                   _json_schema;
 
       util::advanced_benchmark_dumper  _benchmark_dumper;
+      util::operation_profiler         _operation_profiler;
+      util::notification_observers     _notification_observers;
 
       fc::signal<void(const operation_notification&)>       _pre_apply_operation_signal;
       /**
@@ -868,6 +903,14 @@ namespace chain {
         */
       fc::signal<void(const block_notification&)>           _fail_apply_block_signal;
 
+      /**
+        *  Signals feeding observer queues (see add_post_apply_operation_observer). They are emitted after
+        *  corresponding notification signals with single immutable copy of notification shared by all observers.
+        */
+      fc::signal<void(const std::shared_ptr<const operation_observation>&)> _post_apply_operation_observation_signal;
+      fc::signal<void(const std::shared_ptr<const block_observation>&)>     _post_apply_block_observation_signal;
+      fc::signal<void(uint32_t)>                                            _irreversible_block_observation_signal;
+
       /**
         * This signal is emitted any time a new transaction is about to be applied
         * to the chain state.
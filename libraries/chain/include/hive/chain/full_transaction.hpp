@@ -2,6 +2,7 @@
 #include <hive/protocol/transaction.hpp>
 #include <fc/reflect/reflect.hpp>
 #include <hive/protocol/transaction_util.hpp>
+#include <hive/chain/rc/resource_count.hpp>
 #include <chrono>
 #include <mutex>
 #include <atomic>
@@ -58,6 +59,10 @@ struct full_transaction_type
     mutable hive::protocol::required_authorities_type required_authorities; // if we've figured out who is supposed to sign this tranaction, it's here
     mutable std::chrono::nanoseconds required_authorities_computation_time;
 
+    // operations scanned for RC resources they use - only the part that depends neither on state nor on time, so it is
+    // the same whether transaction is applied as pending or as part of block
+    mutable transaction_resource_scan rc_resource_scan;
+
     /// immutable data below here isn't accessed across multiple threads, it's set at construction time and left alone
     
     // if this full_transaction was created while deserializing a block, we store
@@ -99,6 +104,8 @@ struct full_transaction_type
     mutable std::atomic<bool> signature_keys_accessed = { false };
     mutable std::atomic<bool> has_required_authorities = { false };
     mutable std::atomic<bool> required_authorities_accessed = { false };
+    mutable std::atomic<bool> has_rc_resource_scan = { false };
+    mutable std::atomic<bool> rc_resource_scan_accessed = { false };
 
 
     static std::atomic<uint32_t> number_of_instances_created;
@@ -124,6 +131,8 @@ struct full_transaction_type
     const flat_set<hive::protocol::public_key_type>& get_signature_keys() const;
     void compute_required_authorities() const;
     const hive::protocol::required_authorities_type& get_required_authorities() const;
+    void compute_rc_resource_scan() const;
+    const transaction_resource_scan& get_rc_resource_scan() const;
     bool is_legacy_pack() const;
     void precompute_validation(std::function<void(const hive::protocol::operation& op, bool post)> notify = std::function<void(const hive::protocol::operation&, bool)>()) const;
     void validate(std::function<void(const hive::protocol::operation& op, bool post)> notify = std::function<void(const hive::protocol::operation&, bool)>()) const;
@@ -56,6 +56,18 @@ void add_plugin_index( database& db )
   db._plugin_index_signal.connect( [&db](){ _add_index_impl< MultiIndexType >(db); } );
 }
 
+/**
+  * Registers process-local ordering of objects of MultiIndexType (see chainbase::secondary_index), f.e. one needed
+  * only by some API. It is not part of consensus state; it is refilled from existing objects each time database
+  * is opened and then maintained incrementally. Call after the index itself is added (matters for plugin indexes).
+  */
+template< typename MultiIndexType >
+void add_plugin_secondary_index( database& db,
+  std::shared_ptr< chainbase::secondary_index< typename MultiIndexType::value_type > > secondary )
+{
+  db._plugin_index_signal.connect( [&db, secondary](){ db.add_secondary_index< MultiIndexType >( secondary ); } );
+}
+
 } }
 
 #define HIVE_ADD_CORE_INDEX(db, index_name) \
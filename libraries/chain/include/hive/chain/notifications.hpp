@@ -59,4 +59,44 @@ struct comment_reward_notification
   share_type curation_tokens;
 };
 
+/// copy of block_notification passed to observers (see database::add_post_apply_block_observer)
+struct block_observation
+{
+  explicit block_observation( const block_notification& note ) :
+    block_id(note.block_id),
+    prev_block_id(note.prev_block_id),
+    block_num(note.block_num),
+    full_block(note.full_block)
+  {
+  }
+
+  fc::time_point_sec get_block_timestamp() const { return full_block->get_block_header().timestamp; }
+
+  hive::protocol::block_id_type           block_id;
+  hive::protocol::block_id_type           prev_block_id;
+  uint32_t                                block_num = 0;
+  std::shared_ptr<full_block_type>        full_block;
+};
+
+/// copy of operation_notification passed to observers (see database::add_post_apply_operation_observer)
+struct operation_observation
+{
+  explicit operation_observation( const operation_notification& note ) :
+    trx_id(note.trx_id),
+    block(note.block),
+    trx_in_block(note.trx_in_block),
+    op_in_trx(note.op_in_trx),
+    op(note.op),
+    virtual_op(note.virtual_op)
+  {
+  }
+
+  transaction_id_type       trx_id;
+  int64_t                   block = 0;
+  int64_t                   trx_in_block = 0;
+  int64_t                   op_in_trx = 0;
+  hive::protocol::operation op;
+  bool                      virtual_op = false;
+};
+
 } }
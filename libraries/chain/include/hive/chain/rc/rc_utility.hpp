@@ -65,6 +65,11 @@ class resource_credits
     // sets parameters that can temporarily increase RC cost for new transactions during flood
     static void set_flood_limiters( uint16_t flood_level, uint16_t flood_surcharge_factor );
 
+    // scans operations of transaction for used resources (part of usage that does not depend on state or time)
+    static void scan_resources(
+      const hive::protocol::signed_transaction& tx,
+      transaction_resource_scan& result );
+
     // scans transaction for used resources
     static void count_resources(
       const hive::protocol::signed_transaction& tx,
@@ -72,6 +77,14 @@ class resource_credits
       count_resources_result& result,
       const fc::time_point_sec now );
 
+    // completes counting of resources used by transaction with previously scanned operations
+    static void count_resources(
+      const hive::protocol::signed_transaction& tx,
+      const size_t size,
+      const transaction_resource_scan& scan,
+      count_resources_result& result,
+      const fc::time_point_sec now );
+
     // scans single nonstandard operation for used extra resources (implemented for rc_custom_operation)
     template< typename OpType >
     static void count_resources(
@@ -2,6 +2,8 @@
 
 #include <fc/int_array.hpp>
 #include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+#include <utility>
 #include <vector>
 
 namespace hive { namespace protocol {
@@ -43,6 +45,25 @@ typedef fc::int_array< uint16_t, HIVE_RC_NUM_RESOURCE_TYPES > resource_share_typ
 
 typedef resource_count_type count_resources_result;
 
+// resources used by operations of transaction - part of its usage that depends neither on state nor on time,
+// so it can be computed once (on worker thread) and reused every time transaction is applied
+struct transaction_resource_scan
+{
+  int32_t  market_op_count = 0;
+  int32_t  new_account_op_count = 0;
+  int64_t  state_bytes_count = 0;
+  int64_t  execution_time_count = 0;
+  bool     subsidized_op = false;
+  uint32_t subsidized_signatures = 0;
+  // state bytes charged per every (started) hour until given time (f.e. proposals) - final value depends on time of execution
+  std::vector< std::pair< fc::time_point_sec, int64_t > > hourly_state_bytes;
+};
+
+// scans operations of transaction for used resources (first part of count_resources)
+void scan_resources(
+  const hive::protocol::signed_transaction& tx,
+  transaction_resource_scan& result );
+
 // scans transaction for used resources
 void count_resources(
   const hive::protocol::signed_transaction& tx,
@@ -50,6 +71,14 @@ void count_resources(
   count_resources_result& result,
   const fc::time_point_sec now );
 
+// completes counting of resources used by transaction with previously scanned operations
+void count_resources(
+  const hive::protocol::signed_transaction& tx,
+  const size_t size,
+  const transaction_resource_scan& scan,
+  count_resources_result& result,
+  const fc::time_point_sec now );
+
 // scans single nonstandard operation for used extra resources (implemented for rc_custom_operation)
 template< typename OpType >
 void count_resources(
@@ -13,8 +13,11 @@ using boost::container::flat_set;
 class dhf_helper
 {
   public:
+    // container actually held for proposal_vote_index (with pooled nodes)
+    typedef chainbase::generic_index< proposal_vote_index >::index_type proposal_vote_container;
+
     // removes votes cast for proposals by given account (as long as we are within limit), returns if the process was successful
-    static bool remove_proposal_votes( const account_object& voter, const proposal_vote_index::index<by_voter_proposal>::type& proposal_votes,
+    static bool remove_proposal_votes( const account_object& voter, const proposal_vote_container::index<by_voter_proposal>::type& proposal_votes,
       database& db, remove_guard& obj_perf )
     {
       auto pVoteI = proposal_votes.lower_bound( boost::make_tuple( voter.get_name(), 0 ) );
@@ -29,7 +32,7 @@ class dhf_helper
     }
 
     // removes votes cast for given proposal (as long as we are within limit), returns if the process was successful
-    static bool remove_proposal_votes( const proposal_object& proposal, const proposal_vote_index::index<by_proposal_voter>::type& proposal_votes,
+    static bool remove_proposal_votes( const proposal_object& proposal, const proposal_vote_container::index<by_proposal_voter>::type& proposal_votes,
       database& db, remove_guard& obj_perf )
     {
       auto pVoteI = proposal_votes.lower_bound( boost::make_tuple( proposal.proposal_id, account_name_type() ) );
@@ -44,7 +47,7 @@ class dhf_helper
     }
 
     // removes given proposal with all related votes (as long as we are within limit), returns if the process was successful
-    static bool remove_proposal( const proposal_object& proposal, const proposal_vote_index::index<by_proposal_voter>::type& proposal_votes,
+    static bool remove_proposal( const proposal_object& proposal, const proposal_vote_container::index<by_proposal_voter>::type& proposal_votes,
       database& db, remove_guard& obj_perf )
     {
       remove_proposal_votes( proposal, proposal_votes, db, obj_perf );
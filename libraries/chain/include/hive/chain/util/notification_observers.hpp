@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace hive { namespace chain { namespace util {
+
+/**
+  * Delivers notifications to observers - handlers that only need a copy of notification data and never touch
+  * database state. Each observer (one per plugin) has its own queue served by its own thread, so observers run in
+  * parallel to each other and to block application, while each of them receives notifications in the order they
+  * were emitted. Queues are bounded; when observer falls behind by more than queue limit, thread emitting
+  * notifications waits for it.
+  * Observers have no undo, so database only emits observations of operations applied in blocks. Still, blocks
+  * observed before they became irreversible can be popped on fork switch without any notice to observers.
+  */
+class notification_observers
+{
+  public:
+    typedef std::function< void() > task_type;
+
+    class observer_queue
+    {
+      public:
+        observer_queue( const std::string& name, size_t limit );
+        ~observer_queue();
+
+        const std::string& get_name() const { return _name; }
+
+        void push( task_type&& task );
+        /// waits until all queued tasks are executed
+        void flush();
+        /// executes remaining tasks and stops worker thread
+        void stop();
+
+      private:
+        void thread_function();
+
+        const std::string         _name;
+        const size_t              _limit;
+
+        std::mutex                _mutex;
+        std::condition_variable   _task_added;
+        std::condition_variable   _task_done;
+        std::deque< task_type >   _tasks;
+        bool                      _busy = false;
+        bool                      _stopping = false;
+
+        std::thread               _thread;
+    };
+
+    static constexpr size_t default_queue_limit = 10000;
+
+    ~notification_observers();
+
+    /// returns queue of observer with given name, creating it (and its worker thread) on first use
+    std::shared_ptr< observer_queue > get_queue( const std::string& name );
+
+    /// applies to queues created afterwards
+    void set_queue_limit( size_t limit );
+
+    /// waits until all observers process notifications emitted so far
+    void flush();
+    /// delivers remaining notifications and stops all observer threads
+    void shutdown();
+
+  private:
+    std::mutex                                                  _mutex;
+    std::map< std::string, std::shared_ptr< observer_queue > >  _queues;
+    size_t                                                      _queue_limit = default_queue_limit;
+};
+
+} } } // hive::chain::util
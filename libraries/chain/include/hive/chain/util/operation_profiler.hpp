@@ -0,0 +1,150 @@
+#pragma once
+
+#include <hive/protocol/operations.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hive { namespace chain { namespace util {
+
+/**
+  * Attributes time of block application to operation types and to parts of their processing: evaluator, RC
+  * accounting and pre/post operation handlers of each plugin. Unlike advanced_benchmark_dumper, it can be switched
+  * on and off at any moment (f.e. through debug_node_api) and costs single atomic load per measured part when disabled.
+  *
+  * Measurements nest (virtual operations pushed by evaluator are measured inside that evaluator), so apart from
+  * totals per (operation, phase, plugin) with their self time, profile can be exported as folded stacks for
+  * flamegraph tools. Measurements are taken by the thread applying blocks, collected data can be read (or reset)
+  * from any thread.
+  */
+class operation_profiler
+{
+  public:
+    enum phase_type : uint8_t
+    {
+      evaluator,
+      rc,
+      pre_handler,
+      post_handler
+    };
+
+    struct entry
+    {
+      std::string operation;
+      std::string phase;
+      std::string plugin;
+      uint64_t    count = 0;
+      uint64_t    time_ns = 0; // including nested measurements
+      uint64_t    self_time_ns = 0;
+    };
+
+    /// measures time from construction to destruction, as long as profiling was enabled at construction
+    class scope
+    {
+      public:
+        scope( operation_profiler& profiler, const protocol::operation& op, phase_type phase, uint16_t handler = 0 )
+        {
+          if( profiler.is_enabled() )
+          {
+            _profiler = &profiler;
+            profiler.begin( op.which(), phase, handler, &op );
+          }
+        }
+
+        /// measurement not related to single operation (f.e. RC of whole transaction)
+        scope( operation_profiler& profiler, phase_type phase )
+        {
+          if( profiler.is_enabled() )
+          {
+            _profiler = &profiler;
+            profiler.begin( transaction_level, phase, 0, nullptr );
+          }
+        }
+
+        ~scope()
+        {
+          if( _profiler != nullptr )
+            _profiler->end();
+        }
+
+        scope( const scope& ) = delete;
+        scope& operator=( const scope& ) = delete;
+
+      private:
+        operation_profiler* _profiler = nullptr;
+    };
+
+    /// returns id of plugin handler to be passed to scope, same for all handlers of given plugin
+    uint16_t register_handler( const std::string& plugin_name );
+
+    void set_enabled( bool enabled ) { _enabled.store( enabled, std::memory_order_relaxed ); }
+    bool is_enabled() const { return _enabled.load( std::memory_order_relaxed ); }
+
+    /// clears collected times and counts
+    void reset();
+
+    /// totals per (operation, phase, plugin), biggest self time first
+    std::vector< entry > get_entries() const;
+    /// one line per stack of nested measurements followed by its self time in nanoseconds
+    std::string get_folded_stacks() const;
+
+  private:
+    static constexpr int32_t  transaction_level = -1;
+    static constexpr uint32_t no_parent = UINT32_MAX;
+
+    struct path
+    {
+      uint32_t parent;
+      uint64_t node;
+      uint64_t time = 0;
+      uint64_t children_time = 0;
+      uint64_t count = 0;
+    };
+
+    struct frame
+    {
+      uint32_t                              path;
+      std::chrono::steady_clock::time_point start;
+    };
+
+    struct path_key_hash
+    {
+      size_t operator()( const std::pair< uint32_t, uint64_t >& key ) const
+      {
+        return std::hash< uint64_t >()( key.second * 31 + key.first );
+      }
+    };
+
+    static uint64_t make_node( int32_t op_tag, phase_type phase, uint16_t handler )
+    {
+      return ( uint64_t( uint32_t( op_tag ) ) << 32 ) | ( uint64_t( phase ) << 16 ) | handler;
+    }
+
+    void begin( int32_t op_tag, phase_type phase, uint16_t handler, const protocol::operation* op );
+    void end();
+
+    std::string describe_node( uint64_t node ) const;
+    entry make_entry( uint64_t node ) const;
+
+    std::atomic< bool >           _enabled = { false };
+
+    /// used only by measuring thread
+    std::vector< frame >          _stack;
+    std::unordered_map< std::pair< uint32_t, uint64_t >, uint32_t, path_key_hash > _path_ids;
+
+    /// guards data below, which is read by other threads
+    mutable std::mutex            _mutex;
+    std::vector< path >           _paths;
+    std::vector< std::string >    _operation_names;
+    std::vector< std::string >    _handler_names;
+};
+
+} } } // hive::chain::util
+
+FC_REFLECT( hive::chain::util::operation_profiler::entry, (operation)(phase)(plugin)(count)(time_ns)(self_time_ns) )
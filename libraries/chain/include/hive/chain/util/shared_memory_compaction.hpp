@@ -0,0 +1,23 @@
+#pragma once
+
+#include <chainbase/chainbase.hpp>
+
+#include <set>
+#include <string>
+
+namespace hive { namespace chain { namespace util {
+
+/**
+  * Throws if `source` holds named object that compaction would lose, that is other than chainbase internals,
+  * last irreversible block data and indexes stored under given names.
+  */
+void verify_shared_memory_compactable( const chainbase::database& source, const std::set< std::string >& index_segment_names );
+
+/**
+  * Rebuilds contents of `source` in freshly opened `target` with the same indexes added (see
+  * chainbase::database::copy_to), including last irreversible block data. Throws bip::bad_alloc when
+  * `target` is too small.
+  */
+void compact_shared_memory( const chainbase::database& source, chainbase::database& target );
+
+} } } // hive::chain::util
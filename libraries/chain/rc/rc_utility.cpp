@@ -339,7 +339,7 @@ void resource_credits::regenerate_rc_mana( const account_object& account, const
 #endif
     }
 
-    db.modify( account, [&]( account_object& acc )
+    db.modify_partial( account, [&]( account_object::undo_partial_type& acc )
     {
       acc.rc_manabar.regenerate_mana< true >( mbparams, now );
     } );
@@ -438,7 +438,7 @@ void resource_credits::update_account_after_vest_change( const account_object& a
 
   if( new_last_max_rc != account.last_max_rc )
   {
-    db.modify( account, [&]( account_object& acc )
+    db.modify_partial( account, [&]( account_object::undo_partial_type& acc )
     {
       //note: rc delegations behave differently because if they behaved the following way there would
       //be possible to easily fill up mana through giving and immediately taking away rc delegations
@@ -488,7 +488,7 @@ bool resource_credits::use_account_rcs( int64_t rc )
 
   try
   {
-    db.modify( account, [&]( account_object& acc )
+    db.modify_partial( account, [&]( account_object::undo_partial_type& acc )
     {
       acc.rc_manabar.regenerate_mana< true >( mbparams, dgpo.time.sec_since_epoch() );
       tx_info.rc = acc.rc_manabar.current_mana; // update after regeneration
@@ -797,7 +797,9 @@ void resource_credits::finalize_transaction( const full_transaction_type& full_t
   // note: tx_info.usage might already contain state discount for selected operations and extra usage for custom ops
   // note: while we could calculate most of used resources before transaction is executed, doing so for
   // custom operations would be troublesome
-  count_resources( tx, full_tx.get_transaction_size(), tx_info.usage, db.head_block_time() );
+  // note: operations were usually already scanned on worker thread (and the scan is shared between
+  // pending and block application of the same transaction), only time dependent part is counted here
+  count_resources( tx, full_tx.get_transaction_size(), full_tx.get_rc_resource_scan(), tx_info.usage, db.head_block_time() );
 
   // How many RC does this transaction cost?
   int64_t total_cost = compute_cost( &tx_info );
@@ -177,13 +177,13 @@ struct count_operation_visitor
   mutable int64_t  execution_time_count = 0;
   mutable bool     subsidized_op = false;
   mutable uint32_t subsidized_signatures = 0;
+  mutable std::vector< std::pair< fc::time_point_sec, int64_t > > hourly_state_bytes;
 
   const state_object_size_info& _w;
   const operation_exec_info& _e;
-  const fc::time_point_sec _now;
 
-  count_operation_visitor( const state_object_size_info& w, const operation_exec_info& e, const fc::time_point_sec now )
-    : _w(w), _e(e), _now(now) {}
+  count_operation_visitor( const state_object_size_info& w, const operation_exec_info& e )
+    : _w(w), _e(e) {}
 
   int64_t get_authority_dynamic_size( const authority& auth )const
   {
@@ -545,12 +545,11 @@ struct count_operation_visitor
 
   void operator()( const create_proposal_operation& op ) const
   {
-    FC_ASSERT( op.end_date > _now );
-    uint32_t lifetime = ( op.end_date.sec_since_epoch() - _now.sec_since_epoch() + 3600 - 1 ) / 3600; //round up to full hours
     int64_t proposal_size =
         _w.create_proposal_base_size
       + _w.create_proposal_subject_permlink_char_size * ( op.subject.size() + op.permlink.size() );
-    state_bytes_count += proposal_size * lifetime;
+    //lifetime of proposal depends on time of execution - see count_hourly_state_bytes
+    hourly_state_bytes.emplace_back( op.end_date, proposal_size );
     execution_time_count += _e.create_proposal_time;
   }
 
@@ -629,6 +628,50 @@ struct count_operation_visitor
   // claim_reward_balance, delegate_vesting_shares, any SMT operations
 };
 
+static int64_t count_hourly_state_bytes( const std::vector< std::pair< fc::time_point_sec, int64_t > >& hourly_state_bytes,
+  const fc::time_point_sec now )
+{
+  int64_t result = 0;
+  for( const auto& item : hourly_state_bytes )
+  {
+    FC_ASSERT( item.first > now );
+    uint32_t lifetime = ( item.first.sec_since_epoch() - now.sec_since_epoch() + 3600 - 1 ) / 3600; //round up to full hours
+    result += item.second * lifetime;
+  }
+  return result;
+}
+
+void scan_resources(
+  const signed_transaction& tx,
+  transaction_resource_scan& result
+)
+{
+  resource_credits::scan_resources( tx, result );
+}
+
+void resource_credits::scan_resources(
+  const signed_transaction& tx,
+  transaction_resource_scan& result
+  )
+{
+  static const state_object_size_info size_info;
+  static const operation_exec_info exec_info;
+  count_operation_visitor vtor( size_info, exec_info );
+
+  for( const operation& op : tx.operations )
+  {
+    op.visit( vtor );
+  }
+
+  result.market_op_count = vtor.market_op_count;
+  result.new_account_op_count = vtor.new_account_op_count;
+  result.state_bytes_count = vtor.state_bytes_count;
+  result.execution_time_count = vtor.execution_time_count;
+  result.subsidized_op = vtor.subsidized_op;
+  result.subsidized_signatures = vtor.subsidized_signatures;
+  result.hourly_state_bytes = std::move( vtor.hourly_state_bytes );
+}
+
 void count_resources(
   const signed_transaction& tx,
   const size_t size,
@@ -645,16 +688,35 @@ void resource_credits::count_resources(
   count_resources_result& result,
   const fc::time_point_sec now
   )
+{
+  transaction_resource_scan scan;
+  scan_resources( tx, scan );
+  count_resources( tx, size, scan, result, now );
+}
+
+void count_resources(
+  const signed_transaction& tx,
+  const size_t size,
+  const transaction_resource_scan& scan,
+  count_resources_result& result,
+  const fc::time_point_sec now
+)
+{
+  resource_credits::count_resources( tx, size, scan, result, now );
+}
+
+void resource_credits::count_resources(
+  const signed_transaction& tx,
+  const size_t size,
+  const transaction_resource_scan& scan,
+  count_resources_result& result,
+  const fc::time_point_sec now
+  )
 {
   static const state_object_size_info size_info;
   static const operation_exec_info exec_info;
   const int64_t tx_size = int64_t( size );
-  count_operation_visitor vtor( size_info, exec_info, now );
-
-  for( const operation& op : tx.operations )
-  {
-    op.visit( vtor );
-  }
+  const int64_t hourly_state_bytes_count = count_hourly_state_bytes( scan.hourly_state_bytes, now );
 
   auto prevent_negative = []( count_resources_result& result )
   {
@@ -663,7 +725,7 @@ void resource_credits::count_resources(
         usage = 0;
   };
 
-  if( vtor.subsidized_op && tx.operations.size() == 1 && tx.signatures.size() <= vtor.subsidized_signatures )
+  if( scan.subsidized_op && tx.operations.size() == 1 && tx.signatures.size() <= scan.subsidized_signatures )
   {
     // transactions with single subsidized operation with normal amount of signatures are free
     // (for now just account recovery operation, but we might have more in the future)
@@ -673,18 +735,18 @@ void resource_credits::count_resources(
   
   result[ resource_history_bytes ] += tx_size;
 
-  result[ resource_new_accounts ] += vtor.new_account_op_count;
+  result[ resource_new_accounts ] += scan.new_account_op_count;
 
-  if( vtor.market_op_count > 0 )
+  if( scan.market_op_count > 0 )
     result[ resource_market_bytes ] += tx_size;
 
   uint32_t expiration_hours = ( tx.expiration.sec_since_epoch() - now.sec_since_epoch() + 3600 - 1 ) / 3600;
-  result[ resource_state_bytes ] += vtor.state_bytes_count
+  result[ resource_state_bytes ] += scan.state_bytes_count + hourly_state_bytes_count
     + size_info.transaction_base_size * expiration_hours;
   //we could also charge for data stored in full_transaction, but its lifetime is not that long and
   //it is not state data
 
-  result[ resource_execution_time ] += vtor.execution_time_count
+  result[ resource_execution_time ] += scan.execution_time_count
     + exec_info.transaction_time + exec_info.verify_authority_time * tx.signatures.size();
 
   prevent_negative( result );
@@ -712,14 +774,14 @@ void resource_credits::count_resources(
   //inside hived plugin(s);
   static const state_object_size_info size_info;
   static const operation_exec_info exec_info;
-  count_operation_visitor vtor( size_info, exec_info, now );
+  count_operation_visitor vtor( size_info, exec_info );
 
   op.visit( vtor );
 
   result[ resource_new_accounts ] += vtor.new_account_op_count;
   FC_ASSERT( vtor.market_op_count == 0 );
     //in case some custom operation is tagged as market, we'd probably have to mark all custom ops like that
-  result[ resource_state_bytes ] += vtor.state_bytes_count;
+  result[ resource_state_bytes ] += vtor.state_bytes_count + count_hourly_state_bytes( vtor.hourly_state_bytes, now );
   result[ resource_execution_time ] += vtor.execution_time_count;
 }
 
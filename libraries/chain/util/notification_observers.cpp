@@ -0,0 +1,129 @@
+#include <hive/chain/util/notification_observers.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/thread/thread.hpp>
+
+namespace hive { namespace chain { namespace util {
+
+notification_observers::observer_queue::observer_queue( const std::string& name, size_t limit )
+  : _name( name ), _limit( limit )
+{
+  FC_ASSERT( _limit > 0, "Observer queue limit must be positive" );
+  _thread = std::thread( [this]()
+  {
+    const std::string thread_name = "observer_" + _name;
+    fc::set_thread_name( thread_name.c_str() ); // tells the OS the thread's name
+    fc::thread::current().set_name( thread_name ); // tells fc the thread's name for logging
+    thread_function();
+  } );
+}
+
+notification_observers::observer_queue::~observer_queue()
+{
+  stop();
+}
+
+void notification_observers::observer_queue::push( task_type&& task )
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+  FC_ASSERT( !_stopping, "Observer ${o} already stopped", ( "o", _name ) );
+  _task_done.wait( lock, [this]() { return _tasks.size() < _limit; } );
+  _tasks.emplace_back( std::move( task ) );
+  lock.unlock();
+  _task_added.notify_one();
+}
+
+void notification_observers::observer_queue::flush()
+{
+  std::unique_lock< std::mutex > lock( _mutex );
+  _task_done.wait( lock, [this]() { return _tasks.empty() && !_busy; } );
+}
+
+void notification_observers::observer_queue::stop()
+{
+  {
+    std::lock_guard< std::mutex > guard( _mutex );
+    _stopping = true;
+  }
+  _task_added.notify_one();
+  if( _thread.joinable() )
+    _thread.join();
+}
+
+void notification_observers::observer_queue::thread_function()
+{
+  while( true )
+  {
+    task_type task;
+    {
+      std::unique_lock< std::mutex > lock( _mutex );
+      _task_added.wait( lock, [this]() { return _stopping || !_tasks.empty(); } );
+      if( _tasks.empty() )
+        return; // stopping and everything was delivered
+      task = std::move( _tasks.front() );
+      _tasks.pop_front();
+      _busy = true;
+    }
+
+    try
+    {
+      task();
+    }
+    catch( const fc::exception& e )
+    {
+      elog( "Caught exception in observer ${o}: ${e}", ( "o", _name )( "e", e.to_detail_string() ) );
+    }
+    catch( const std::exception& e )
+    {
+      elog( "Caught exception in observer ${o}: ${e}", ( "o", _name )( "e", e.what() ) );
+    }
+    catch( ... )
+    {
+      elog( "Caught unknown exception in observer ${o}", ( "o", _name ) );
+    }
+
+    {
+      std::lock_guard< std::mutex > guard( _mutex );
+      _busy = false;
+    }
+    _task_done.notify_all();
+  }
+}
+
+notification_observers::~notification_observers()
+{
+  shutdown();
+}
+
+std::shared_ptr< notification_observers::observer_queue > notification_observers::get_queue( const std::string& name )
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  auto& queue = _queues[ name ];
+  if( !queue )
+    queue = std::make_shared< observer_queue >( name, _queue_limit );
+  return queue;
+}
+
+void notification_observers::set_queue_limit( size_t limit )
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  _queue_limit = limit;
+}
+
+void notification_observers::flush()
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  for( auto& queue : _queues )
+    queue.second->flush();
+}
+
+void notification_observers::shutdown()
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  for( auto& queue : _queues )
+    queue.second->stop();
+  _queues.clear();
+}
+
+} } } // hive::chain::util
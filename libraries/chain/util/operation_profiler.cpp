@@ -0,0 +1,143 @@
+#include <hive/chain/util/operation_profiler.hpp>
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+namespace hive { namespace chain { namespace util {
+
+uint16_t operation_profiler::register_handler( const std::string& plugin_name )
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  auto found = std::find( _handler_names.begin(), _handler_names.end(), plugin_name );
+  if( found != _handler_names.end() )
+    return uint16_t( found - _handler_names.begin() );
+
+  FC_ASSERT( _handler_names.size() < UINT16_MAX, "Too many operation handlers" );
+  _handler_names.emplace_back( plugin_name );
+  return uint16_t( _handler_names.size() - 1 );
+}
+
+void operation_profiler::reset()
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+  // paths stay, since measurements in progress refer to them
+  for( auto& p : _paths )
+  {
+    p.time = 0;
+    p.children_time = 0;
+    p.count = 0;
+  }
+}
+
+void operation_profiler::begin( int32_t op_tag, phase_type phase, uint16_t handler, const protocol::operation* op )
+{
+  const uint32_t parent = _stack.empty() ? no_parent : _stack.back().path;
+  const uint64_t node = make_node( op_tag, phase, handler );
+
+  auto found = _path_ids.find( std::make_pair( parent, node ) );
+  if( found == _path_ids.end() )
+  {
+    std::lock_guard< std::mutex > guard( _mutex );
+    if( op != nullptr )
+    {
+      if( _operation_names.size() <= size_t( op_tag ) )
+        _operation_names.resize( op_tag + 1 );
+      if( _operation_names[ op_tag ].empty() )
+        _operation_names[ op_tag ] = op->get_stored_type_name( true );
+    }
+    _paths.push_back( { parent, node } );
+    found = _path_ids.emplace( std::make_pair( parent, node ), uint32_t( _paths.size() - 1 ) ).first;
+  }
+
+  _stack.push_back( { found->second, std::chrono::steady_clock::now() } );
+}
+
+void operation_profiler::end()
+{
+  const frame current = _stack.back();
+  _stack.pop_back();
+  const uint64_t time = std::chrono::duration_cast< std::chrono::nanoseconds >(
+    std::chrono::steady_clock::now() - current.start ).count();
+
+  std::lock_guard< std::mutex > guard( _mutex );
+  auto& p = _paths[ current.path ];
+  p.time += time;
+  ++p.count;
+  if( p.parent != no_parent )
+    _paths[ p.parent ].children_time += time;
+}
+
+std::string operation_profiler::describe_node( uint64_t node ) const
+{
+  const entry e = make_entry( node );
+  return e.plugin.empty() ? e.operation + ";" + e.phase : e.operation + ";" + e.phase + ";" + e.plugin;
+}
+
+operation_profiler::entry operation_profiler::make_entry( uint64_t node ) const
+{
+  static const char* const phase_names[] = { "evaluator", "rc", "pre", "post" };
+
+  const int32_t op_tag = int32_t( node >> 32 );
+  const auto phase = phase_type( ( node >> 16 ) & 0xFF );
+  const uint16_t handler = node & 0xFFFF;
+
+  entry e;
+  e.operation = op_tag == transaction_level ? "transaction" : _operation_names[ op_tag ];
+  e.phase = phase_names[ phase ];
+  if( phase == pre_handler || phase == post_handler )
+    e.plugin = _handler_names[ handler ];
+  return e;
+}
+
+std::vector< operation_profiler::entry > operation_profiler::get_entries() const
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+
+  std::map< uint64_t, entry > entries;
+  for( const auto& p : _paths )
+  {
+    if( p.count == 0 )
+      continue;
+    auto found = entries.find( p.node );
+    if( found == entries.end() )
+      found = entries.emplace( p.node, make_entry( p.node ) ).first;
+    found->second.count += p.count;
+    found->second.time_ns += p.time;
+    found->second.self_time_ns += p.time - std::min( p.time, p.children_time );
+  }
+
+  std::vector< entry > result;
+  result.reserve( entries.size() );
+  for( auto& e : entries )
+    result.emplace_back( std::move( e.second ) );
+  std::sort( result.begin(), result.end(), []( const entry& a, const entry& b ) { return a.self_time_ns > b.self_time_ns; } );
+  return result;
+}
+
+std::string operation_profiler::get_folded_stacks() const
+{
+  std::lock_guard< std::mutex > guard( _mutex );
+
+  std::stringstream ss;
+  for( const auto& p : _paths )
+  {
+    const uint64_t self_time = p.time - std::min( p.time, p.children_time );
+    if( self_time == 0 )
+      continue;
+
+    std::vector< uint64_t > nodes;
+    for( const path* current = &p; ; current = &_paths[ current->parent ] )
+    {
+      nodes.push_back( current->node );
+      if( current->parent == no_parent )
+        break;
+    }
+    for( auto it = nodes.rbegin(); it != nodes.rend(); ++it )
+      ss << ( it == nodes.rbegin() ? "" : ";" ) << describe_node( *it );
+    ss << " " << self_time << "\n";
+  }
+  return ss.str();
+}
+
+} } } // hive::chain::util
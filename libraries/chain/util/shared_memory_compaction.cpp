@@ -0,0 +1,41 @@
+#include <hive/chain/util/shared_memory_compaction.hpp>
+
+#include <hive/chain/irreversible_block_data.hpp>
+
+#include <fc/exception/exception.hpp>
+
+namespace hive { namespace chain { namespace util {
+
+void verify_shared_memory_compactable( const chainbase::database& source, const std::set< std::string >& index_segment_names )
+{
+  // every object stored in the segment has to be rebuilt in the new one, otherwise its data would be lost
+  const auto segment_manager = source.get_segment_manager();
+  for( auto it = segment_manager->named_begin(); it != segment_manager->named_end(); ++it )
+  {
+    const std::string name( it->name(), it->name_length() );
+    FC_ASSERT( chainbase::database::get_internal_segment_names().count( name ) || name == "irreversible" ||
+      index_segment_names.count( name ), "Shared memory file contains `${name}' which is not known to the tool, it can't be compacted.", (name) );
+  }
+}
+
+void compact_shared_memory( const chainbase::database& source, chainbase::database& target )
+{
+  source.copy_to( target );
+
+  const auto irreversible_object = source.get_segment_manager()->find< irreversible_block_data_type >( "irreversible" ).first;
+  if( irreversible_object == nullptr )
+    return;
+
+  const auto target_segment_manager = target.get_segment_manager();
+  auto target_irreversible_object = target_segment_manager->find_or_construct< irreversible_block_data_type >( "irreversible" )(
+    chainbase::allocator< irreversible_block_data_type >( target_segment_manager ) );
+  const auto& source_data = irreversible_object->_irreversible_block_data;
+  auto& target_data = target_irreversible_object->_irreversible_block_data;
+  target_irreversible_object->_irreversible_block_num = irreversible_object->_irreversible_block_num;
+  target_data._compression_attributes = source_data._compression_attributes;
+  target_data._byte_size = source_data._byte_size;
+  target_data._block_bytes.assign( source_data._block_bytes.begin(), source_data._block_bytes.end() );
+  target_data._block_id = source_data._block_id;
+}
+
+} } } // hive::chain::util
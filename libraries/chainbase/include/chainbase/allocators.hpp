@@ -8,6 +8,7 @@
 #include <boost/interprocess/containers/string.hpp>
 #include <boost/interprocess/containers/vector.hpp>
 #include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/allocators/node_allocator.hpp>
 #include <boost/interprocess/sync/interprocess_sharable_mutex.hpp>
 #include <boost/interprocess/sync/sharable_lock.hpp>
 #include <boost/interprocess/sync/file_lock.hpp>
@@ -32,6 +33,68 @@ namespace chainbase {
   using allocator = bip::allocator<T, bip::managed_mapped_file::segment_manager>;
 #endif
 
+#ifdef ENABLE_STD_ALLOCATOR
+  template< typename T >
+  using node_allocator = std::allocator< T >;
+#else
+  /**
+    * Allocator for fixed size nodes of containers (index nodes of generic_index and its undo state). Nodes are
+    * carved from blocks of 256 nodes taken from segment manager, with one pool per node size, kept in
+    * the segment itself, so it survives restarts. Allocation of single node is a pop from free list of the pool
+    * instead of best-fit search in segment manager tree, and nodes allocated one after another are placed next
+    * to each other. Freed nodes stay in the pool for reuse by objects of the same node size - blocks are not given
+    * back to segment manager (bip::adaptive_pool does that, but it is not faster than segment manager itself).
+    * Allocations of more elements at once (f.e. bucket arrays of hashed indexes) go directly to segment manager.
+    *
+    * bip::node_allocator only serves nodes through allocate_one() (used by boost containers), while containers
+    * such as multi_index allocate nodes with allocate(1), so single element allocations are redirected here.
+    */
+  template< typename T >
+  class node_allocator : public bip::node_allocator< T, bip::managed_mapped_file::segment_manager, 256 >
+  {
+    typedef bip::node_allocator< T, bip::managed_mapped_file::segment_manager, 256 > base_type;
+
+  public:
+    typedef typename base_type::pointer   pointer;
+    typedef typename base_type::size_type size_type;
+
+    template< typename U >
+    struct rebind
+    {
+      typedef node_allocator< U > other;
+    };
+
+    node_allocator( bip::managed_mapped_file::segment_manager* segment_manager ) : base_type( segment_manager ) {}
+
+    template< typename U >
+    node_allocator( const node_allocator< U >& other ) : base_type( other ) {}
+
+    pointer allocate( size_type count )
+    {
+      return count == 1 ? this->allocate_one() : base_type::allocate( count );
+    }
+
+    void deallocate( const pointer& ptr, size_type count )
+    {
+      if( count == 1 )
+        this->deallocate_one( ptr );
+      else
+        base_type::deallocate( ptr, count );
+    }
+  };
+#endif
+
+  /// node_allocator working in the same memory as given (regular) allocator
+  template< typename T, typename U >
+  node_allocator< T > make_node_allocator( const allocator< U >& a )
+  {
+#ifdef ENABLE_STD_ALLOCATOR
+    return node_allocator< T >( a );
+#else
+    return node_allocator< T >( a.get_segment_manager() );
+#endif
+  }
+
   typedef boost::shared_mutex read_write_mutex;
   typedef boost::shared_lock<read_write_mutex> read_lock;
   typedef boost::unique_lock<read_write_mutex> write_lock;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <boost/interprocess/managed_mapped_file.hpp>
+#include <boost/interprocess/managed_external_buffer.hpp>
 #include <boost/interprocess/containers/map.hpp>
 #include <boost/interprocess/containers/set.hpp>
 #include <boost/interprocess/containers/flat_map.hpp>
@@ -16,10 +17,12 @@
 #include <boost/config.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/multi_index_container_fwd.hpp>
 #include <boost/thread.hpp>
 #include <boost/throw_exception.hpp>
 
 #include <chainbase/allocators.hpp>
+#include <chainbase/secondary_index.hpp>
 #include <chainbase/state_snapshot_support.hpp>
 #include <chainbase/util/object_id.hpp>
 
@@ -27,9 +30,13 @@
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
 #include <stdexcept>
+#include <thread>
 #include <typeindex>
 #include <typeinfo>
 
@@ -234,25 +241,78 @@ namespace chainbase {
   { unpackFn(*this); }                                                                     \
   template <class T> friend class chainbase::generic_index
 
+  #define CHAINBASE_UNDO_PARTIAL_MEMBER( r, OBJECT_TYPE, member ) decltype( OBJECT_TYPE::member ) member;
+  #define CHAINBASE_UNDO_PARTIAL_GET( r, data, member ) p.member = member;
+  #define CHAINBASE_UNDO_PARTIAL_SET( r, data, member ) member = p.member;
+  /**
+    * use after declaration of listed members to define group of frequently changed members, f.e.:
+    * CHAINBASE_UNDO_PARTIAL( account_object, (balance)(voting_manabar) )
+    * such group can be changed with database::modify_partial(), which only stores copy of the group in undo state
+    * instead of copy of whole object; members must not use dynamically allocated memory
+    */
+  #define CHAINBASE_UNDO_PARTIAL( OBJECT_TYPE, MEMBERS )                                                                  \
+  public:                                                                                                                \
+  struct undo_partial_type { BOOST_PP_SEQ_FOR_EACH( CHAINBASE_UNDO_PARTIAL_MEMBER, OBJECT_TYPE, MEMBERS ) };             \
+  void get_undo_partial( undo_partial_type& p ) const { BOOST_PP_SEQ_FOR_EACH( CHAINBASE_UNDO_PARTIAL_GET, _, MEMBERS ) } \
+  void set_undo_partial( const undo_partial_type& p ) { BOOST_PP_SEQ_FOR_EACH( CHAINBASE_UNDO_PARTIAL_SET, _, MEMBERS ) }
+
+  /// placeholder for objects that don't declare CHAINBASE_UNDO_PARTIAL
+  struct no_undo_partial {};
+
+  template< typename value_type, typename = void >
+  struct undo_partial_of
+  {
+    typedef no_undo_partial type;
+    static constexpr bool value = false;
+  };
+
+  template< typename value_type >
+  struct undo_partial_of< value_type, std::void_t< typename value_type::undo_partial_type > >
+  {
+    typedef typename value_type::undo_partial_type type;
+    static constexpr bool value = true;
+  };
 
   template< typename value_type >
   class undo_state
   {
     public:
       typedef typename value_type::id_type                      id_type;
-      typedef allocator< std::pair<const id_type, value_type> > id_value_allocator_type;
-      typedef allocator< id_type >                              id_allocator_type;
+      typedef typename undo_partial_of< value_type >::type      partial_type;
+      typedef node_allocator< std::pair<const id_type, value_type> > id_value_allocator_type;
+      typedef node_allocator< std::pair<const id_type, partial_type> > id_partial_allocator_type;
+      typedef node_allocator< id_type >                              id_allocator_type;
 
-      template<typename T>
-      undo_state( allocator<T> al )
-      :old_values( id_value_allocator_type( al ) ),
-        removed_values( id_value_allocator_type( al ) ),
-        new_ids( id_allocator_type( al ) ){}
+      /**
+        * Node allocators of undo state containers. Creating node_allocator looks its pool up in segment manager, so
+        * the index creates them once and new undo states (one per undo session) just copy them.
+        */
+      struct allocators
+      {
+        template<typename T>
+        explicit allocators( const allocator<T>& al )
+        :values( make_node_allocator< std::pair<const id_type, value_type> >( al ) ),
+          partials( make_node_allocator< std::pair<const id_type, partial_type> >( al ) ),
+          ids( make_node_allocator< id_type >( al ) ){}
+
+        id_value_allocator_type   values;
+        id_partial_allocator_type partials;
+        id_allocator_type         ids;
+      };
+
+      explicit undo_state( const allocators& al )
+      :old_values( al.values ),
+        partial_values( al.partials ),
+        removed_values( al.values ),
+        new_ids( al.ids ){}
 
-      typedef boost::interprocess::map< id_type, value_type, std::less<id_type>, id_value_allocator_type >  id_value_type_map;
-      typedef boost::interprocess::set< id_type, std::less<id_type>, id_allocator_type >                    id_type_set;
+      typedef boost::interprocess::map< id_type, value_type, std::less<id_type>, id_value_allocator_type >      id_value_type_map;
+      typedef boost::interprocess::map< id_type, partial_type, std::less<id_type>, id_partial_allocator_type >  id_partial_type_map;
+      typedef boost::interprocess::set< id_type, std::less<id_type>, id_allocator_type >                        id_type_set;
 
       id_value_type_map            old_values;
+      /// objects changed only with modify_partial() - holds original values of partial undo group
+      id_partial_type_map          partial_values;
       id_value_type_map            removed_values;
       id_type_set                  new_ids;
       id_type                      old_next_id = id_type(0);
@@ -316,6 +376,22 @@ namespace chainbase {
     uint32_t _lock_serial_number; // allows us to associate the "locking" log with the "releasing" log
   };
 
+  /**
+    * Container actually held by generic_index: given multi_index_container with its nodes allocated by
+    * node_allocator instead of allocator declared for the index (which is still used for dynamic members of objects).
+    */
+  template< typename MultiIndexType >
+  struct pooled_index
+  {
+    typedef MultiIndexType type;
+  };
+
+  template< typename Value, typename IndexSpecifierList, typename Allocator >
+  struct pooled_index< boost::multi_index::multi_index_container< Value, IndexSpecifierList, Allocator > >
+  {
+    typedef boost::multi_index::multi_index_container< Value, IndexSpecifierList, node_allocator< Value > > type;
+  };
+
   /**
     *  The value_type stored in the multiindex container must have a integer field accessible through
     *  constant function 'get_id'.  This will be the primary key and it will be assigned and managed by generic_index.
@@ -332,17 +408,19 @@ namespace chainbase {
       }
 
     public:
-      typedef MultiIndexType                                        index_type;
+      typedef typename pooled_index< MultiIndexType >::type         index_type;
       typedef typename index_type::value_type                       value_type;
       typedef typename value_type::id_type                          id_type;
       typedef allocator< generic_index >                            allocator_type;
       typedef undo_state< value_type >                              undo_state_type;
+      typedef typename undo_state_type::partial_type                partial_type;
+      static constexpr bool has_undo_partial = undo_partial_of< value_type >::value;
 
       generic_index( allocator<value_type> a, bfs::path p )
-      :_stack(a),_indices( a, p ),_size_of_value_type( sizeof(typename MultiIndexType::value_type) ),_size_of_this(sizeof(*this)) {}
+      :_stack(a),_undo_allocators(a),_indices( make_node_allocator< value_type >( a ), p ),_size_of_value_type( sizeof(value_type) ),_size_of_this(sizeof(*this)) {}
 
       generic_index( allocator<value_type> a )
-      :_stack(a),_indices( a ),_size_of_value_type( sizeof(typename MultiIndexType::value_type) ),_size_of_this(sizeof(*this)) {}
+      :_stack(a),_undo_allocators(a),_indices( make_node_allocator< value_type >( a ) ),_size_of_value_type( sizeof(value_type) ),_size_of_this(sizeof(*this)) {}
 
       size_t get_item_additional_allocation() const {
         return _item_additional_allocation;
@@ -362,7 +440,7 @@ namespace chainbase {
       const value_type& emplace( Args&&... args ) {
         auto new_id = _next_id;
 
-        auto insert_result = _indices.emplace( _indices.get_allocator(), new_id, std::forward<Args>( args )... );
+        auto insert_result = _indices.emplace( get_object_allocator(), new_id, std::forward<Args>( args )... );
 
         if( !insert_result.second ) {
           CHAINBASE_THROW_EXCEPTION(std::logic_error(
@@ -371,42 +449,113 @@ namespace chainbase {
 
         ++_next_id;
         on_create( *insert_result.first );
+        notify_inserted( *insert_result.first );
         if constexpr( value_type::has_dynamic_alloc_t::value )
           _item_additional_allocation += insert_result.first->get_dynamic_alloc();
         return *insert_result.first;
       }
 
       /**
-        * Construct a new element and puts in the multi_index_container, basing on snapshot stream.
+        * Decodes an object from snapshot stream without putting it into the multi_index_container.
+        * Can be called concurrently (segment allocations are synchronized by segment manager), what allows
+        * to perform costly unpacking on many threads, while insertion is done later by insert_snapshot_batch.
         */
-      void unpack_from_snapshot(typename value_type::id_type objectId, std::function<void(value_type&)>&& unpack,
-        std::function<std::string(const fc::variant&)>&& preetify) {
-        _next_id = objectId;
-        value_type tmp(_indices.get_allocator(), objectId, std::move(unpack));
-
-        auto insert_result = _indices.emplace(std::move(tmp));
+      value_type decode_from_snapshot(typename value_type::id_type objectId, std::function<void(value_type&)>&& unpack) const {
+        return value_type(get_object_allocator(), objectId, std::move(unpack));
+      }
 
-        if(!insert_result.second) {
-          std::string s = preetify(fc::variant(tmp));
+      /**
+        * Puts objects decoded by decode_from_snapshot into the multi_index_container. Batch is expected to be sorted by id,
+        * so each object is inserted with a hint pointing just after previously inserted one (amortized constant time
+        * in by_id index, instead of full tree lookup). Caller is responsible for serialization of calls and for setting
+        * next_id at the end of load.
+        */
+      template<typename Batch>
+      void insert_snapshot_batch(Batch& batch, const std::function<std::string(const fc::variant&)>& preetify) {
+        auto& byIdIdx = _indices.template get<by_id>();
+        auto hint = byIdIdx.end();
+
+        for(auto& object : batch) {
+          const size_t old_size = byIdIdx.size();
+          auto inserted = byIdIdx.emplace_hint(hint, std::move(object));
+
+          if(byIdIdx.size() == old_size) {
+            std::string s = preetify(fc::variant(object));
+            std::string s2 = preetify(fc::variant(*inserted));
+            std::string msg = "could not insert unpacked object, most likely a uniqueness constraint was violated: `" + s +
+              std::string("' conflicting object:`") + s2 + "'";
+
+            CHAINBASE_THROW_EXCEPTION(std::logic_error(msg));
+          }
 
-          const auto& conflictingObject = *insert_result.first;
-          std::string s2 = preetify(fc::variant(conflictingObject));
-          std::string msg = "could not insert unpacked object, most likely a uniqueness constraint was violated: `" + s +
-            std::string("' conflicting object:`") + s2 + "'";
+          hint = std::next(inserted);
+          on_create(*inserted);
+          notify_inserted(*inserted);
+        }
+      }
 
-          CHAINBASE_THROW_EXCEPTION(std::logic_error(msg));
+      /**
+        * Copies all objects (in id order), next_id and revision into empty index of the same type living in another
+        * segment, so their nodes fill consecutive blocks of node pool there without gaps (pool hands out nodes of
+        * a block starting from its end, so within a block objects follow each other in descending addresses).
+        * Objects travel through their binary form, since their dynamically allocated members have to be rebuilt
+        * with the allocator of the target segment.
+        * Undo state is not copied, so there must be none.
+        */
+      void copy_to( generic_index& target ) const {
+        if( enabled() )
+          CHAINBASE_THROW_EXCEPTION( std::logic_error( "cannot copy index with pending undo state, holding types: " + get_type_name() ) );
+        if( !target._indices.empty() )
+          CHAINBASE_THROW_EXCEPTION( std::logic_error( "cannot copy into non-empty index holding types: " + get_type_name() ) );
+
+        constexpr size_t max_batch_size = 64 * 1024;
+        std::vector<value_type> batch;
+        batch.reserve( std::min( max_batch_size, _indices.size() ) );
+        std::vector<char> buffer;
+        const auto preetify = []( const fc::variant& object ) { return fc::json::to_string( object ); };
+
+        for( const auto& object : _indices.template get<by_id>() ) {
+          serialization::pack_to_buffer( buffer, object );
+          batch.emplace_back( target.decode_from_snapshot( object.get_id(), [&buffer]( value_type& copy ) {
+            serialization::unpack_from_buffer( copy, buffer );
+          } ) );
+
+          if( batch.size() >= max_batch_size ) {
+            target.insert_snapshot_batch( batch, preetify );
+            batch.clear();
           }
+        }
+        target.insert_snapshot_batch( batch, preetify );
 
-        ++_next_id;
-
-        on_create(*insert_result.first);
-        // no need to correct _item_additional_allocation here - whole value is recalculated at the end of load
+        target.store_next_id( _next_id );
+        target.set_revision( _revision );
+        target._item_additional_allocation = _item_additional_allocation;
       }
 
       template<typename Modifier>
       void modify( const value_type& obj, Modifier&& m ) {
         on_modify( obj );
+        apply_modifier( obj, std::forward<Modifier>( m ) );
+      }
 
+      /**
+        * Modifies only members of partial undo group (see CHAINBASE_UNDO_PARTIAL). Modifier is called with a copy
+        * of the group, which is then written back to the object.
+        */
+      template<typename Modifier>
+      void modify_partial( const value_type& obj, Modifier&& m ) {
+        static_assert( has_undo_partial, "object has to declare CHAINBASE_UNDO_PARTIAL" );
+        on_modify_partial( obj );
+
+        partial_type partial;
+        obj.get_undo_partial( partial );
+        m( partial );
+        apply_modifier( obj, [&]( value_type& v ) { v.set_undo_partial( partial ); } );
+      }
+
+    private:
+      template<typename Modifier>
+      void apply_modifier( const value_type& obj, Modifier&& m ) {
         fc::exception_ptr fc_exception_ptr;
         std::exception_ptr std_exception_ptr;
 
@@ -430,7 +579,10 @@ namespace chainbase {
         size_t old_size = 0, new_size = 0;
         if constexpr( value_type::has_dynamic_alloc_t::value )
           old_size = obj.get_dynamic_alloc();
+        notify_about_to_modify( obj );
         auto ok = _indices.modify( itr, safe_modifier);
+        if( ok )
+          notify_modified( obj );
         if constexpr( value_type::has_dynamic_alloc_t::value )
           new_size = obj.get_dynamic_alloc();
 
@@ -449,30 +601,33 @@ namespace chainbase {
           _item_additional_allocation += new_size - old_size;
       }
 
+    public:
       void remove( const value_type& obj ) {
         size_t size = 0;
         if constexpr( value_type::has_dynamic_alloc_t::value )
           size = obj.get_dynamic_alloc();
         on_remove( obj );
+        notify_removed( obj );
         _indices.erase( _indices.iterator_to( obj ) );
         if constexpr( value_type::has_dynamic_alloc_t::value )
           _item_additional_allocation -= size;
       }
 
       template< typename ByIndex >
-      typename MultiIndexType::template index_iterator<ByIndex>::type erase(typename MultiIndexType::template index_iterator<ByIndex>::type objI) {
+      typename index_type::template index_iterator<ByIndex>::type erase(typename index_type::template index_iterator<ByIndex>::type objI) {
         auto& idx = _indices.template get< ByIndex >();
         size_t size = 0;
         if constexpr( value_type::has_dynamic_alloc_t::value )
           size = objI->get_dynamic_alloc();
         on_remove( *objI );
+        notify_removed( *objI );
         const auto ret = idx.erase(objI);
         if constexpr( value_type::has_dynamic_alloc_t::value )
           _item_additional_allocation -= size;
         return ret;
       }
 
-      template< typename ByIndex, typename ExternalStorageProcessor, typename Iterator = typename MultiIndexType::template index_iterator<ByIndex>::type >
+      template< typename ByIndex, typename ExternalStorageProcessor, typename Iterator = typename index_type::template index_iterator<ByIndex>::type >
       void move_to_external_storage(Iterator begin, Iterator end, ExternalStorageProcessor&& processor)
       {
         auto& idx = _indices.template get< ByIndex >();
@@ -488,6 +643,7 @@ namespace chainbase {
             size_t size = 0;
             if constexpr( value_type::has_dynamic_alloc_t::value )
               size = objectI->get_dynamic_alloc();
+            notify_removed(*objectI);
             auto successor = idx.erase(objectI);
             FC_ASSERT(successor == nextI);
             if constexpr( value_type::has_dynamic_alloc_t::value )
@@ -523,6 +679,9 @@ namespace chainbase {
       void clear() {
         _indices.clear();
         _item_additional_allocation = 0;
+        if( const auto* secondary_indexes = secondary_index_registry< value_type >::find( this ) )
+          for( const auto& secondary : *secondary_indexes )
+            secondary->clear();
       }
 
       class session {
@@ -571,7 +730,7 @@ namespace chainbase {
       {
         ++_revision;
 
-        _stack.emplace_back( _indices.get_allocator() );
+        _stack.emplace_back( _undo_allocators );
         _stack.back().old_next_id = _next_id;
         _stack.back().revision = _revision;
         return session( *this, _revision );
@@ -599,6 +758,26 @@ namespace chainbase {
 
         auto& head = _stack.back();
 
+        if constexpr( has_undo_partial )
+        {
+          for( const auto& item : head.partial_values ) {
+            auto itr = _indices.find( item.first );
+            if( itr == _indices.end() )
+            {
+              CHAINBASE_THROW_EXCEPTION(std::logic_error("unable to find object with id: " +
+                std::to_string(item.first) + "in the index holding types: " + get_type_name()));
+            }
+            notify_about_to_modify( *itr );
+            if( !_indices.modify( itr, [&]( value_type& v ) { v.set_undo_partial( item.second ); } ) )
+            {
+              CHAINBASE_THROW_EXCEPTION(std::logic_error(
+                "Could not modify object, most likely a uniqueness constraint was violated inside index holding types: "
+                  + get_type_name()));
+            }
+            notify_modified( *itr );
+          }
+        }
+
         for( auto& item : head.old_values ) {
           bool ok = false;
           size_t old_size = 0;
@@ -611,15 +790,21 @@ namespace chainbase {
               old_size = itr->get_dynamic_alloc();
               new_size = item.second.get_dynamic_alloc();
             }
+            notify_about_to_modify( *itr );
             ok = _indices.modify( itr, [&]( value_type& v ) {
               v = std::move( item.second );
             });
+            if( ok )
+              notify_modified( *itr );
           }
           else
           {
             if constexpr( value_type::has_dynamic_alloc_t::value )
               new_size = item.second.get_dynamic_alloc();
-            ok = _indices.emplace( std::move( item.second ) ).second;
+            auto insert_result = _indices.emplace( std::move( item.second ) );
+            ok = insert_result.second;
+            if( ok )
+              notify_inserted( *insert_result.first );
           }
 
           if( !ok )
@@ -645,6 +830,7 @@ namespace chainbase {
           size_t size = 0;
           if constexpr( value_type::has_dynamic_alloc_t::value )
             size = position->get_dynamic_alloc();
+          notify_removed( *position );
           _indices.erase( position );
           if constexpr( value_type::has_dynamic_alloc_t::value )
             _item_additional_allocation -= size;
@@ -655,12 +841,13 @@ namespace chainbase {
           size_t new_size = 0;
           if constexpr( value_type::has_dynamic_alloc_t::value )
             new_size = item.second.get_dynamic_alloc();
-          bool ok = _indices.emplace( std::move( item.second ) ).second;
-          if( !ok )
+          auto insert_result = _indices.emplace( std::move( item.second ) );
+          if( !insert_result.second )
           {
             CHAINBASE_THROW_EXCEPTION(std::logic_error(
               "Could not restore object, most likely a uniqueness constraint was violated inside index holding types: " + get_type_name()));
           }
+          notify_inserted( *insert_result.first );
           if constexpr( value_type::has_dynamic_alloc_t::value )
             _item_additional_allocation += new_size;
         }
@@ -726,7 +913,28 @@ namespace chainbase {
         // (a serious logic error which should never happen).
         //
 
-        // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's three containers.
+        // Partial update (only with partial undo group stored in partial_values) behaves like upd, except that when
+        // it is merged with other state it has to be completed to full object with use of the other state, because
+        // members outside of the group did not change while partial update was recorded.
+        //
+        // We can only be outside type A/AB (the nop path) if B is not nop, so it suffices to iterate through B's three
+        // (four with partial) containers.
+
+        if constexpr( has_undo_partial )
+        {
+          for( auto& item : state.partial_values )
+          {
+            // new+upd -> new, upd(was=X) + upd(was=Y) -> upd(was=X), type A
+            if( prev_state.new_ids.find( item.first ) != prev_state.new_ids.end() ||
+                prev_state.old_values.find( item.first ) != prev_state.old_values.end() ||
+                prev_state.partial_values.find( item.first ) != prev_state.partial_values.end() )
+              continue;
+            // del+upd -> N/A
+            assert( prev_state.removed_values.find( item.first ) == prev_state.removed_values.end() );
+            // nop+upd(was=Y) -> upd(was=Y), type B
+            prev_state.partial_values.emplace( item );
+          }
+        }
 
         for( auto& item : state.old_values )
         {
@@ -740,6 +948,18 @@ namespace chainbase {
             // upd(was=X) + upd(was=Y) -> upd(was=X), type A
             continue;
           }
+          if constexpr( has_undo_partial )
+          {
+            auto it = prev_state.partial_values.find( item.second.get_id() );
+            if( it != prev_state.partial_values.end() )
+            {
+              // upd(was=X partially) + upd(was=Y) -> upd(was=Y with group from X), type C
+              item.second.set_undo_partial( it->second );
+              prev_state.old_values.emplace( std::move(item) );
+              prev_state.partial_values.erase( it );
+              continue;
+            }
+          }
           // del+upd -> N/A
           assert( prev_state.removed_values.find( item.second.get_id() ) == prev_state.removed_values.end() );
           // nop+upd(was=Y) -> upd(was=Y), type B
@@ -767,6 +987,18 @@ namespace chainbase {
             prev_state.old_values.erase( obj.second.get_id() );
             continue;
           }
+          if constexpr( has_undo_partial )
+          {
+            auto pit = prev_state.partial_values.find( obj.second.get_id() );
+            if( pit != prev_state.partial_values.end() )
+            {
+              // upd(was=X partially) + del(was=Y) -> del(was=Y with group from X)
+              obj.second.set_undo_partial( pit->second );
+              prev_state.removed_values.emplace( std::move(obj) );
+              prev_state.partial_values.erase( pit );
+              continue;
+            }
+          }
           // del + del -> N/A
           assert( prev_state.removed_values.find( obj.second.get_id() ) == prev_state.removed_values.end() );
           // nop + del(was=Y) -> del(was=Y)
@@ -818,9 +1050,40 @@ namespace chainbase {
         if( itr != head.old_values.end() )
           return;
 
+        if constexpr( has_undo_partial )
+        {
+          auto pitr = head.partial_values.find( v.get_id() );
+          if( pitr != head.partial_values.end() )
+          {
+            // object was partially modified before - members outside of the group still hold original values
+            value_type old_value = v.copy_chain_object();
+            old_value.set_undo_partial( pitr->second );
+            head.old_values.emplace( v.get_id(), std::move( old_value ) );
+            head.partial_values.erase( pitr );
+            return;
+          }
+        }
+
         head.old_values.emplace( v.get_id(), v.copy_chain_object() );
       }
 
+      void on_modify_partial( const value_type& v ) {
+        if( !enabled() ) return;
+
+        auto& head = _stack.back();
+
+        if( head.new_ids.find( v.get_id() ) != head.new_ids.end() )
+          return;
+        if( head.old_values.find( v.get_id() ) != head.old_values.end() )
+          return;
+        if( head.partial_values.find( v.get_id() ) != head.partial_values.end() )
+          return;
+
+        partial_type old_value;
+        v.get_undo_partial( old_value );
+        head.partial_values.emplace( v.get_id(), old_value );
+      }
+
       void on_remove( const value_type& v ) {
         if( !enabled() ) return;
 
@@ -837,6 +1100,19 @@ namespace chainbase {
           return;
         }
 
+        if constexpr( has_undo_partial )
+        {
+          auto pitr = head.partial_values.find( v.get_id() );
+          if( pitr != head.partial_values.end() )
+          {
+            value_type old_value = v.copy_chain_object();
+            old_value.set_undo_partial( pitr->second );
+            head.removed_values.emplace( v.get_id(), std::move( old_value ) );
+            head.partial_values.erase( pitr );
+            return;
+          }
+        }
+
         if( head.removed_values.count( v.get_id() ) )
           return;
 
@@ -850,7 +1126,47 @@ namespace chainbase {
         head.new_ids.insert( v.get_id() );
       }
 
+      /// allocator for dynamic members of objects (nodes of the index itself come from node_allocator)
+      allocator< value_type > get_object_allocator() const {
+#ifdef ENABLE_STD_ALLOCATOR
+        return allocator< value_type >();
+#else
+        // regular allocator is just a pointer to segment manager, unlike node allocator of the index (copying it
+        // touches reference counter of its pool)
+        return allocator< value_type >( _stack.get_allocator() );
+#endif
+      }
+
+      void notify_inserted( const value_type& v ) const {
+        const auto* secondary_indexes = secondary_index_registry< value_type >::find( this );
+        if( secondary_indexes == nullptr ) return;
+        for( const auto& secondary : *secondary_indexes )
+          secondary->object_inserted( v );
+      }
+
+      void notify_removed( const value_type& v ) const {
+        const auto* secondary_indexes = secondary_index_registry< value_type >::find( this );
+        if( secondary_indexes == nullptr ) return;
+        for( const auto& secondary : *secondary_indexes )
+          secondary->object_removed( v );
+      }
+
+      void notify_about_to_modify( const value_type& v ) const {
+        const auto* secondary_indexes = secondary_index_registry< value_type >::find( this );
+        if( secondary_indexes == nullptr ) return;
+        for( const auto& secondary : *secondary_indexes )
+          secondary->about_to_modify( v );
+      }
+
+      void notify_modified( const value_type& v ) const {
+        const auto* secondary_indexes = secondary_index_registry< value_type >::find( this );
+        if( secondary_indexes == nullptr ) return;
+        for( const auto& secondary : *secondary_indexes )
+          secondary->object_modified( v );
+      }
+
       boost::interprocess::deque< undo_state_type, allocator<undo_state_type> > _stack;
+      typename undo_state_type::allocators                                      _undo_allocators;
 
       /**
         *  Each new session increments the revision, a squash will decrement the revision by combining
@@ -921,6 +1237,8 @@ namespace chainbase {
 
       virtual void dump_snapshot(snapshot_writer& writer) const = 0;
       virtual void load_snapshot(snapshot_reader& reader) = 0;
+      /// copies contents into (empty) index of the same type from another database, see generic_index::copy_to
+      virtual void copy_to( abstract_index& target ) const = 0;
 
       void add_index_extension( std::shared_ptr< index_extension > ext )  { _extensions.push_back( ext ); }
       const index_extensions& get_index_extensions()const  { return _extensions; }
@@ -936,7 +1254,22 @@ namespace chainbase {
     public:
       using abstract_index::statistic_info;
 
-      index_impl( BaseIndex& base ):abstract_index( &base ),_base(base){}
+      index_impl( BaseIndex& base ):abstract_index( &base ),_base(base) {}
+
+      virtual ~index_impl()
+      {
+        if( !_secondary_indexes.empty() )
+          secondary_index_registry< typename BaseIndex::value_type >::bind( &_base, nullptr );
+      }
+
+      void add_secondary_index( std::shared_ptr< secondary_index< typename BaseIndex::value_type > > secondary )
+      {
+        secondary->clear();
+        for( const auto& obj : _base.indices() )
+          secondary->object_inserted( obj );
+        _secondary_indexes.push_back( std::move( secondary ) );
+        secondary_index_registry< typename BaseIndex::value_type >::bind( &_base, &_secondary_indexes );
+      }
 
       virtual unique_ptr<abstract_session> start_undo_session() override {
         return unique_ptr<abstract_session>(new session_impl<typename BaseIndex::session>( _base.start_undo_session() ) );
@@ -981,6 +1314,13 @@ namespace chainbase {
         dumper.dump(_base.get_next_id());
       }
 
+      virtual void copy_to( abstract_index& target ) const override final
+      {
+        if( target.type_id() != type_id() )
+          CHAINBASE_THROW_EXCEPTION( std::logic_error( "cannot copy index into index of different type" ) );
+        _base.copy_to( *static_cast< BaseIndex* >( target.get() ) );
+      }
+
       virtual void load_snapshot(snapshot_reader& reader) override final
       {
         clear();
@@ -992,6 +1332,7 @@ namespace chainbase {
 
     private:
       BaseIndex& _base;
+      secondary_index_list< typename BaseIndex::value_type > _secondary_indexes;
   };
 
   template<typename IndexType>
@@ -1000,6 +1341,51 @@ namespace chainbase {
       index( IndexType& i ):index_impl<IndexType>( i ){}
   };
 
+  /**
+    * Version of persisted layout of chainbase's own structures (index headers, undo state, allocators of their
+    * containers). Neither environment_check nor decoded types check (which only sees declared object and index types)
+    * notices when those change, and an old index found by name would be silently reinterpreted, so the version has
+    * to be bumped with each such change. Kept as separate object, so files older than the version itself are also
+    * recognized (by its absence).
+    *   1 - partial undo values in undo_state (CHAINBASE_UNDO_PARTIAL)
+    *   2 - nodes of indexes and undo state allocated from node pools (pooled_index, node_allocator)
+    */
+  struct shared_memory_format
+  {
+    static constexpr uint32_t current_version = 2;
+
+    uint32_t version = current_version;
+  };
+
+  /**
+    * Flags accepted by database::open, controlling placement of the shared memory segment in physical memory.
+    * All of them except heap_backed and copy_on_write are hints - when not supported by the platform or the filesystem,
+    * a warning is logged and the segment is used as is.
+    */
+  enum open_flags : uint32_t
+  {
+    /// Advise the kernel to back the segment with transparent huge pages (MADV_HUGEPAGE).
+    huge_pages      = 0x01,
+    /// Fault in all segment pages right after mapping (done in parallel), instead of during first blocks/API calls.
+    prefault        = 0x02,
+    /// Spread segment pages evenly over NUMA nodes given by set_numa_nodes (MPOL_INTERLEAVE).
+    numa_interleave = 0x04,
+    /// Allocate segment pages only from NUMA nodes given by set_numa_nodes (MPOL_BIND).
+    numa_bind       = 0x08,
+    /**
+      * Keep the segment in anonymous process memory instead of shared_memory.bin - nothing is created on disk, state
+      * is lost on close. Object layout (and allocator type) is the same as with the file, so it is meant for tests and
+      * throwaway nodes that would otherwise spend most of their startup creating and removing the file.
+      */
+    heap_backed     = 0x10,
+    /**
+      * Map existing shared_memory.bin privately - changes stay in process memory and the file is never modified, so
+      * any number of processes (each holding shared lock on the file) can start from the same prepared state, e.g.
+      * a chain initialized once for many tests. The file cannot be created, wiped, resized or grown in this mode.
+      */
+    copy_on_write   = 0x20
+  };
+
   struct lock_exception : public std::exception
   {
     explicit lock_exception() {}
@@ -1033,15 +1419,51 @@ namespace chainbase {
       };
 
       void wipe_indexes();
+      void apply_segment_placement( const bfs::path& dir, char* address, size_t size );
+      void reserve_address_space( const bfs::path& file );
+      void release_address_space();
+      void open_heap_segment( size_t size );
+      bool grow_heap_segment( size_t new_size );
+      void start_background_flush();
+      void stop_background_flush();
+      void background_flush_loop();
 
     public:
+      ~database();
+
       void open( const bfs::path& dir, uint32_t flags = 0, size_t shared_file_size = 0, const boost::any& database_cfg = nullptr, const helpers::environment_extension_resources* environment_extension = nullptr, const bool wipe_shared_file = false );
       bool check_plugins(const helpers::environment_extension_resources* environment_extension); // bool - throw error if state definitions mismatch
       void close();
       void flush();
       void wipe( const bfs::path& dir );
+      /**
+        * Copies environment data and contents of all indexes into freshly created `target`, which must have the same
+        * indexes added in the same order. Objects are put there index by index, in id order, so nodes of each index
+        * are packed in blocks of node pools next to each other and the file holds only live data - used to defragment
+        * long living state.
+        */
+      void copy_to( database& target ) const;
+      /// Names of objects chainbase itself keeps in the segment (indexes are stored under names of their value types).
+      static const std::set< std::string >& get_internal_segment_names();
       void resize( size_t new_shared_file_size );
+      /**
+        * Extends shared memory file and the segment in place, what is possible when address space was reserved at open
+        * (see set_max_shared_file_size). Unlike resize() it does not remap the segment, so it can be called also when
+        * undo sessions are active. Returns false if in place growth is not possible.
+        */
+      bool grow( size_t new_shared_file_size );
+      /// Size of address space reserved at open for future grow() calls (0 or value not exceeding file size disables reservation).
+      void set_max_shared_file_size( size_t max_shared_file_size ) { _max_file_size = max_shared_file_size; }
+      /**
+        * Enables (non zero value) or disables thread, which continuously writes back dirty pages of the segment, walking
+        * it in chunks so at most given number of bytes of the mapping is covered per second. Since the kernel only writes
+        * pages modified since last writeback, flush() called when the thread is running has little work left to do.
+        */
+      void set_background_flush_rate( size_t bytes_per_second );
+      bool is_background_flush_enabled() const { return _background_flush_rate != 0; }
       void set_require_locking( bool enable_require_locking );
+      /// Mask of NUMA nodes used by numa_interleave/numa_bind open flags (bit N means node N). 0 means all nodes.
+      void set_numa_nodes( uint64_t numa_nodes_mask ) { _numa_nodes_mask = numa_nodes_mask; }
 
 #ifdef CHAINBASE_CHECK_LOCKING
       void require_lock_fail( const char* method, const char* lock_type, const char* tname )const;
@@ -1133,13 +1555,22 @@ namespace chainbase {
         _index_types.push_back( std::move(new_index) );
       }
 
+      typedef bip::managed_mapped_file::segment_manager segment_manager_type;
+      /// same allocation algorithm (and mutex) as managed_mapped_file, unlike bip::managed_external_buffer
+      typedef bip::basic_managed_external_buffer< char, bip::rbtree_best_fit< bip::mutex_family >, bip::iset_index > heap_segment_type;
+      static_assert( std::is_same< segment_manager_type, heap_segment_type::segment_manager >::value,
+        "heap backed segment has to use the same allocator as the file" );
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wnonnull"
-      auto get_segment_manager() -> decltype( ((bip::managed_mapped_file*)nullptr)->get_segment_manager()) {
-        return _segment->get_segment_manager();
+      segment_manager_type* get_segment_manager()const {
+        return _heap_segment ? _heap_segment->get_segment_manager() : _segment->get_segment_manager();
       }
 #pragma GCC diagnostic pop
 
+      /// true when opened with heap_backed flag (segment is not backed by any file)
+      bool is_heap_backed()const { return _heap_backed; }
+
       unsigned long long get_total_system_memory() const
       {
 #if !defined( __APPLE__ ) // OS X does not support _SC_AVPHYS_PAGES
@@ -1153,7 +1584,7 @@ namespace chainbase {
 
       size_t get_free_memory()const
       {
-        return _segment->get_segment_manager()->get_free_memory();
+        return get_segment_manager()->get_free_memory();
       }
 
       size_t get_max_memory()const
@@ -1199,6 +1630,25 @@ namespace chainbase {
         _index_map[index_type::value_type::type_id]->add_index_extension( ext );
       }
 
+      /**
+        * Registers process-local secondary index of objects of MultiIndexType (see secondary_index). It is filled
+        * with objects already present and then notified about all changes, including undo. Registration does not
+        * survive closing of database, so it has to be repeated after each open (f.e. from _plugin_index_signal).
+        */
+      template<typename MultiIndexType>
+      void add_secondary_index( std::shared_ptr< secondary_index< typename MultiIndexType::value_type > > secondary )
+      {
+        typedef generic_index<MultiIndexType> index_type;
+
+        if( !has_index< MultiIndexType >() )
+        {
+          std::string type_name = boost::core::demangle( typeid( typename index_type::value_type ).name() );
+          CHAINBASE_THROW_EXCEPTION( std::runtime_error( "unable to find index for " + type_name + " in database" ) );
+        }
+
+        static_cast< index< index_type >* >( _index_map[index_type::value_type::type_id].get() )->add_secondary_index( std::move( secondary ) );
+      }
+
       template<typename MultiIndexType, typename ByIndex>
       auto get_index()const -> decltype( ((generic_index<MultiIndexType>*)( nullptr ))->indicies().template get<ByIndex>() )
       {
@@ -1301,6 +1751,15 @@ namespace chainbase {
           get_mutable_index<index_type>().modify( obj, std::forward<Modifier>( m ) );
       }
 
+      /// like modify(), but only for members of CHAINBASE_UNDO_PARTIAL group, which makes undo state smaller
+      template<typename ObjectType, typename Modifier>
+      void modify_partial( const ObjectType& obj, Modifier&& m )
+      {
+          CHAINBASE_REQUIRE_WRITE_LOCK("modify", ObjectType);
+          typedef typename get_index_type<ObjectType>::type index_type;
+          get_mutable_index<index_type>().modify_partial( obj, std::forward<Modifier>( m ) );
+      }
+
       template<typename ObjectType>
       void remove( const ObjectType& obj )
       {
@@ -1427,13 +1886,13 @@ namespace chainbase {
         }
         index_type* idx_ptr =  nullptr;
 #ifndef ENABLE_STD_ALLOCATOR
-        auto _found = _segment->find< index_type >( type_name.c_str() );
+        auto _found = get_segment_manager()->find< index_type >( type_name.c_str() );
         if( !_found.first )
         {
           _at_least_one_index_is_created_now = true;
           if( _at_least_one_index_is_created_now && _at_least_one_index_was_created_earlier )
             CHAINBASE_THROW_EXCEPTION( std::logic_error( "Inconsistency occurs. A new index is created, but other indexes are found in `shared_memory_file` file. A replay is needed. Problem with: " + type_name ) );
-          idx_ptr = _segment->construct< index_type >( type_name.c_str() )( index_alloc( _segment->get_segment_manager() ) );
+          idx_ptr = get_segment_manager()->construct< index_type >( type_name.c_str() )( index_alloc( get_segment_manager() ) );
         }
         else
         {
@@ -1458,6 +1917,9 @@ namespace chainbase {
       read_write_mutex                                            _rw_lock;
 
       unique_ptr<bip::managed_mapped_file>                        _segment;
+      /// used instead of _segment when opened with heap_backed flag; memory itself is the reserved address range
+      unique_ptr<heap_segment_type>                               _heap_segment;
+      bool                                                        _heap_backed = false;
       unique_ptr<bip::managed_mapped_file>                        _meta;
       bip::file_lock                                              _flock;
 
@@ -1485,6 +1947,22 @@ namespace chainbase {
 
       int32_t                                                     _undo_session_count = 0;
       size_t                                                      _file_size = 0;
+      uint32_t                                                    _open_flags = 0;
+      size_t                                                      _max_file_size = 0;
+      char*                                                       _reserved_address = nullptr;
+      size_t                                                      _reserved_size = 0;
+      /// Part of reserved address space mapped by _segment itself (rest of the file is mapped by grow())
+      size_t                                                      _mapped_size = 0;
+      int                                                         _segment_fd = -1;
+
+      size_t                                                      _background_flush_rate = 0;
+      std::thread                                                 _background_flush_thread;
+      std::mutex                                                  _background_flush_mutex;
+      std::condition_variable                                     _background_flush_cv;
+      bool                                                        _background_flush_stop = false;
+      /// Size of the mapping covered by background flush (grows together with the file)
+      std::atomic<size_t>                                         _flushable_size = {0};
+      uint64_t                                                    _numa_nodes_mask = 0;
       boost::any                                                  _database_cfg = nullptr;
 
       bool                                                        _at_least_one_index_was_created_earlier = false;
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace chainbase {
+
+  /**
+    * Process-local data derived from objects of one index (usually additional ordering needed only by APIs).
+    * It lives outside of shared memory, so it is not part of consensus state and does not survive restart -
+    * it is filled from existing objects when registered with database::add_secondary_index().
+    *
+    * generic_index reports every change of its objects, including changes made by undo. Between
+    * about_to_modify() and object_modified() the object is in transition; if modification fails (multi_index
+    * drops object that violates uniqueness constraint) object_modified() is not called at all, so implementations
+    * should treat the object as removed once about_to_modify() is called.
+    *
+    * Notifications are sent under write lock, same as changes of the index itself, so readers holding read lock
+    * can access secondary index without additional synchronization.
+    */
+  template< typename value_type >
+  class secondary_index
+  {
+    public:
+      virtual ~secondary_index() {}
+
+      virtual void object_inserted( const value_type& obj ) = 0;
+      /// called right before object is erased from index
+      virtual void object_removed( const value_type& obj ) = 0;
+      /// called right before object is modified (it still holds old values)
+      virtual void about_to_modify( const value_type& obj ) = 0;
+      virtual void object_modified( const value_type& obj ) = 0;
+      /// called when all objects are removed at once
+      virtual void clear() = 0;
+  };
+
+  template< typename value_type >
+  using secondary_index_list = std::vector< std::shared_ptr< secondary_index< value_type > > >;
+
+  /**
+    * Binds secondary indexes to the index they follow. The index lives in shared memory, so it cannot hold pointer to
+    * process-local list - the segment is also mapped by other processes (or other databases of this process, f.e.
+    * copy-on-write clone) with different secondary indexes or none, so binding is keyed by address of the index in
+    * this process. Bindings are looked up on every change of objects; there is usually none (check costs single
+    * atomic load) or one per index type, so they form lock-free list that is only appended to.
+    */
+  template< typename value_type >
+  class secondary_index_registry
+  {
+    public:
+      typedef secondary_index_list< value_type > list_type;
+
+      static const list_type* find( const void* index )
+      {
+        for( const binding* b = _bindings.load( std::memory_order_acquire ); b != nullptr; b = b->next )
+          if( b->index == index )
+            return b->list.load( std::memory_order_acquire );
+        return nullptr;
+      }
+
+      /// list has to be unbound (nullptr) before it is destroyed
+      static void bind( const void* index, const list_type* list )
+      {
+        for( binding* b = _bindings.load( std::memory_order_acquire ); b != nullptr; b = b->next )
+        {
+          if( b->index == index )
+          {
+            b->list.store( list, std::memory_order_release );
+            return;
+          }
+        }
+        if( list == nullptr )
+          return;
+
+        binding* b = new binding( index, list, _bindings.load( std::memory_order_relaxed ) );
+        while( !_bindings.compare_exchange_weak( b->next, b, std::memory_order_release, std::memory_order_relaxed ) );
+      }
+
+    private:
+      struct binding
+      {
+        binding( const void* _index, const list_type* _list, binding* _next ) : index( _index ), list( _list ), next( _next ) {}
+
+        const void* const               index;
+        std::atomic< const list_type* > list;
+        binding*                        next;
+      };
+
+      static inline std::atomic< binding* > _bindings = { nullptr };
+  };
+
+  /**
+    * Secondary index keeping objects ordered by key extracted with KeyFromValue (boost::multi_index key extractor,
+    * e.g. member<>, or any functor that returns the key by value - keys are copied, composite_key is not supported).
+    * Objects with equal keys are ordered by id. Entries point to objects in the index, so they can only be used
+    * while holding read lock.
+    */
+  template< typename value_type, typename KeyFromValue, typename KeyCompare = std::less<> >
+  class ordered_secondary_index : public secondary_index< value_type >
+  {
+    public:
+      typedef typename value_type::id_type id_type;
+      typedef std::decay_t< decltype( std::declval< const KeyFromValue& >()( std::declval< const value_type& >() ) ) > key_type;
+
+      struct entry
+      {
+        key_type          key;
+        id_type           id;
+        const value_type* object = nullptr;
+      };
+
+      struct entry_compare
+      {
+        typedef void is_transparent;
+
+        bool operator()( const entry& a, const entry& b )const
+        {
+          if( key_compare( a.key, b.key ) )
+            return true;
+          if( key_compare( b.key, a.key ) )
+            return false;
+          return a.id < b.id;
+        }
+        bool operator()( const entry& a, const key_type& b )const { return key_compare( a.key, b ); }
+        bool operator()( const key_type& a, const entry& b )const { return key_compare( a, b.key ); }
+
+        KeyCompare key_compare;
+      };
+
+      typedef std::set< entry, entry_compare > container_type;
+      typedef typename container_type::const_iterator iterator;
+
+      ordered_secondary_index( KeyFromValue key = KeyFromValue(), KeyCompare compare = KeyCompare() )
+        : _key( std::move( key ) ), _entries( entry_compare{ std::move( compare ) } ) {}
+
+      virtual void object_inserted( const value_type& obj ) override
+      {
+        _entries.insert( make_entry( obj ) );
+      }
+
+      virtual void object_removed( const value_type& obj ) override
+      {
+        _entries.erase( make_entry( obj ) );
+      }
+
+      virtual void about_to_modify( const value_type& obj ) override
+      {
+        // node is kept aside (no deallocation) together with its position, so when key does not change
+        // (most common case) putting it back is cheap
+        auto itr = _entries.find( make_entry( obj ) );
+        if( itr == _entries.end() )
+        {
+          _pending = typename container_type::node_type();
+          return;
+        }
+        _pending_hint = std::next( itr );
+        _pending = _entries.extract( itr );
+      }
+
+      virtual void object_modified( const value_type& obj ) override
+      {
+        if( _pending.empty() )
+        {
+          object_inserted( obj );
+          return;
+        }
+
+        entry& e = _pending.value();
+        e.object = &obj;
+        key_type new_key = _key( obj );
+        const auto& key_compare = _entries.key_comp().key_compare;
+        if( key_compare( e.key, new_key ) || key_compare( new_key, e.key ) )
+        {
+          e.key = std::move( new_key );
+          _entries.insert( std::move( _pending ) );
+        }
+        else
+        {
+          _entries.insert( _pending_hint, std::move( _pending ) );
+        }
+      }
+
+      virtual void clear() override
+      {
+        _entries.clear();
+        _pending = typename container_type::node_type();
+      }
+
+      iterator begin()const { return _entries.begin(); }
+      iterator end()const { return _entries.end(); }
+      size_t size()const { return _entries.size(); }
+
+      /// first entry with key not less than given one
+      iterator lower_bound( const key_type& key )const { return _entries.lower_bound( key ); }
+      /// first entry with key greater than given one
+      iterator upper_bound( const key_type& key )const { return _entries.upper_bound( key ); }
+      /// first entry not less than given key and id (continuation of paged listing)
+      iterator lower_bound( const key_type& key, id_type id )const { return _entries.lower_bound( entry{ key, id } ); }
+
+    private:
+      entry make_entry( const value_type& obj )const
+      {
+        return entry{ _key( obj ), obj.get_id(), &obj };
+      }
+
+      KeyFromValue                            _key;
+      container_type                          _entries;
+      typename container_type::node_type      _pending;
+      iterator                                _pending_hint;
+  };
+
+} // namespace chainbase
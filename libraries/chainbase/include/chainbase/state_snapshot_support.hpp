@@ -11,6 +11,7 @@
 #include <fc/io/json.hpp>
 
 #include <functional>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,13 @@ inline void unpack_from_buffer(T& v, const B& raw)
   fc::raw::unpack(ds, v);
   }
 
+template< typename T >
+inline void unpack_from_buffer(T& v, const char* data, size_t size)
+  {
+  fc::datastream<const char*> ds(data, size);
+  fc::raw::unpack(ds, v);
+  }
+
 } /// namespace serialization
 
 
@@ -56,6 +64,8 @@ class snapshot_base_serializer
         typedef std::vector< id_serialized_object> serialized_object_cache;
 
         size_t get_serialized_object_cache_max_size() const;
+        /// Max number of objects decoded by single loading worker before they are put into target index.
+        size_t get_decoded_object_batch_max_size() const;
 
         std::pair<size_t, size_t> get_processing_range() const
           {
@@ -132,9 +142,13 @@ class snapshot_reader : public snapshot_base_serializer
     class worker : public worker_common_base
       {
       public:
-        /** Allows to load data from snapshot into the cache. 
+        /// Receives id and a view of serialized object data, valid only during the call.
+        typedef std::function<void(size_t id, const char* data, size_t size)> serialized_object_visitor;
+
+        /** Allows to process next part (up to maxCount items) of data stored in the snapshot, directly from storage buffers.
+            Returns number of visited objects, 0 means that all data has been processed.
         */
-        virtual void load_converted_data(worker_common_base::serialized_object_cache* cache) = 0;
+        virtual size_t visit_converted_data(size_t maxCount, const serialized_object_visitor& visitor) = 0;
         virtual std::string prettifyObject(const fc::variant& object, const std::vector<char>& buffer) const = 0;
 
         void update_processed_id(size_t id)
@@ -428,62 +442,67 @@ class generic_index_snapshot_loader final : public generic_index_serialize_base
     class loader_data final : public snapshot_reader::worker_data
       {
       public:
-        loader_data(GenericIndexType& genericIndex, MultiIndexType& multiIndex, const snapshot_reader::worker* worker, const std::string& indexDescription) :
+        loader_data(GenericIndexType& genericIndex, std::mutex& insertionMutex, const snapshot_reader::worker* worker,
+          const std::string& indexDescription) :
           _generic_index(genericIndex),
-          _data_source(multiIndex),
+          _insertion_mutex(insertionMutex),
           _indexDescription(indexDescription)
           {
           }
 
         virtual ~loader_data() = default;
 
+        /** Decoding of objects (including their dynamic members allocations) is done by each worker on its own,
+            and only insertion of already decoded batch into the target index is serialized between workers
+            of given index.
+        */
         void doConversion(snapshot_reader::worker* worker)
           {
-          typedef typename MultiIndexType::value_type::id_type id_type;
+          typedef typename MultiIndexType::value_type value_type;
+          typedef typename value_type::id_type id_type;
 
-          const uint32_t max_cache_size = worker->get_serialized_object_cache_max_size();
-          snapshot_writer::worker::serialized_object_cache serializedCache;
-          serializedCache.reserve(max_cache_size);
+          const size_t max_batch_size = worker->get_decoded_object_batch_max_size();
+          std::vector<value_type> decodedBatch;
+          decodedBatch.reserve(max_batch_size);
 
-          while(1)
+          auto decoder = [this, worker, &decodedBatch](size_t id, const char* data, size_t size)
             {
-            serializedCache.clear();
-            worker->load_converted_data(&serializedCache);
+            /// Just to catch loading context on some caught exception.
+            worker->update_processed_id(id);
 
-            if(serializedCache.empty())
-              break;
+            decodedBatch.emplace_back(_generic_index.decode_from_snapshot(id_type(id),
+              [data, size](value_type& object)
+              {
+              serialization::unpack_from_buffer(object, data, size);
+              }));
+            };
 
-            size_t f = serializedCache.front().first;
-            size_t l = serializedCache.back().first;
+          auto prettyDump = [worker](const fc::variant& object) -> std::string
+            {
+            return worker->prettifyObject(object, std::vector<char>());
+            };
 
-            ilog("Loading items <${b}, ${e}> from ${s}", ("b", f)("e", l)("s", _indexDescription));
+          while(worker->visit_converted_data(max_batch_size, decoder) != 0)
+            {
+            size_t f = decodedBatch.front().get_id();
+            size_t l = decodedBatch.back().get_id();
 
-            for(const auto& buffer : serializedCache)
-              {
-              /// Just to catch loading context on some caught exception.
-              worker->update_processed_id(buffer.first);
+            ilog("Loading items <${b}, ${e}> from ${s}", ("b", f)("e", l)("s", _indexDescription));
 
-              auto prettyDump = [&buffer, worker](fc::variant object) -> std::string
               {
-                return worker->prettifyObject(object, buffer.second);
-              };
-
-              _generic_index.unpack_from_snapshot(id_type(buffer.first),
-                [this, &buffer](typename MultiIndexType::value_type& object)
-                {
-                serialization::unpack_from_buffer(object, buffer.second);
-                },
-                std::move(prettyDump)
-                );
+              std::lock_guard<std::mutex> guard(_insertion_mutex);
+              _generic_index.insert_snapshot_batch(decodedBatch, prettyDump);
               }
 
+            decodedBatch.clear();
+
             ilog("Finished loading items <${b}, ${e}> from ${s}", ("b", f)("e", l)("s", _indexDescription));
             }
           }
 
       private:
         GenericIndexType& _generic_index;
-        MultiIndexType& _data_source;
+        std::mutex& _insertion_mutex;
         std::string _indexDescription;
       };
 
@@ -509,7 +528,7 @@ class generic_index_snapshot_loader final : public generic_index_serialize_base
 
       for(auto* w : workers)
         {
-        workerData.emplace_back(std::make_unique<loader_t>(_index, index, w, indexName));
+        workerData.emplace_back(std::make_unique<loader_t>(_index, _insertion_mutex, w, indexName));
         w->associate_data(*workerData.back());
         }
 
@@ -521,6 +540,8 @@ class generic_index_snapshot_loader final : public generic_index_serialize_base
   private:
     GenericIndexType& _index;
     snapshot_reader&  _reader;
+    /// Serializes insertions into _index done by workers decoding subsequent parts of the snapshot concurrently.
+    std::mutex        _insertion_mutex;
   };
 
 } /// namespace chainbase
@@ -6,14 +6,97 @@
 #include <fc/io/json.hpp>
 
 #include <filesystem>
+#include <thread>
+
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
 
 namespace chainbase {
 
+namespace {
+
+#ifdef __linux__
+  // values from <linux/magic.h> and <numaif.h>, defined here to avoid dependency on libnuma headers
+  constexpr unsigned long HUGETLBFS_MAGIC_VALUE = 0x958458f6;
+  constexpr unsigned long MPOL_BIND_VALUE = 2;
+  constexpr unsigned long MPOL_INTERLEAVE_VALUE = 3;
+  constexpr unsigned long MPOL_MF_MOVE_VALUE = 1 << 1;
+
+  /// Returns huge page size if given directory is located on hugetlbfs mount, 0 otherwise.
+  size_t get_hugetlbfs_page_size( const bfs::path& dir )
+  {
+    struct statfs fs_info;
+    if( statfs( dir.generic_string().c_str(), &fs_info ) == 0 && static_cast< unsigned long >( fs_info.f_type ) == HUGETLBFS_MAGIC_VALUE )
+      return fs_info.f_bsize;
+    return 0;
+  }
+
+  /// Returns mask of NUMA nodes present in the system (bit N set means node N exists).
+  uint64_t get_all_numa_nodes()
+  {
+    uint64_t mask = 0;
+    for( uint32_t node = 0; node < 64; ++node )
+    {
+      if( bfs::exists( "/sys/devices/system/node/node" + std::to_string( node ) ) )
+        mask |= uint64_t( 1 ) << node;
+    }
+    return mask;
+  }
+
+  /// Faults in all pages of given range, splitting work between all available cores.
+  void prefault_range( char* address, size_t size )
+  {
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    const size_t thread_count = std::max( 1u, std::thread::hardware_concurrency() );
+    const size_t chunk_size = ( size / thread_count / page_size + 1 ) * page_size;
+
+    auto start = fc::time_point::now();
+
+    std::vector< std::thread > threads;
+    for( size_t offset = 0; offset < size; offset += chunk_size )
+    {
+      threads.emplace_back( [address, size, offset, chunk_size, page_size]()
+      {
+        const size_t length = std::min( chunk_size, size - offset );
+#ifdef MADV_POPULATE_READ
+        // read (not write) population, so pages are not marked dirty and won't be written back on flush
+        if( madvise( address + offset, length, MADV_POPULATE_READ ) == 0 )
+          return;
+#endif
+        const volatile char* data = address + offset;
+        char sink = 0;
+        for( size_t i = 0; i < length; i += page_size )
+          sink ^= data[ i ];
+        (void)sink;
+      } );
+    }
+
+    for( auto& t : threads )
+      t.join();
+
+    ilog( "Prefaulted ${size} bytes of shared memory segment using ${n} threads in ${t} ms",
+      ( size )( "n", threads.size() )( "t", ( fc::time_point::now() - start ).count() / 1000 ) );
+  }
+#endif
+
+} // namespace
+
 size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache_max_size() const
 {
   return 512 * 1024;
 }
 
+size_t snapshot_base_serializer::worker_common_base::get_decoded_object_batch_max_size() const
+{
+  return 64 * 1024;
+}
+
   class environment_check {
 
     public:
@@ -205,18 +288,50 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
       bool                    created_storage = true;
   };
 
+  database::~database()
+  {
+    stop_background_flush();
+  }
+
   void database::open( const bfs::path& dir, uint32_t flags, size_t shared_file_size, const boost::any& database_cfg, const helpers::environment_extension_resources* environment_extension, const bool wipe_shared_file )
   {
     assert( dir.is_absolute() );
     bfs::create_directories( dir );
     if( _data_dir != dir ) close();
+    if( wipe_shared_file && ( flags & copy_on_write ) )
+      BOOST_THROW_EXCEPTION( std::runtime_error( "Cannot wipe shared memory file opened in copy-on-write mode" ) );
     if( wipe_shared_file ) wipe( dir );
 
     _data_dir = dir;
     _database_cfg = database_cfg;
+    _open_flags = flags;
 #ifndef ENABLE_STD_ALLOCATOR
+    _heap_backed = flags & heap_backed;
+    if( _heap_backed )
+    {
+      open_heap_segment( shared_file_size );
+
+      auto env = get_segment_manager()->find< environment_check >( "environment" );
+      if( environment_extension )
+        env.first->test_version(*environment_extension);
+
+      apply_segment_placement( dir, _reserved_address, _file_size );
+      _is_open = true;
+      return;
+    }
+
     auto abs_path = bfs::absolute( dir / "shared_memory.bin" );
 
+#ifdef __linux__
+    // files on hugetlbfs can only have size being multiple of huge page size
+    const size_t huge_page_size = get_hugetlbfs_page_size( dir );
+    if( huge_page_size != 0 && shared_file_size % huge_page_size != 0 )
+    {
+      shared_file_size += huge_page_size - shared_file_size % huge_page_size;
+      ilog( "Shared memory file located on hugetlbfs - size rounded up to ${shared_file_size}", ( shared_file_size ) );
+    }
+#endif
+
     auto _size_checker = [&dir]( size_t size )
     {
       std::filesystem::space_info _space_info = std::filesystem::space( dir.generic_string().c_str() );
@@ -225,10 +340,16 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
         BOOST_THROW_EXCEPTION( std::runtime_error( "Unable to create shared memory file. Free space available is less than declared size of shared memory file." ) );
     };
 
+    const bool cow = flags & copy_on_write;
     if( bfs::exists( abs_path ) )
     {
       _file_size = bfs::file_size( abs_path );
-      if( shared_file_size > _file_size )
+      if( cow )
+      {
+        if( shared_file_size > _file_size )
+          wlog( "Shared memory file opened in copy-on-write mode cannot grow - using its current size ${_file_size}", ( _file_size ) );
+      }
+      else if( shared_file_size > _file_size )
       {
         _size_checker( shared_file_size - _file_size );
         if( !bip::managed_mapped_file::grow( abs_path.generic_string().c_str(), shared_file_size - _file_size ) )
@@ -237,9 +358,14 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
         _file_size = shared_file_size;
       }
 
-      _segment.reset( new bip::managed_mapped_file( bip::open_only,
-                                      abs_path.generic_string().c_str()
-                                      ) );
+      if( cow )
+        _segment.reset( new bip::managed_mapped_file( bip::open_copy_on_write,
+                                        abs_path.generic_string().c_str()
+                                        ) );
+      else
+        _segment.reset( new bip::managed_mapped_file( bip::open_only,
+                                        abs_path.generic_string().c_str()
+                                        ) );
 
       auto env = _segment->find< environment_check >( "environment" );
       environment_check eCheck( allocator< environment_check >( _segment->get_segment_manager() ) );
@@ -252,36 +378,356 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
         BOOST_THROW_EXCEPTION(std::runtime_error("Different persistent & runtime environments. Persistent: `" + dp + "'. Runtime: `"+ dr + "'.Probably database created by a different compiler, build, or operating system"));
       }
 
+      auto format = _segment->find< shared_memory_format >( "format" );
+      if( !format.first || format.first->version != shared_memory_format::current_version )
+      {
+        const std::string found = format.first ? std::to_string( format.first->version ) : std::string( "none" );
+        BOOST_THROW_EXCEPTION( std::runtime_error( "Shared memory file has format version " + found + ", while version " +
+          std::to_string( shared_memory_format::current_version ) + " is required. Replay is needed to recreate it" ) );
+      }
+
       if (env.first->created_storage)
         env.first->created_storage = false;
 
       ilog( "Compiler and build environment read from persistent storage: `${storage}'", ( "storage", env.first->dump() ) );
     } else {
+      if( cow )
+        BOOST_THROW_EXCEPTION( std::runtime_error( "Copy-on-write mode requires existing shared memory file: " + abs_path.generic_string() ) );
       _size_checker( shared_file_size );
       _file_size = shared_file_size;
       _segment.reset( new bip::managed_mapped_file( bip::create_only,
                                       abs_path.generic_string().c_str(), shared_file_size
                                       ) );
       _segment->find_or_construct< environment_check >( "environment" )( allocator< environment_check >( _segment->get_segment_manager() ) );
+      _segment->construct< shared_memory_format >( "format" )();
       ilog( "Creating storage at ${abs_path}', size: ${shared_file_size}", ( "abs_path",abs_path.generic_string() )(shared_file_size) );
     }
 
+    // private mapping cannot be extended by mapping more of the file
+    if( !cow )
+      reserve_address_space( abs_path );
+
     auto env = _segment->find< environment_check >( "environment" );
     if( environment_extension )
       env.first->test_version(*environment_extension);
 
 
     _flock = bip::file_lock( abs_path.generic_string().c_str() );
-    if( !_flock.try_lock() )
+    if( cow )
+    {
+      // other copy-on-write users are fine, only the owner that writes to the file is not
+      if( !_flock.try_lock_sharable() )
+        BOOST_THROW_EXCEPTION( std::runtime_error( "could not gain read access to the shared memory file (is it used by running node?)" ) );
+    }
+    else if( !_flock.try_lock() )
       BOOST_THROW_EXCEPTION( std::runtime_error( "could not gain write access to the shared memory file" ) );
+
+    apply_segment_placement( dir, static_cast< char* >( _segment->get_address() ), _segment->get_size() );
+
+    _flushable_size = _segment->get_size();
+    if( !cow ) // nothing is ever written back to the file
+      start_background_flush();
 #endif
 
     _is_open = true;
   }
 
+  void database::set_background_flush_rate( size_t bytes_per_second )
+  {
+    stop_background_flush();
+    _background_flush_rate = bytes_per_second;
+    if( _segment && !( _open_flags & copy_on_write ) )
+      start_background_flush();
+  }
+
+  void database::start_background_flush()
+  {
+    if( _background_flush_rate == 0 || _background_flush_thread.joinable() )
+      return;
+
+    _background_flush_stop = false;
+    _background_flush_thread = std::thread( [this]() { background_flush_loop(); } );
+    ilog( "Started background flush of shared memory file, rate: ${r} bytes/s", ( "r", _background_flush_rate ) );
+  }
+
+  void database::stop_background_flush()
+  {
+    if( !_background_flush_thread.joinable() )
+      return;
+
+    {
+      std::lock_guard< std::mutex > guard( _background_flush_mutex );
+      _background_flush_stop = true;
+    }
+    _background_flush_cv.notify_one();
+    _background_flush_thread.join();
+  }
+
+  void database::background_flush_loop()
+  {
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    // around 10 chunks per second, but not more than 64MB at once, so writes are spread evenly
+    const size_t chunk_size = std::max( page_size, std::min< size_t >( _background_flush_rate / 10, 64 * 1024 * 1024 ) / page_size * page_size );
+    char* const base = static_cast< char* >( _segment->get_address() );
+    size_t offset = 0;
+
+    std::unique_lock< std::mutex > lock( _background_flush_mutex );
+    while( !_background_flush_stop )
+    {
+      const size_t size = _flushable_size.load( std::memory_order_acquire );
+      if( offset >= size )
+        offset = 0;
+      const size_t length = std::min( chunk_size, size - offset );
+
+      lock.unlock();
+      // synchronous on this thread only - MS_ASYNC does not start any writeback on Linux; clean pages are skipped by the kernel
+      if( msync( base + offset, length, MS_SYNC ) != 0 )
+        wlog( "Background flush of shared memory file failed: ${e}", ( "e", strerror( errno ) ) );
+      lock.lock();
+
+      offset += length;
+      _background_flush_cv.wait_for( lock, std::chrono::microseconds( uint64_t( length ) * 1000000 / _background_flush_rate ),
+        [this]() { return _background_flush_stop; } );
+    }
+  }
+
+  void database::reserve_address_space( const bfs::path& file )
+  {
+#ifdef __linux__
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    const size_t reservation = ( _max_file_size + page_size - 1 ) / page_size * page_size;
+
+    if( reservation <= _file_size )
+      return;
+    if( _file_size % page_size != 0 )
+    {
+      wlog( "Shared memory file size is not a multiple of page size - online growth disabled" );
+      return;
+    }
+
+    char* address = static_cast< char* >( mmap( nullptr, reservation, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 ) );
+    if( address == MAP_FAILED )
+    {
+      wlog( "Cannot reserve ${reservation} bytes of address space for shared memory file: ${e}", ( reservation )( "e", strerror( errno ) ) );
+      return;
+    }
+
+    // remap the segment at the beginning of reserved range, the rest stays reserved (inaccessible) for future growth
+    _segment.reset();
+    munmap( address, _file_size );
+
+    try
+    {
+      _segment.reset( new bip::managed_mapped_file( bip::open_only, file.generic_string().c_str(), address ) );
+    }
+    catch( const bip::interprocess_exception& e )
+    {
+      munmap( address + _file_size, reservation - _file_size );
+      wlog( "Cannot map shared memory file in reserved address space: ${e} - online growth disabled", ( "e", e.what() ) );
+      _segment.reset( new bip::managed_mapped_file( bip::open_only, file.generic_string().c_str() ) );
+      return;
+    }
+
+    // separate descriptor is kept open, since closing any descriptor of the file would release our file lock
+    _segment_fd = ::open( file.generic_string().c_str(), O_RDWR );
+    if( _segment_fd < 0 )
+    {
+      wlog( "Cannot open shared memory file for online growth: ${e}", ( "e", strerror( errno ) ) );
+      munmap( address + _file_size, reservation - _file_size );
+      return;
+    }
+
+    _reserved_address = address;
+    _reserved_size = reservation;
+    _mapped_size = _file_size;
+
+    ilog( "Reserved ${reservation} bytes of address space for shared memory file, allowing growth without remapping", ( reservation ) );
+#endif
+  }
+
+  void database::open_heap_segment( size_t size )
+  {
+    _heap_segment.reset();
+    release_address_space();
+
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    size = ( size + page_size - 1 ) / page_size * page_size;
+    const size_t reservation = std::max( ( _max_file_size + page_size - 1 ) / page_size * page_size, size );
+
+    // whole range is reserved up front, so growing the segment is just a matter of making more of it accessible
+    char* address = static_cast< char* >( mmap( nullptr, reservation, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 ) );
+    if( address == MAP_FAILED )
+      BOOST_THROW_EXCEPTION( std::runtime_error( "Unable to reserve memory for heap backed storage: " + std::string( strerror( errno ) ) ) );
+
+    _reserved_address = address;
+    _reserved_size = reservation;
+    _mapped_size = 0;
+    _file_size = 0;
+
+    if( mprotect( address, size, PROT_READ | PROT_WRITE ) != 0 )
+    {
+      const std::string error = strerror( errno );
+      release_address_space();
+      BOOST_THROW_EXCEPTION( std::runtime_error( "Unable to allocate memory for heap backed storage: " + error ) );
+    }
+    _mapped_size = size;
+    _file_size = size;
+
+    _heap_segment.reset( new heap_segment_type( bip::create_only, address, size ) );
+    _heap_segment->construct< environment_check >( "environment" )( allocator< environment_check >( get_segment_manager() ) );
+    _heap_segment->construct< shared_memory_format >( "format" )();
+    ilog( "Creating heap backed storage, size: ${size}, reserved: ${reservation}", ( size )( reservation ) );
+  }
+
+  bool database::grow_heap_segment( size_t new_size )
+  {
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    new_size = ( new_size + page_size - 1 ) / page_size * page_size;
+
+    if( new_size <= _file_size )
+      return true;
+    if( new_size > _reserved_size )
+      return false;
+
+    const size_t extra_size = new_size - _file_size;
+    char* tail = _reserved_address + _file_size;
+    if( mprotect( tail, extra_size, PROT_READ | PROT_WRITE ) != 0 )
+    {
+      wlog( "Cannot extend heap backed storage: ${e}", ( "e", strerror( errno ) ) );
+      return false;
+    }
+
+    _heap_segment->grow( extra_size );
+    _file_size = new_size;
+    _mapped_size = new_size;
+
+    apply_segment_placement( _data_dir, tail, extra_size );
+
+    ilog( "Heap backed storage grown in place to ${new_size} bytes", ( new_size ) );
+    return true;
+  }
+
+  void database::release_address_space()
+  {
+    if( _heap_backed )
+    {
+      // whole reservation belongs to heap backed segment (its manager has to be already released)
+      if( _reserved_address != nullptr )
+        munmap( _reserved_address, _reserved_size );
+
+      _reserved_address = nullptr;
+      _reserved_size = 0;
+      _mapped_size = 0;
+      return;
+    }
+
+#ifdef __linux__
+    if( _reserved_address == nullptr )
+      return;
+
+    // area mapped by the segment itself has to be already released by _segment.reset()
+    munmap( _reserved_address + _mapped_size, _reserved_size - _mapped_size );
+    ::close( _segment_fd );
+
+    _reserved_address = nullptr;
+    _reserved_size = 0;
+    _mapped_size = 0;
+    _segment_fd = -1;
+#endif
+  }
+
+  bool database::grow( size_t new_shared_file_size )
+  {
+    if( _heap_backed )
+      return grow_heap_segment( new_shared_file_size );
+
+#ifdef __linux__
+    if( _reserved_address == nullptr )
+      return false;
+
+    const size_t page_size = sysconf( _SC_PAGE_SIZE );
+    new_shared_file_size = ( new_shared_file_size + page_size - 1 ) / page_size * page_size;
+
+    if( new_shared_file_size <= _file_size )
+      return true;
+    if( new_shared_file_size > _reserved_size )
+      return false;
+
+    const size_t extra_size = new_shared_file_size - _file_size;
+
+    std::filesystem::space_info _space_info = std::filesystem::space( _data_dir.generic_string().c_str() );
+    if( extra_size > _space_info.available )
+    {
+      wlog( "Cannot grow shared memory file by ${extra_size} bytes - free space available: ${available}", ( extra_size )( "available", _space_info.available ) );
+      return false;
+    }
+
+    if( ftruncate( _segment_fd, new_shared_file_size ) != 0 )
+    {
+      wlog( "Cannot extend shared memory file: ${e}", ( "e", strerror( errno ) ) );
+      return false;
+    }
+
+    char* tail = _reserved_address + _file_size;
+    if( mmap( tail, extra_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, _segment_fd, _file_size ) == MAP_FAILED )
+    {
+      wlog( "Cannot map extended part of shared memory file: ${e}", ( "e", strerror( errno ) ) );
+      if( ftruncate( _segment_fd, _file_size ) != 0 )
+        elog( "Cannot restore shared memory file size: ${e}", ( "e", strerror( errno ) ) );
+      return false;
+    }
+
+    _segment->get_segment_manager()->grow( extra_size );
+    _file_size = new_shared_file_size;
+    _flushable_size.store( _file_size, std::memory_order_release );
+
+    apply_segment_placement( _data_dir, tail, extra_size );
+
+    ilog( "Shared memory file grown in place to ${new_shared_file_size} bytes", ( new_shared_file_size ) );
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void database::apply_segment_placement( const bfs::path& dir, char* address, size_t size )
+  {
+    if( _open_flags == 0 )
+      return;
+
+#ifdef __linux__
+
+    if( _open_flags & huge_pages )
+    {
+      if( get_hugetlbfs_page_size( dir ) != 0 )
+        ilog( "Shared memory file is located on hugetlbfs - segment is already backed by huge pages" );
+      else if( madvise( address, size, MADV_HUGEPAGE ) == 0 )
+        ilog( "Transparent huge pages requested for shared memory segment" );
+      else
+        wlog( "Cannot request transparent huge pages for shared memory segment: ${e}", ( "e", strerror( errno ) ) );
+    }
+
+    if( _open_flags & ( numa_interleave | numa_bind ) )
+    {
+      const bool bind = _open_flags & numa_bind;
+      unsigned long nodes = _numa_nodes_mask != 0 ? _numa_nodes_mask : get_all_numa_nodes();
+      // NUMA policy of file backed mapping only affects pages not yet present in page cache (f.e. whole file on tmpfs after boot)
+      if( syscall( SYS_mbind, address, size, bind ? MPOL_BIND_VALUE : MPOL_INTERLEAVE_VALUE, &nodes, sizeof( nodes ) * 8 + 1, MPOL_MF_MOVE_VALUE ) == 0 )
+        ilog( "NUMA ${p} policy set for shared memory segment, nodes mask: ${nodes}", ( "p", bind ? "bind" : "interleave" )( nodes ) );
+      else
+        wlog( "Cannot set NUMA policy for shared memory segment: ${e}", ( "e", strerror( errno ) ) );
+    }
+
+    if( _open_flags & prefault )
+      prefault_range( address, size );
+#else
+    wlog( "Shared memory placement flags are supported only on Linux - ignored" );
+#endif
+  }
+
   bool database::check_plugins(const helpers::environment_extension_resources* environment_extension)
   {
-    auto env = _segment->find< environment_check >( "environment" );
+    auto env = get_segment_manager()->find< environment_check >( "environment" );
     assert(env.first);
     return env.first->test_set_plugins(environment_extension);
   }
@@ -289,6 +735,11 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   void database::flush() {
     if( _segment )
       _segment->flush();
+#ifdef __linux__
+    // part added by grow() is not known to the segment's own mapping
+    if( _reserved_address != nullptr && _file_size > _mapped_size )
+      msync( _reserved_address + _mapped_size, _file_size - _mapped_size, MS_SYNC );
+#endif
     if( _meta )
       _meta->flush();
   }
@@ -297,7 +748,10 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   {
     if( _is_open )
     {
+      stop_background_flush();
       _segment.reset();
+      _heap_segment.reset();
+      release_address_space();
       _meta.reset();
       _data_dir = bfs::path();
 
@@ -319,7 +773,10 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   void database::wipe( const bfs::path& dir )
   {
     assert( !_is_open );
+    stop_background_flush();
     _segment.reset();
+    _heap_segment.reset();
+    release_address_space();
     _meta.reset();
     const bfs::path shared_memory_bin_path(dir / "shared_memory.bin");
     const bfs::path shared_memory_meta_path(dir / "shared_memory.meta");
@@ -331,15 +788,59 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
     wipe_indexes();
   }
 
+  void database::copy_to( database& target ) const
+  {
+    assert( _is_open && target._is_open );
+    if( _index_list.size() != target._index_list.size() )
+      BOOST_THROW_EXCEPTION( std::logic_error( "Target database has to have the same indexes as the source one" ) );
+
+#ifndef ENABLE_STD_ALLOCATOR
+    const environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
+    environment_check* const target_env = target.get_segment_manager()->find< environment_check >( "environment" ).first;
+    assert( env && target_env );
+    // strings are assigned by contents, so they stay allocated in target segment
+    target_env->version_info = env->version_info.c_str();
+    target_env->decoded_state_objects_data_json = env->decoded_state_objects_data_json.c_str();
+    target_env->blockchain_config_json = env->blockchain_config_json.c_str();
+    target_env->plugins.clear();
+    for( const auto& plugin : env->plugins )
+      target_env->plugins.insert( shared_string( plugin.c_str(), target_env->version_info.get_allocator() ) );
+    target_env->created_storage = env->created_storage;
+#endif
+
+    for( size_t i = 0; i < _index_list.size(); ++i )
+      _index_list[i]->copy_to( *target._index_list[i] );
+  }
+
+  const std::set< std::string >& database::get_internal_segment_names()
+  {
+    // "format" needs no copying - target segment gets its own current version object at open
+    static const std::set< std::string > names = { "environment", "format" };
+    return names;
+  }
+
   void database::resize( size_t new_shared_file_size )
   {
     if( _undo_session_count )
       BOOST_THROW_EXCEPTION( std::runtime_error( "Cannot resize shared memory file while undo session is active" ) );
 
+    if( _open_flags & copy_on_write )
+      BOOST_THROW_EXCEPTION( std::runtime_error( "Cannot resize shared memory file opened in copy-on-write mode" ) );
+
+    if( _heap_backed )
+    {
+      // there is no file to reopen - heap backed storage can only grow within memory reserved at open
+      if( !grow_heap_segment( new_shared_file_size ) )
+        BOOST_THROW_EXCEPTION( std::runtime_error( "Cannot resize heap backed storage beyond size reserved at open (see set_max_shared_file_size)" ) );
+      return;
+    }
+
+    stop_background_flush();
     _segment.reset();
+    release_address_space();
     _meta.reset();
 
-    open( _data_dir, 0, new_shared_file_size );
+    open( _data_dir, _open_flags, new_shared_file_size );
 
     wipe_indexes();
 
@@ -410,7 +911,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   void database::set_decoded_state_objects_data(const std::string& json)
   {
     assert(_is_open);
-    environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     assert(env);
 
     if (!env->created_storage)
@@ -422,7 +923,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   std::string database::get_decoded_state_objects_data_from_shm() const
   {
     assert(_is_open);
-    const environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    const environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     assert(env);
     return std::string(env->decoded_state_objects_data_json.c_str());
   }
@@ -431,7 +932,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   {
     /* Blockchain config can change for example via hardfork*/
     assert(_is_open);
-    environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     assert(env);
     ilog("Updating blockchain configuration stored in DB to: \n${json}", (json));
     env->blockchain_config_json = json.c_str();
@@ -440,7 +941,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   std::string database::get_blockchain_config_from_shm() const
   {
     assert(_is_open);
-    const environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    const environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     assert(env);
     return std::string(env->blockchain_config_json.c_str());
   }
@@ -448,7 +949,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   std::string database:: get_plugins_from_shm() const
   {
     assert(_is_open);
-    const environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    const environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     assert(env);
     std::vector<std::string> db_plugins;
     db_plugins.reserve(env->plugins.size());
@@ -464,7 +965,7 @@ size_t snapshot_base_serializer::worker_common_base::get_serialized_object_cache
   std::string database::get_environment_details() const
   {
     assert(_is_open);
-    const environment_check* const env = _segment->find< environment_check >( "environment" ).first;
+    const environment_check* const env = get_segment_manager()->find< environment_check >( "environment" ).first;
     return env->dump();
   }
 }  // namespace chainbase
@@ -4,6 +4,8 @@
 #include <chainbase/chainbase.hpp>
 
 #include <fc/io/raw.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/interprocess/container.hpp>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -55,6 +57,71 @@ inline void unpack(Stream& s, book& id, uint32_t depth = 0, bool limit_is_disabl
   }
 }}
 
+class ledger : public chainbase::object<1, ledger>
+{
+  CHAINBASE_OBJECT( ledger );
+
+public:
+  CHAINBASE_DEFAULT_CONSTRUCTOR( ledger )
+
+  int owner = 0;
+  int64_t balance = 0;
+  int64_t mana = 0;
+
+  CHAINBASE_UNDO_PARTIAL( ledger, (balance)(mana) );
+};
+
+typedef multi_index_container<
+  ledger,
+  indexed_by<
+    ordered_unique< tag< by_id >, const_mem_fun<ledger,ledger::id_type,&ledger::get_id> >,
+    ordered_non_unique< BOOST_MULTI_INDEX_MEMBER(ledger,int,owner) >
+  >,
+  chainbase::allocator<ledger>
+> ledger_index;
+
+CHAINBASE_SET_INDEX_TYPE( ledger, ledger_index )
+
+FC_REFLECT(ledger, (id)(owner)(balance)(mana))
+
+namespace fc {namespace raw {
+template<typename Stream>
+inline void pack(Stream& s, const ledger&)
+  {
+  }
+
+template<typename Stream>
+inline void unpack(Stream& s, ledger& id, uint32_t depth = 0, bool limit_is_disabled = false)
+  {
+  }
+}}
+
+
+class shelf : public chainbase::object<2, shelf, std::true_type>
+{
+  CHAINBASE_OBJECT( shelf );
+
+public:
+  CHAINBASE_DEFAULT_CONSTRUCTOR( shelf, (label) )
+
+  int64_t owner = 0;
+  chainbase::t_vector< char > label;
+
+  size_t get_dynamic_alloc() const { return label.capacity(); }
+};
+
+typedef multi_index_container<
+  shelf,
+  indexed_by<
+    ordered_unique< tag< by_id >, const_mem_fun<shelf,shelf::id_type,&shelf::get_id> >,
+    ordered_non_unique< BOOST_MULTI_INDEX_MEMBER(shelf,int64_t,owner) >
+  >,
+  chainbase::allocator<shelf>
+> shelf_index;
+
+CHAINBASE_SET_INDEX_TYPE( shelf, shelf_index )
+
+FC_REFLECT(shelf, (id)(owner)(label))
 
 BOOST_AUTO_TEST_CASE( open_and_create ) {
   boost::filesystem::path temp = boost::filesystem::unique_path();
@@ -153,4 +220,467 @@ BOOST_AUTO_TEST_CASE( open_and_create ) {
   }
 }
 
-// BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_CASE( grow_in_place ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    chainbase::database db;
+    db.set_max_shared_file_size( 1024*1024*64 );
+    db.open( temp, 0, 1024*1024*8 );
+    db.add_index< book_index >();
+
+    const auto& new_book = db.create<book>( []( book& b ) {
+        b.a = 3;
+        b.b = 4;
+    } );
+    const size_t free_memory = db.get_free_memory();
+
+    {
+      auto session = db.start_undo_session();
+      db.modify( new_book, [&]( book& b ) {
+        b.a = 5;
+      });
+
+      /// resize would throw here due to active undo session
+      BOOST_REQUIRE( db.grow( 1024*1024*16 ) );
+      BOOST_REQUIRE_EQUAL( db.get_max_memory(), 1024*1024*16 );
+      BOOST_REQUIRE_GT( db.get_free_memory(), free_memory );
+
+      /// objects created before growth stay in place
+      BOOST_REQUIRE_EQUAL( new_book.a, 5 );
+      BOOST_REQUIRE_EQUAL( &db.get( book::id_type(0) ), &new_book );
+    }
+    BOOST_REQUIRE_EQUAL( new_book.a, 3 );
+
+    /// cannot grow beyond reserved address space
+    BOOST_REQUIRE( !db.grow( 1024*1024*128 ) );
+
+    db.close();
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( format_version_mismatch ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    {
+      chainbase::database db;
+      db.open( temp, 0, 1024*1024*8 );
+      db.add_index< book_index >();
+      db.create<book>( []( book& b ) { b.a = 3; } );
+      db.close();
+    }
+
+    const auto file = ( temp / "shared_memory.bin" ).generic_string();
+    {
+      /// file written with different layout of chainbase structures
+      bip::managed_mapped_file segment( bip::open_only, file.c_str() );
+      auto format = segment.find< shared_memory_format >( "format" );
+      BOOST_REQUIRE( format.first != nullptr );
+      BOOST_REQUIRE_EQUAL( format.first->version, shared_memory_format::current_version );
+      ++format.first->version;
+    }
+    {
+      chainbase::database db;
+      BOOST_CHECK_THROW( db.open( temp, 0, 1024*1024*8 ), std::runtime_error );
+    }
+    {
+      /// file written before format version was stored
+      bip::managed_mapped_file segment( bip::open_only, file.c_str() );
+      BOOST_REQUIRE( segment.destroy< shared_memory_format >( "format" ) );
+    }
+    {
+      chainbase::database db;
+      BOOST_CHECK_THROW( db.open( temp, 0, 1024*1024*8 ), std::runtime_error );
+    }
+
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( heap_backed_storage ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    chainbase::database db;
+    db.set_max_shared_file_size( 1024*1024*64 );
+    db.open( temp, chainbase::heap_backed, 1024*1024*8 );
+    BOOST_REQUIRE( db.is_heap_backed() );
+    db.add_index< book_index >();
+
+    /// nothing is created on disk
+    BOOST_REQUIRE( !bfs::exists( temp / "shared_memory.bin" ) );
+
+    const auto& new_book = db.create<book>( []( book& b ) {
+        b.a = 3;
+        b.b = 4;
+    } );
+
+    {
+      auto session = db.start_undo_session();
+      db.modify( new_book, [&]( book& b ) {
+        b.a = 5;
+      });
+
+      BOOST_REQUIRE( db.grow( 1024*1024*16 ) );
+      BOOST_REQUIRE_EQUAL( db.get_max_memory(), 1024*1024*16 );
+      BOOST_REQUIRE_EQUAL( new_book.a, 5 );
+    }
+    BOOST_REQUIRE_EQUAL( new_book.a, 3 );
+
+    /// resize just grows within reserved memory, keeping the objects
+    db.resize( 1024*1024*32 );
+    BOOST_REQUIRE_EQUAL( db.get_max_memory(), 1024*1024*32 );
+    BOOST_REQUIRE_EQUAL( db.get< book >( book::id_type(0) ).a, 3 );
+    BOOST_CHECK_THROW( db.resize( 1024*1024*128 ), std::runtime_error );
+
+    db.close();
+
+    /// state is gone after close
+    db.open( temp, chainbase::heap_backed, 1024*1024*8 );
+    db.add_index< book_index >();
+    BOOST_REQUIRE( db.get_index< book_index >().indices().empty() );
+    db.close();
+
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( copy_on_write_clone ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    {
+      chainbase::database db;
+      db.open( temp, 0, 1024*1024*8 );
+      db.add_index< book_index >();
+      db.create<book>( []( book& b ) {
+          b.a = 3;
+          b.b = 4;
+      } );
+      db.close();
+    }
+    const auto file_time = bfs::last_write_time( temp / "shared_memory.bin" );
+
+    chainbase::database clone1, clone2;
+    clone1.open( temp, chainbase::copy_on_write, 1024*1024*8 );
+    clone1.add_index< book_index >();
+    /// many clones of the same state can be used at once
+    clone2.open( temp, chainbase::copy_on_write, 1024*1024*8 );
+    clone2.add_index< book_index >();
+
+    const auto& book1 = clone1.get< book >( book::id_type(0) );
+    clone1.modify( book1, []( book& b ) { b.a = 5; } );
+    clone1.create<book>( []( book& b ) { b.a = 7; } );
+    clone1.flush();
+    BOOST_REQUIRE_EQUAL( book1.a, 5 );
+    BOOST_REQUIRE_EQUAL( clone1.get_index< book_index >().indices().size(), 2 );
+
+    /// changes are private to the clone
+    BOOST_REQUIRE_EQUAL( clone2.get< book >( book::id_type(0) ).a, 3 );
+    BOOST_REQUIRE_EQUAL( clone2.get_index< book_index >().indices().size(), 1 );
+
+    BOOST_CHECK_THROW( clone1.resize( 1024*1024*16 ), std::runtime_error );
+    BOOST_REQUIRE( !clone1.grow( 1024*1024*16 ) );
+
+    clone1.close();
+    clone2.close();
+
+    /// file itself is untouched
+    BOOST_REQUIRE( bfs::last_write_time( temp / "shared_memory.bin" ) == file_time );
+    {
+      chainbase::database db;
+      db.open( temp, 0, 1024*1024*8 );
+      db.add_index< book_index >();
+      BOOST_REQUIRE_EQUAL( db.get< book >( book::id_type(0) ).a, 3 );
+      db.close();
+    }
+
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( partial_undo ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    chainbase::database db;
+    db.open( temp, 0, 1024*1024*8 );
+    db.add_index< ledger_index >();
+
+    const auto& first = db.create<ledger>( []( ledger& l ) {
+        l.owner = 1;
+        l.balance = 10;
+    } );
+    const auto& second = db.create<ledger>( []( ledger& l ) {
+        l.owner = 2;
+        l.balance = 20;
+    } );
+    const auto& idx = db.get_index< ledger_index >();
+
+    {
+      auto session = db.start_undo_session();
+      db.modify_partial( first, []( ledger::undo_partial_type& l ) {
+        l.balance = 11;
+        l.mana = 1;
+      });
+      BOOST_REQUIRE_EQUAL( first.balance, 11 );
+      BOOST_REQUIRE_EQUAL( first.mana, 1 );
+
+      /// full modification after partial one restores whole object
+      db.modify( first, []( ledger& l ) {
+        l.owner = 3;
+        l.balance = 12;
+      });
+    }
+    BOOST_REQUIRE_EQUAL( first.owner, 1 );
+    BOOST_REQUIRE_EQUAL( first.balance, 10 );
+    BOOST_REQUIRE_EQUAL( first.mana, 0 );
+
+    {
+      auto session = db.start_undo_session();
+      db.modify_partial( first, []( ledger::undo_partial_type& l ) { l.balance = 13; } );
+      db.modify_partial( second, []( ledger::undo_partial_type& l ) { l.balance = 21; } );
+
+      {
+        auto nested = db.start_undo_session();
+        db.modify( first, []( ledger& l ) { l.owner = 4; } );
+        db.modify_partial( first, []( ledger::undo_partial_type& l ) { l.balance = 14; } );
+        db.remove( second );
+        nested.squash();
+      }
+      BOOST_REQUIRE_EQUAL( first.owner, 4 );
+      BOOST_REQUIRE_EQUAL( first.balance, 14 );
+      BOOST_REQUIRE( db.find< ledger >( ledger::id_type(1) ) == nullptr );
+    }
+    const auto& restored = db.get< ledger >( ledger::id_type(1) );
+    BOOST_REQUIRE_EQUAL( first.owner, 1 );
+    BOOST_REQUIRE_EQUAL( first.balance, 10 );
+    BOOST_REQUIRE_EQUAL( restored.owner, 2 );
+    BOOST_REQUIRE_EQUAL( restored.balance, 20 );
+    BOOST_REQUIRE_EQUAL( idx.revision(), 0 );
+
+    db.close();
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( ordered_secondary_index_test ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    chainbase::database db;
+    db.open( temp, 0, 1024*1024*8 );
+    db.add_index< ledger_index >();
+
+    typedef ordered_secondary_index< ledger, BOOST_MULTI_INDEX_MEMBER(ledger,int64_t,balance), std::greater<> > by_balance_type;
+    auto by_balance = std::make_shared< by_balance_type >();
+
+    const auto& first = db.create<ledger>( []( ledger& l ) { l.owner = 1; l.balance = 10; } );
+    db.add_secondary_index< ledger_index >( by_balance );
+    const auto& second = db.create<ledger>( []( ledger& l ) { l.owner = 2; l.balance = 20; } );
+
+    auto order = [&]() {
+      std::vector< int > owners;
+      for( const auto& e : *by_balance )
+      {
+        BOOST_REQUIRE_EQUAL( e.key, e.object->balance );
+        owners.push_back( e.object->owner );
+      }
+      return owners;
+    };
+    BOOST_REQUIRE( order() == std::vector< int >( { 2, 1 } ) );
+
+    {
+      auto session = db.start_undo_session();
+      db.modify_partial( first, []( ledger::undo_partial_type& l ) { l.balance = 30; } );
+      BOOST_REQUIRE( order() == std::vector< int >( { 1, 2 } ) );
+      db.modify( second, []( ledger& l ) { l.owner = 4; } );
+      BOOST_REQUIRE( order() == std::vector< int >( { 1, 4 } ) );
+      db.remove( second );
+      db.create<ledger>( []( ledger& l ) { l.owner = 3; l.balance = 15; } );
+      BOOST_REQUIRE( order() == std::vector< int >( { 1, 3 } ) );
+      BOOST_REQUIRE_EQUAL( by_balance->lower_bound( 20 )->object->owner, 3 );
+    }
+    BOOST_REQUIRE( order() == std::vector< int >( { 2, 1 } ) );
+
+    /// secondary index is bound to index of this database only, not to other ones of the same type
+    {
+      chainbase::database other;
+      other.open( temp / "other", 0, 1024*1024*8 );
+      other.add_index< ledger_index >();
+      other.create<ledger>( []( ledger& l ) { l.owner = 5; l.balance = 50; } );
+      BOOST_REQUIRE( order() == std::vector< int >( { 2, 1 } ) );
+      other.close();
+    }
+
+    /// nor to the same index after it is reopened (until registered again)
+    db.close();
+    db.open( temp, 0, 1024*1024*8 );
+    db.add_index< ledger_index >();
+    db.create<ledger>( []( ledger& l ) { l.owner = 6; l.balance = 60; } );
+    BOOST_REQUIRE_EQUAL( by_balance->size(), 2u );
+
+    db.close();
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( copy_to_compacted_database ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::path compacted = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    chainbase::database db;
+    db.open( temp, 0, 1024*1024*8 );
+    db.add_index< shelf_index >();
+
+    /// leave holes in the segment and in ids
+    for( int64_t i = 0; i < 1000; ++i )
+      db.create<shelf>( [&]( shelf& s ) {
+        s.owner = i % 10;
+        s.label.assign( i % 50, 'a' + i % 26 );
+      } );
+    for( int64_t i = 0; i < 1000; i += 3 )
+      db.remove( db.get< shelf >( shelf::id_type( i ) ) );
+    /// new objects reuse freed memory
+    for( int64_t i = 0; i < 300; ++i )
+      db.create<shelf>( [&]( shelf& s ) {
+        s.owner = i % 10;
+        s.label.assign( i % 30, 'A' + i % 26 );
+      } );
+    db.set_revision( 42 );
+
+    chainbase::database target;
+    target.open( compacted, 0, 1024*1024*8 );
+    target.add_index< shelf_index >();
+    db.copy_to( target );
+
+    const auto& source_index = db.get_index< shelf_index >();
+    const auto& target_index = target.get_index< shelf_index >();
+    BOOST_REQUIRE_EQUAL( target_index.indices().size(), source_index.indices().size() );
+    BOOST_REQUIRE( target_index.get_next_id() == source_index.get_next_id() );
+    BOOST_REQUIRE_EQUAL( target.revision(), 42 );
+    BOOST_REQUIRE_EQUAL( target_index.get_item_additional_allocation(), source_index.get_item_additional_allocation() );
+    for( const auto& s : source_index.indices() )
+    {
+      const auto& copy = target.get< shelf >( s.get_id() );
+      BOOST_REQUIRE_EQUAL( copy.owner, s.owner );
+      BOOST_REQUIRE( std::equal( copy.label.begin(), copy.label.end(), s.label.begin(), s.label.end() ) );
+    }
+    /// nodes of compacted index fill blocks of 256 without gaps (handed out from the end of each block), so
+    /// address only jumps when next block is started
+    const auto is_packed = []( const chainbase::generic_index< shelf_index >::index_type& index ) {
+      const char* previous = nullptr;
+      std::ptrdiff_t stride = 0;
+      size_t jumps = 0;
+      for( const auto& s : index )
+      {
+        const char* current = reinterpret_cast< const char* >( &s );
+        if( previous != nullptr )
+        {
+          if( stride == 0 )
+            stride = previous - current;
+          if( previous - current != stride )
+            ++jumps;
+        }
+        previous = current;
+      }
+      return stride >= std::ptrdiff_t( sizeof( shelf ) ) && jumps <= index.size() / 256 + 1;
+    };
+    BOOST_REQUIRE( !is_packed( source_index.indices() ) );
+    BOOST_REQUIRE( is_packed( target_index.indices() ) );
+    /// compacted segment holds only live objects, without memory freed in source
+    BOOST_REQUIRE_LT( target.get_max_memory() - target.get_free_memory(), db.get_max_memory() - db.get_free_memory() );
+
+    /// undo state is not copied, so it must not exist
+    chainbase::database target2;
+    target2.open( compacted / "2", 0, 1024*1024*8 );
+    target2.add_index< shelf_index >();
+    {
+      auto session = db.start_undo_session();
+      BOOST_CHECK_THROW( db.copy_to( target2 ), std::logic_error );
+    }
+    /// and target has to be empty
+    BOOST_CHECK_THROW( db.copy_to( target ), std::logic_error );
+
+    target2.close();
+    target.close();
+    db.close();
+    bfs::remove_all( temp );
+    bfs::remove_all( compacted );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    bfs::remove_all( compacted );
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( pooled_nodes_survive_reopen ) {
+  boost::filesystem::path temp = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  try {
+    {
+      chainbase::database db;
+      db.open( temp, 0, 1024*1024*8 );
+      db.add_index< book_index >();
+      for( int i = 0; i < 1000; ++i )
+        db.create<book>( [&]( book& b ) { b.a = i; b.b = -i; } );
+      db.close();
+    }
+
+    chainbase::database db;
+    db.open( temp );
+    db.add_index< book_index >();
+    BOOST_REQUIRE_EQUAL( db.get_index< book_index >().indices().size(), 1000u );
+
+    /// node of removed object goes back to the pool (kept in the segment) and is reused by next object
+    const book* removed = &db.get( book::id_type( 500 ) );
+    db.remove( *removed );
+    const auto& new_book = db.create<book>( []( book& b ) { b.a = 1000; b.b = -1000; } );
+    BOOST_REQUIRE_EQUAL( &new_book, removed );
+
+    {
+      auto session = db.start_undo_session();
+      for( int i = 0; i < 1000; i += 2 )
+        if( i != 500 )
+          db.remove( db.get( book::id_type( i ) ) );
+      for( int i = 0; i < 100; ++i )
+        db.create<book>( [&]( book& b ) { b.a = 2000 + i; b.b = 0; } );
+      db.modify( db.get( book::id_type( 1 ) ), []( book& b ) { b.b = 7; } );
+      session.undo();
+    }
+
+    BOOST_REQUIRE_EQUAL( db.get_index< book_index >().indices().size(), 1000u );
+    for( int i = 0; i < 1000; ++i )
+    {
+      const auto* b = db.find( book::id_type( i ) );
+      BOOST_REQUIRE_EQUAL( b != nullptr, i != 500 );
+      if( b != nullptr )
+      {
+        BOOST_REQUIRE_EQUAL( b->a, i );
+        BOOST_REQUIRE_EQUAL( b->b, -i );
+      }
+    }
+    BOOST_REQUIRE_EQUAL( db.get( book::id_type( 1000 ) ).a, 1000 );
+
+    db.close();
+    bfs::remove_all( temp );
+  } catch ( ... ) {
+    bfs::remove_all( temp );
+    throw;
+  }
+}
+
+// BOOST_AUTO_TEST_SUITE_END()
@@ -2,12 +2,16 @@
 #include <fc/variant.hpp>
 #include <fc/filesystem.hpp>
 
+#include <functional>
+#include <string_view>
+
 #define JSON_MAX_RECURSION_DEPTH (200)
 
 namespace fc
 {
   class ostream;
   class buffered_istream;
+  class json_value_reader;
 
   /**
    *  Provides interface for json serialization.
@@ -51,8 +55,19 @@ namespace fc
 
     static variant from_string(const string &utf8_str, const format_validation_mode json_validation_mode, parse_type ptype = legacy_parser, uint32_t depth = 0);
     static variant fast_from_string(const string &utf8_str);
+    /**
+     *  Parses @p utf8_str with the simdjson on-demand parser and hands the root value to @p reader_callback
+     *  without building a variant tree (see fc/io/json_reader.hpp and fc/io/json_decode.hpp). The input is copied into a per-thread
+     *  padded buffer, so nothing is allocated once the buffers have grown. Calls may be nested inside
+     *  the callback, e.g. to parse a fragment obtained with json_value_reader::get_raw_json().
+     */
+    static void read(std::string_view utf8_str, const std::function<void(json_value_reader &)> &reader_callback);
     static variants variants_from_string(const string &utf8_str, parse_type ptype = legacy_parser, uint32_t depth = 0);
     static string to_string(const variant &v, output_formatting format = stringify_large_ints_and_doubles);
+    /// appends the same text to_string() would return to @p out (see fc/io/json_encode.hpp)
+    static void append(string &out, const variant &v, output_formatting format = stringify_large_ints_and_doubles);
+    /// appends @p str as quoted and escaped json string
+    static void append_string(string &out, const string &str);
     static string to_pretty_string(const variant &v, output_formatting format = stringify_large_ints_and_doubles);
 
     static bool is_valid(const std::string &json_str, const format_validation_mode json_validation_mode, parse_type ptype = legacy_parser, uint32_t depth = 0);
@@ -0,0 +1,194 @@
+#pragma once
+#include <fc/io/json_reader.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <type_traits>
+#include <vector>
+
+namespace fc
+{
+  /**
+   *  Reflected structs marked with FC_JSON_DIRECT_DECODE are filled member by member straight
+   *  from json_value_reader, skipping the intermediate variant tree. Only mark types that use
+   *  the default reflected from_variant - members are still free to have custom conversions,
+   *  they just go through a (much smaller) variant of their own.
+   */
+  template <typename T>
+  struct json_direct_decode : std::false_type
+  {
+  };
+
+  template <typename T>
+  void json_decode(json_value_reader &reader, T &value, uint32_t depth = 0);
+
+  namespace detail
+  {
+    template <typename T>
+    struct is_json_direct_vector : std::false_type
+    {
+    };
+
+    // std::vector<char> has its own hex conversion and std::vector<bool> has no addressable elements
+    template <typename T, typename A>
+    struct is_json_direct_vector<std::vector<T, A>>
+      : std::bool_constant<!std::is_same_v<T, bool> && !std::is_same_v<T, char> &&
+                           !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>>
+    {
+    };
+
+    template <typename T>
+    struct is_json_direct_optional : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_direct_optional<fc::optional<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    class json_decode_visitor
+    {
+    public:
+      json_decode_visitor(std::string_view key, json_value_reader &reader, T &value, uint64_t &decoded, bool &matched, uint32_t depth)
+        : _key(key), _reader(reader), _value(value), _decoded(decoded), _matched(matched), _depth(depth) {}
+
+      template <typename Member, class Class, Member(Class::*member)>
+      void operator()(const char *name) const
+      {
+        const uint32_t index = _index++;
+        if (_matched || _key != name)
+          return;
+
+        _matched = true;
+        // from_variant looks members up with variant_object::find, so the first duplicate key wins
+        const uint64_t bit = index < 64 ? uint64_t(1) << index : 0;
+        if (_decoded & bit)
+        {
+          _reader.to_variant();
+          return;
+        }
+        _decoded |= bit;
+        json_decode(_reader, _value.*member, _depth);
+      }
+
+    private:
+      std::string_view _key;
+      json_value_reader &_reader;
+      T &_value;
+      uint64_t &_decoded;
+      bool &_matched;
+      uint32_t _depth;
+      mutable uint32_t _index = 0;
+    };
+  } // namespace detail
+
+  /**
+   *  Fills @p value from @p reader. Anything not handled directly (a kind that differs from what
+   *  the target type expects, types without direct support) falls back to from_variant, so
+   *  the result always matches what from_variant( reader.to_variant(), value ) would give.
+   */
+  template <typename T>
+  void json_decode(json_value_reader &reader, T &value, uint32_t depth)
+  {
+    FC_ASSERT(depth <= JSON_MAX_RECURSION_DEPTH);
+    depth++;
+
+    const auto kind = reader.kind();
+    if constexpr (std::is_same_v<T, bool>)
+    {
+      if (kind == json_value_reader::bool_kind)
+      {
+        value = reader.get_bool();
+        return;
+      }
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+      // same truncating conversions as variant::as_int64 / as_uint64
+      if (kind == json_value_reader::int64_kind)
+      {
+        const int64_t v = reader.get_int64();
+        value = std::is_signed_v<T> ? static_cast<T>(v) : static_cast<T>(static_cast<uint64_t>(v));
+        return;
+      }
+      if (kind == json_value_reader::uint64_kind)
+      {
+        const uint64_t v = reader.get_uint64();
+        value = std::is_signed_v<T> ? static_cast<T>(static_cast<int64_t>(v)) : static_cast<T>(v);
+        return;
+      }
+    }
+    else if constexpr (std::is_same_v<T, double>)
+    {
+      if (kind == json_value_reader::double_kind)
+      {
+        value = reader.get_double();
+        return;
+      }
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+      if (kind == json_value_reader::string_kind)
+      {
+        value.assign(reader.get_string());
+        return;
+      }
+    }
+    else if constexpr (detail::is_json_direct_vector<T>::value)
+    {
+      if (kind == json_value_reader::array_kind)
+      {
+        value.clear();
+        reader.for_each_element([&](json_value_reader &element)
+                                {
+                                  value.emplace_back();
+                                  json_decode(element, value.back(), depth); });
+        return;
+      }
+    }
+    else if constexpr (detail::is_json_direct_optional<T>::value)
+    {
+      if (kind == json_value_reader::null_kind)
+      {
+        reader.to_variant();
+        value = T();
+      }
+      else
+      {
+        value = typename T::value_type();
+        json_decode(reader, *value, depth);
+      }
+      return;
+    }
+    else if constexpr (json_direct_decode<T>::value)
+    {
+      if (kind == json_value_reader::object_kind)
+      {
+        uint64_t decoded = 0;
+        reader.for_each_field([&](std::string_view key, json_value_reader &field)
+                              {
+                                bool matched = false;
+                                fc::reflector<T>::visit(detail::json_decode_visitor<T>(key, field, value, decoded, matched, depth));
+                                if (!matched)
+                                  field.to_variant(); // unknown members are ignored, but still have to be valid json
+                              });
+        return;
+      }
+    }
+
+    from_variant(reader.to_variant(), value);
+  }
+
+} // fc
+
+#define FC_JSON_DIRECT_DECODE(TYPE)                    \
+  namespace fc                                         \
+  {                                                    \
+    template <>                                        \
+    struct json_direct_decode<TYPE> : std::true_type   \
+    {                                                  \
+    };                                                 \
+  }
@@ -0,0 +1,318 @@
+#pragma once
+#include <fc/io/json.hpp>
+#include <fc/optional.hpp>
+#include <fc/safe.hpp>
+#include <fc/time.hpp>
+#include <fc/crypto/hex.hpp>
+#include <fc/crypto/ripemd160.hpp>
+#include <fc/container/flat_fwd.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/exception/exception.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+namespace fc
+{
+  /**
+   *  Output format that renders everything the same way json::to_string( variant( value ) ) does.
+   *  Other formats (e.g. hive::protocol::legacy_json_format) are just tags that json_encoder is
+   *  specialized on for the types they render differently.
+   */
+  struct json_default_format
+  {
+  };
+
+  /**
+   *  Reflected structs marked with FC_JSON_DIRECT_ENCODE are written member by member straight
+   *  into the output, skipping the intermediate variant tree. Only mark types that use the
+   *  default reflected to_variant - members are still free to have custom conversions, they
+   *  just go through a (much smaller) variant of their own.
+   */
+  template <typename T>
+  struct json_direct_encode : std::false_type
+  {
+  };
+
+  template <typename Format, typename T>
+  void json_encode(std::string &out, const T &value, uint32_t depth = 0);
+
+  namespace detail
+  {
+    template <typename T>
+    struct is_json_char : std::bool_constant<std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                                             std::is_same_v<T, unsigned char>>
+    {
+    };
+
+    /// rendered as array of elements; std::vector<char> has its own hex conversion
+    template <typename T>
+    struct is_json_encoded_sequence : std::false_type
+    {
+    };
+
+    template <typename T, typename A>
+    struct is_json_encoded_sequence<std::vector<T, A>>
+      : std::bool_constant<!std::is_same_v<T, bool> && !is_json_char<T>::value>
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_sequence<std::deque<T>> : std::true_type
+    {
+    };
+
+    template <typename... T>
+    struct is_json_encoded_sequence<std::set<T...>> : std::true_type
+    {
+    };
+
+    template <typename... T>
+    struct is_json_encoded_sequence<std::multiset<T...>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_sequence<fc::flat_set<T>> : std::true_type
+    {
+    };
+
+    /// rendered as array of [ key, value ] pairs
+    template <typename T>
+    struct is_json_encoded_pair_sequence : std::false_type
+    {
+    };
+
+    template <typename K, typename... T>
+    struct is_json_encoded_pair_sequence<fc::flat_map<K, T...>> : std::true_type
+    {
+    };
+
+    template <typename K, typename T>
+    struct is_json_encoded_pair_sequence<std::map<K, T>> : std::bool_constant<!std::is_same_v<K, std::string>>
+    {
+    };
+
+    template <typename K, typename T>
+    struct is_json_encoded_pair_sequence<std::multimap<K, T>> : std::true_type
+    {
+    };
+
+    /// rendered as object
+    template <typename T>
+    struct is_json_encoded_string_map : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_string_map<std::map<std::string, T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_optional : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_optional<fc::optional<T>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    struct is_json_encoded_pair : std::false_type
+    {
+    };
+
+    template <typename A, typename B>
+    struct is_json_encoded_pair<std::pair<A, B>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    void json_encode_integer(std::string &out, T value)
+    {
+      // same as json::to_string with stringify_large_ints_and_doubles
+      bool quoted = false;
+      if constexpr (std::is_signed_v<T>)
+        quoted = int64_t(value) > json::max_positive_value || int64_t(value) < json::max_negative_value;
+      else
+        quoted = uint64_t(value) > uint64_t(json::max_positive_value);
+
+      if (quoted)
+        out += '"';
+      if constexpr (std::is_signed_v<T>)
+        out += std::to_string(int64_t(value));
+      else
+        out += std::to_string(uint64_t(value));
+      if (quoted)
+        out += '"';
+    }
+
+    template <typename Format, typename Sequence>
+    void json_encode_sequence(std::string &out, const Sequence &values, uint32_t depth)
+    {
+      out += '[';
+      bool first = true;
+      for (const auto &v : values)
+      {
+        if (!first)
+          out += ',';
+        first = false;
+        json_encode<Format>(out, v, depth);
+      }
+      out += ']';
+    }
+
+    template <typename Format, typename T>
+    class json_encode_visitor
+    {
+    public:
+      json_encode_visitor(std::string &out, const T &value, uint32_t depth)
+        : _out(out), _value(value), _depth(depth) {}
+
+      template <typename Member, class Class, Member(Class::*member)>
+      void operator()(const char *name) const
+      {
+        // to_variant_visitor leaves out optional members that are not set
+        if constexpr (is_json_encoded_optional<Member>::value)
+        {
+          if (!(_value.*member).valid())
+            return;
+        }
+
+        if (!_first)
+          _out += ',';
+        _first = false;
+        _out += '"';
+        _out += name;
+        _out += "\":";
+        json_encode<Format>(_out, _value.*member, _depth);
+      }
+
+    private:
+      std::string &_out;
+      const T &_value;
+      uint32_t _depth;
+      mutable bool _first = true;
+    };
+  } // namespace detail
+
+  /**
+   *  Renders reflected struct as json object, whether it is marked with FC_JSON_DIRECT_ENCODE or not.
+   *  Meant for specializations of json_encoder that know the type has no custom to_variant.
+   */
+  template <typename Format, typename T>
+  void json_encode_object(std::string &out, const T &value, uint32_t depth)
+  {
+    out += '{';
+    fc::reflector<T>::visit(detail::json_encode_visitor<Format, T>(out, value, depth));
+    out += '}';
+  }
+
+  /**
+   *  Writes @p value as json in given output format. Anything without direct support falls back
+   *  to to_variant, so the text always matches what json::to_string( variant( value ) ) gives
+   *  (in case of json_default_format). Formats specialize this template for their own types.
+   */
+  template <typename Format, typename T, typename Enable = void>
+  struct json_encoder
+  {
+    static void encode(std::string &out, const T &value, uint32_t depth)
+    {
+      if constexpr (std::is_same_v<T, bool>)
+      {
+        out += value ? "true" : "false";
+      }
+      else if constexpr (std::is_integral_v<T> && !detail::is_json_char<T>::value && sizeof(T) <= sizeof(uint64_t))
+      {
+        detail::json_encode_integer(out, value);
+      }
+      else if constexpr (std::is_same_v<T, std::string>)
+      {
+        json::append_string(out, value);
+      }
+      else if constexpr (std::is_same_v<T, fc::time_point_sec>)
+      {
+        json::append_string(out, value.to_iso_string());
+      }
+      else if constexpr (std::is_same_v<T, fc::ripemd160>)
+      {
+        out += '"';
+        out += value.str();
+        out += '"';
+      }
+      else if constexpr (detail::is_json_encoded_optional<T>::value)
+      {
+        if (value.valid())
+          json_encode<Format>(out, *value, depth);
+        else
+          out += "null";
+      }
+      else if constexpr (detail::is_json_encoded_pair<T>::value)
+      {
+        out += '[';
+        json_encode<Format>(out, value.first, depth);
+        out += ',';
+        json_encode<Format>(out, value.second, depth);
+        out += ']';
+      }
+      else if constexpr (detail::is_json_encoded_sequence<T>::value || detail::is_json_encoded_pair_sequence<T>::value)
+      {
+        detail::json_encode_sequence<Format>(out, value, depth);
+      }
+      else if constexpr (detail::is_json_encoded_string_map<T>::value)
+      {
+        out += '{';
+        bool first = true;
+        for (const auto &item : value)
+        {
+          if (!first)
+            out += ',';
+          first = false;
+          json::append_string(out, item.first);
+          out += ':';
+          json_encode<Format>(out, item.second, depth);
+        }
+        out += '}';
+      }
+      else if constexpr (json_direct_encode<T>::value)
+      {
+        json_encode_object<Format>(out, value, depth);
+      }
+      else
+      {
+        json::append(out, variant(value));
+      }
+    }
+  };
+
+  template <typename Format, typename T>
+  struct json_encoder<Format, fc::safe<T>>
+  {
+    static void encode(std::string &out, const fc::safe<T> &value, uint32_t depth)
+    {
+      json_encode<Format>(out, value.value, depth);
+    }
+  };
+
+  template <typename Format, typename T>
+  void json_encode(std::string &out, const T &value, uint32_t depth)
+  {
+    FC_ASSERT(depth <= JSON_MAX_RECURSION_DEPTH);
+    json_encoder<Format, T>::encode(out, value, depth + 1);
+  }
+
+} // fc
+
+#define FC_JSON_DIRECT_ENCODE(TYPE)                    \
+  namespace fc                                         \
+  {                                                    \
+    template <>                                        \
+    struct json_direct_encode<TYPE> : std::true_type   \
+    {                                                  \
+    };                                                 \
+  }
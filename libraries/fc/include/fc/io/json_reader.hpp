@@ -0,0 +1,54 @@
+#pragma once
+#include <fc/io/json.hpp>
+
+#include <functional>
+#include <string_view>
+
+namespace fc
+{
+  /**
+   *  Forward only view of a single value of a document parsed by json::read.
+   *
+   *  Each value can be consumed only once - through one of the getters, by iterating it
+   *  or by converting it with to_variant(). Strings and keys handed out point into parser
+   *  owned storage and stay valid until json::read returns.
+   */
+  class json_value_reader
+  {
+  public:
+    enum kind_type
+    {
+      null_kind,
+      bool_kind,
+      int64_kind,
+      uint64_kind,
+      double_kind,
+      string_kind,
+      array_kind,
+      object_kind
+    };
+
+    using element_callback = std::function<void(json_value_reader &)>;
+    using field_callback = std::function<void(std::string_view, json_value_reader &)>;
+
+    virtual ~json_value_reader() {}
+
+    virtual kind_type kind() = 0;
+
+    virtual bool get_bool() = 0;
+    virtual int64_t get_int64() = 0;
+    virtual uint64_t get_uint64() = 0;
+    virtual double get_double() = 0;
+    /// unescaped content of a string value
+    virtual std::string_view get_string() = 0;
+    /// text of an array or object exactly as it appears in the input
+    virtual std::string_view get_raw_json() = 0;
+
+    virtual void for_each_element(const element_callback &cb) = 0;
+    virtual void for_each_field(const field_callback &cb) = 0;
+
+    /// builds the same variant tree fc::json::fast_from_string would produce for this value
+    virtual variant to_variant() = 0;
+  };
+
+} // fc
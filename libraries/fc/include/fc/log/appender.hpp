@@ -49,6 +49,8 @@ namespace fc {
          static std::string format_time_as_string(time_point time, time_format format);
 
          virtual void log( const log_message& m ) = 0;
+         /// called by async_log_queue after each batch of messages (appenders don't flush per message then)
+         virtual void flush() {}
    };
 }
 FC_REFLECT_ENUM( fc::appender::time_format, 
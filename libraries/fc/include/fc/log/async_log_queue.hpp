@@ -0,0 +1,39 @@
+#pragma once
+#include <fc/log/appender.hpp>
+#include <fc/log/log_message.hpp>
+
+#include <cstdint>
+
+namespace fc {
+
+   /**
+    *  Hands log messages over to appenders on a dedicated logging thread, so threads that log (f.e. the one
+    *  applying blocks) neither format messages nor wait for i/o - arguments are already captured in the message.
+    *
+    *  Messages go through bounded lock-free multi-producer single-consumer ring buffer. When it is full new
+    *  messages are dropped and counted instead of blocking the caller (number of dropped messages is reported
+    *  to appenders of default logger). Logging thread processes messages in batches and flushes each appender
+    *  once per batch instead of once per message.
+    *
+    *  Until start() is called (and after stop()) logger::log() calls appenders synchronously.
+    */
+   class async_log_queue
+   {
+      public:
+         /// @param capacity maximum number of messages waiting for logging thread (rounded up to power of 2)
+         static void start( uint32_t capacity );
+         /// writes out all queued messages, stops logging thread and switches back to synchronous logging
+         static void stop();
+         static bool is_enabled();
+
+         /**
+          *  Returns false when asynchronous logging was stopped in the meantime - caller has to log the message
+          *  synchronously (messages queued before are already written out then). Message that does not fit into
+          *  full queue is dropped (see get_dropped_count()), but still counts as handled.
+          */
+         static bool push( const appender::ptr& a, const log_message& m );
+         /// number of messages dropped so far because queue was full
+         static uint64_t get_dropped_count();
+   };
+
+} // namespace fc
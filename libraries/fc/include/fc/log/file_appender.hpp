@@ -25,6 +25,7 @@ class file_appender : public appender {
          file_appender( const variant& args );
          ~file_appender();
          virtual void log( const log_message& m )override;
+         virtual void flush()override;
 
       private:
          class impl;
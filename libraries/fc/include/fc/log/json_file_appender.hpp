@@ -24,6 +24,7 @@ class json_file_appender : public appender {
          json_file_appender( const variant& args );
          ~json_file_appender();
          virtual void log( const log_message& m )override;
+         virtual void flush()override;
 
       private:
          class impl;
@@ -10,8 +10,13 @@
  *
  **/
 #pragma once
+#include <algorithm>
+#include <limits>
 #include <memory>
+#include <new>
 #include <stdexcept>
+#include <tuple>
+#include <type_traits>
 #include <typeinfo>
 #include <fc/exception/exception.hpp>
 #include <fc/uint128.hpp>
@@ -38,10 +43,21 @@ struct variant_creator_functor
   }
 };
 
+/**
+ * Alternatives bigger than inline_capacity are not kept inside static_variant, but allocated separately, with storage
+ * holding just a pointer. By default everything is inline, which is required for variants placed in shared memory.
+ * Variants with big but rarely used alternatives (like operation) can specialize it to reduce their footprint.
+ */
+template< typename static_variant >
+struct static_variant_storage_traits
+{
+  static constexpr size_t inline_capacity = std::numeric_limits< size_t >::max();
+};
+
 // Implementation details, the user should not import this:
 namespace impl {
 
-template<int64_t N, typename... Ts>
+template<size_t InlineCapacity, typename... Ts>
 struct storage_ops;
 
 template<typename X, typename... Ts>
@@ -63,107 +79,122 @@ struct copy_construct
    }
 };
 
-template<typename StaticVariant>
-struct move_construct
-{
-   typedef void result_type;
-   StaticVariant& sv;
-   move_construct( StaticVariant& s ):sv(s){}
-   template<typename T>
-   void operator()( T& v )const
-   {
-      sv.init( std::move(v) );
-   }
-};
-
-template<int64_t N, typename T, typename... Ts>
-struct storage_ops<N, T&, Ts...> {
-    static void del(int64_t n, void *data) {}
-    static void con(int64_t n, void *data) {}
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, visitor& v) {}
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, const visitor& v) {}
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, visitor& v) {}
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, const visitor& v) {}
-};
-
-template<int64_t N, typename T, typename... Ts>
-struct storage_ops<N, T, Ts...> {
-    static void del(int64_t n, void *data) {
-        if(n == N) 
-        {
-            auto ptr = std::launder(reinterpret_cast<T*>(data));
-            std::destroy_at(ptr);
-        }
+#define FC_STATIC_VARIANT_CASE( i ) \
+   case i: \
+      if constexpr( Base + i < sizeof...(Ts) ) \
+         return f( std::integral_constant< size_t, Base + i >() ); \
+      else \
+         break;
+
+#define FC_STATIC_VARIANT_CASES_8( i ) \
+   FC_STATIC_VARIANT_CASE( i + 0 ) FC_STATIC_VARIANT_CASE( i + 1 ) FC_STATIC_VARIANT_CASE( i + 2 ) \
+   FC_STATIC_VARIANT_CASE( i + 3 ) FC_STATIC_VARIANT_CASE( i + 4 ) FC_STATIC_VARIANT_CASE( i + 5 ) \
+   FC_STATIC_VARIANT_CASE( i + 6 ) FC_STATIC_VARIANT_CASE( i + 7 )
+
+/**
+ * Operations on storage of static_variant holding alternative with given tag. Tag is dispatched with switch over
+ * consecutive blocks of alternatives, which compilers turn into jump tables (static_variant of operations has close
+ * to a hundred alternatives, so it only takes few of them), while calls to visitor can still be inlined.
+ * Alternatives bigger than InlineCapacity are boxed - storage holds owning pointer to them.
+ */
+template<size_t InlineCapacity, typename... Ts>
+struct storage_ops {
+    static constexpr size_t block_size = 32;
+
+    template<typename T>
+    static constexpr bool is_boxed = sizeof(T) > InlineCapacity;
+
+    /// Size and alignment of storage needed to hold any alternative (or pointer to it, when boxed)
+    static constexpr size_t size = std::max({ size_t(0), ( is_boxed<Ts> ? sizeof(void*) : sizeof(Ts) )... });
+    static constexpr size_t alignment = std::max({ size_t(1), ( is_boxed<Ts> ? alignof(void*) : alignof(Ts) )... });
+
+    template<typename T, typename... Args>
+    static void construct(void *data, Args&&... args) {
+        if constexpr( is_boxed<T> )
+            new(data) T*( new T( std::forward<Args>(args)... ) );
         else
-        {
-            storage_ops<N + 1, Ts...>::del(n, data);
-        }
-    }
-    static void con(int64_t n, void *data) {
-        if(n == N) new(data) T();
-        else storage_ops<N + 1, Ts...>::con(n, data);
-    }
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, visitor& v) {
-        if(n == N) return v(*reinterpret_cast<T*>(data));
-        else return storage_ops<N + 1, Ts...>::apply(n, data, v);
-    }
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, const visitor& v) {
-        if(n == N) return v(*reinterpret_cast<T*>(data));
-        else return storage_ops<N + 1, Ts...>::apply(n, data, v);
+            new(data) T( std::forward<Args>(args)... );
     }
 
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, visitor& v) {
-        if(n == N) return v(*reinterpret_cast<const T*>(data));
-        else return storage_ops<N + 1, Ts...>::apply(n, data, v);
+    template<typename T>
+    static T& get(void *data) {
+        if constexpr( is_boxed<T> )
+            return **std::launder(reinterpret_cast<T**>(data));
+        else
+            return *std::launder(reinterpret_cast<T*>(data));
     }
-
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, const visitor& v) {
-        if(n == N) return v(*reinterpret_cast<const T*>(data));
-        else return storage_ops<N + 1, Ts...>::apply(n, data, v);
+    template<typename T>
+    static const T& get(const void *data) {
+        return get<T>(const_cast<void*>(data));
     }
-};
 
-template<int64_t N>
-struct storage_ops<N> {
     static void del(int64_t n, void *data) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid.");
+        dispatch<0>(n, [data](auto i) {
+            typedef type_at<decltype(i)::value> T;
+            if constexpr( is_boxed<T> )
+                delete *std::launder(reinterpret_cast<T**>(data));
+            else
+                std::destroy_at(std::launder(reinterpret_cast<T*>(data)));
+        });
+    }
+    /// Boxed alternative is moved by taking over its pointer; source is left boxed-empty (it can only be destroyed
+    /// or assigned to then)
+    static void move(int64_t n, void *dst, void *src) {
+        dispatch<0>(n, [dst, src](auto i) {
+            typedef type_at<decltype(i)::value> T;
+            if constexpr( is_boxed<T> )
+            {
+                T** from = std::launder(reinterpret_cast<T**>(src));
+                new(dst) T*( *from );
+                *from = nullptr;
+            }
+            else
+                new(dst) T( std::move( *std::launder(reinterpret_cast<T*>(src)) ) );
+        });
     }
     static void con(int64_t n, void *data) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
+        dispatch<0>(n, [data](auto i) {
+            construct<type_at<decltype(i)::value>>(data);
+        });
     }
 
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, visitor& v) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
-    }
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, void *data, const visitor& v) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
-    }
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, visitor& v) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
+    /// Data is char or const char, visitor can be const
+    template<typename Data, typename visitor>
+    static typename std::remove_const_t<visitor>::result_type apply(int64_t n, Data *data, visitor& v) {
+        typedef typename std::remove_const_t<visitor>::result_type result_type;
+        return dispatch<0>(n, [data, &v](auto i) -> result_type {
+            return v(get<type_at<decltype(i)::value>>(data));
+        });
     }
-    template<typename visitor>
-    static typename visitor::result_type apply(int64_t n, const void *data, const visitor& v) {
-       FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
+
+private:
+    template<size_t I>
+    using type_at = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    /// Calls f with std::integral_constant holding n (n has to be in [Base, sizeof...(Ts)) range)
+    template<size_t Base, typename F>
+    static decltype(auto) dispatch(int64_t n, F&& f) {
+        switch( n - static_cast< int64_t >( Base ) )
+        {
+           FC_STATIC_VARIANT_CASES_8( 0 )
+           FC_STATIC_VARIANT_CASES_8( 8 )
+           FC_STATIC_VARIANT_CASES_8( 16 )
+           FC_STATIC_VARIANT_CASES_8( 24 )
+           default:
+              break;
+        }
+        if constexpr( Base + block_size < sizeof...(Ts) )
+        {
+           if( n >= static_cast< int64_t >( Base + block_size ) )
+              return dispatch<Base + block_size>(n, std::forward<F>(f));
+        }
+        FC_THROW_EXCEPTION( fc::assert_exception, "Internal error: static_variant tag is invalid." );
     }
 };
 
+#undef FC_STATIC_VARIANT_CASES_8
+#undef FC_STATIC_VARIANT_CASE
+
 template<typename X>
 struct position<X> {
     static const int64_t pos = -1;
@@ -226,25 +257,25 @@ class static_variant {
     static_assert(impl::type_info<Types...>::no_reference_types, "Reference types are not permitted in static_variant.");
     static_assert(impl::type_info<Types...>::no_duplicates, "static_variant type arguments contain duplicate types.");
 
-    int64_t                 _tag;
-    alignas(Types...) char  storage[impl::type_info<Types...>::size];  // to be sure address of 'storage' is properly aligned
+    typedef impl::storage_ops<static_variant_storage_traits<static_variant>::inline_capacity, Types...> storage_ops;
+
+    int64_t                              _tag;
+    alignas(storage_ops::alignment) char storage[storage_ops::size];  // to be sure address of 'storage' is properly aligned
       
     template<typename X>
     void init(const X& x) {
         _tag = impl::position<X, Types...>::pos;
-        new(storage) X(x);
+        storage_ops::template construct<X>(storage, x);
     }
 
     template<typename X>
     void init(X&& x) {
         _tag = impl::position<X, Types...>::pos;
-        new(storage) X( std::move(x) );
+        storage_ops::template construct<X>(storage, std::move(x));
     }
 
     template<typename StaticVariant>
     friend struct impl::copy_construct;
-    template<typename StaticVariant>
-    friend struct impl::move_construct;
 
 public:
     std::string get_stored_type_name( bool strip_namespace = false ) const
@@ -276,14 +307,14 @@ public:
     static_variant(int64_t t = 0)
       : _tag( t )
     {
-       impl::storage_ops<0, Types...>::con(_tag, storage);
+       storage_ops::con(_tag, storage);
     }
 
     template<typename visitor>
     static_variant(int64_t t, visitor& v)
       : _tag(t)
     {
-      impl::storage_ops<0, Types...>::con(_tag, storage);
+      storage_ops::con(_tag, storage);
       visit(v);
     }
 
@@ -302,7 +333,7 @@ public:
     static_variant( static_variant&& mv ) :
       _tag(mv._tag)
     {
-       mv.visit( impl::move_construct<static_variant>(*this) );
+       storage_ops::move(_tag, storage, mv.storage);
     }
 
     template<typename X>
@@ -340,7 +371,7 @@ public:
        if( this == &v ) return *this;
        clear_storage();
        _tag = v._tag;
-       v.visit( impl::move_construct<static_variant>(*this) );
+       storage_ops::move(_tag, storage, v.storage);
        return *this;
     }
     friend bool operator == ( const static_variant& a, const static_variant& b )
@@ -359,8 +390,7 @@ public:
             "Type not in static_variant."
         );
         if(_tag == impl::position<X, Types...>::pos) {
-            void* tmp(storage);
-            return *reinterpret_cast<X*>(tmp);
+            return storage_ops::template get<X>(storage);
         } else {
             FC_THROW_EXCEPTION( fc::assert_exception, "static_variant does not contain a value of type ${t}. Stored value has type: ${s}.",
               ("s", get_stored_type_name())("t",fc::get_typename<X>::name()) );
@@ -373,8 +403,7 @@ public:
             "Type not in static_variant."
         );
         if(_tag == impl::position<X, Types...>::pos) {
-            const void* tmp(storage);
-            return *reinterpret_cast<const X*>(tmp);
+            return storage_ops::template get<X>(storage);
         } else {
           FC_THROW_EXCEPTION(fc::assert_exception, "static_variant does not contain a value of type ${t}. Stored value has type: ${s}.",
             ("s", get_stored_type_name())("t", fc::get_typename<X>::name()));
@@ -382,22 +411,22 @@ public:
     }
     template<typename visitor>
     typename visitor::result_type visit(visitor& v) {
-        return impl::storage_ops<0, Types...>::apply(_tag, storage, v);
+        return storage_ops::apply(_tag, storage, v);
     }
 
     template<typename visitor>
     typename visitor::result_type visit(const visitor& v) {
-        return impl::storage_ops<0, Types...>::apply(_tag, storage, v);
+        return storage_ops::apply(_tag, storage, v);
     }
 
     template<typename visitor>
     typename visitor::result_type visit(visitor& v)const {
-        return impl::storage_ops<0, Types...>::apply(_tag, storage, v);
+        return storage_ops::apply(_tag, storage, v);
     }
 
     template<typename visitor>
     typename visitor::result_type visit(const visitor& v)const {
-        return impl::storage_ops<0, Types...>::apply(_tag, storage, v);
+        return storage_ops::apply(_tag, storage, v);
     }
 
     static int64_t count() { return static_cast< int64_t >( impl::type_info<Types...>::count ); }
@@ -405,7 +434,7 @@ public:
     int64_t which() const {return _tag;}
 private:
     void clear_storage() {
-      impl::storage_ops<0, Types...>::del(_tag, storage);
+      storage_ops::del(_tag, storage);
     }
 };
 
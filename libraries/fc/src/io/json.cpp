@@ -1,4 +1,5 @@
 #include <fc/io/json.hpp>
+#include <fc/io/json_reader.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/io/iostream.hpp>
 #include <fc/io/buffered_iostream.hpp>
@@ -93,6 +94,41 @@ namespace fc
     }
   };
 
+  /// same as fast_stream, but writes to the end of existing string
+  class appending_stream
+  {
+  private:
+    std::string &content;
+
+  public:
+    explicit appending_stream(std::string &target) : content(target) {}
+
+    appending_stream &operator<<(const char &v)
+    {
+      content += v;
+      return *this;
+    }
+
+    appending_stream &operator<<(const char *v)
+    {
+      content.append(v, std::strlen(v));
+      return *this;
+    }
+
+    appending_stream &operator<<(const std::string &v)
+    {
+      content.append(v);
+      return *this;
+    }
+
+    template <typename T>
+    appending_stream &operator<<(const T &v)
+    {
+      content.append(std::to_string(v));
+      return *this;
+    }
+  };
+
   template <typename T>
   char parseEscape(T &in, uint32_t)
   {
@@ -855,6 +891,18 @@ namespace fc
     return ss.str();
   }
 
+  void json::append(string &out, const variant &v, output_formatting format /* = stringify_large_ints_and_doubles */)
+  {
+    fc::appending_stream ss(out);
+    fc::to_stream(ss, v, format);
+  }
+
+  void json::append_string(string &out, const string &str)
+  {
+    fc::appending_stream ss(out);
+    fc::escape_string(str, ss);
+  }
+
   fc::string pretty_print(const fc::string &v, uint8_t indent)
   {
     int level = 0;
@@ -1191,6 +1239,141 @@ namespace fc
     FC_CAPTURE_AND_RETHROW((string_to_parse))
   }
 
+  namespace
+  {
+    variant to_variant_of(simdjson::ondemand::value &value) { return parse_element(value); }
+    variant to_variant_of(simdjson::ondemand::document &doc) { return parse_document(doc); }
+
+    template <typename Value>
+    class ondemand_reader final : public json_value_reader
+    {
+    public:
+      explicit ondemand_reader(Value &value) : _value(value) {}
+
+      kind_type kind() override
+      {
+        switch (_value.type())
+        {
+        case simdjson::ondemand::json_type::array:
+          return array_kind;
+        case simdjson::ondemand::json_type::object:
+          return object_kind;
+        case simdjson::ondemand::json_type::number:
+          switch (_value.get_number_type())
+          {
+          case simdjson::ondemand::number_type::signed_integer:
+            return int64_kind;
+          case simdjson::ondemand::number_type::unsigned_integer:
+            return uint64_kind;
+          case simdjson::ondemand::number_type::floating_point_number:
+          default:
+            return double_kind;
+          }
+        case simdjson::ondemand::json_type::string:
+          return string_kind;
+        case simdjson::ondemand::json_type::boolean:
+          return bool_kind;
+        case simdjson::ondemand::json_type::null:
+          return null_kind;
+        default:
+          FC_THROW("Encountered an unknown type during json parsing");
+        }
+      }
+
+      bool get_bool() override { return _value.get_bool(); }
+      int64_t get_int64() override { return _value.get_int64(); }
+      uint64_t get_uint64() override { return _value.get_uint64(); }
+      double get_double() override { return _value.get_double(); }
+      std::string_view get_string() override { return _value.get_string(); }
+
+      std::string_view get_raw_json() override
+      {
+        if (_value.type() == simdjson::ondemand::json_type::array)
+        {
+          simdjson::ondemand::array array = _value.get_array();
+          return array.raw_json();
+        }
+        simdjson::ondemand::object object = _value.get_object();
+        return object.raw_json();
+      }
+
+      void for_each_element(const element_callback &cb) override
+      {
+        for (auto element : _value.get_array())
+        {
+          simdjson::ondemand::value element_value = element.value();
+          ondemand_reader<simdjson::ondemand::value> element_reader(element_value);
+          cb(element_reader);
+        }
+      }
+
+      void for_each_field(const field_callback &cb) override
+      {
+        for (simdjson::ondemand::field field : _value.get_object())
+        {
+          std::string_view key = field.unescaped_key();
+          simdjson::ondemand::value field_value = field.value();
+          ondemand_reader<simdjson::ondemand::value> field_reader(field_value);
+          cb(key, field_reader);
+        }
+      }
+
+      variant to_variant() override { return to_variant_of(_value); }
+
+    private:
+      Value &_value;
+    };
+
+    struct read_buffer
+    {
+      simdjson::ondemand::parser parser;
+      std::string content;
+    };
+  } // end anonymous namespace
+
+  void json::read(std::string_view utf8_str, const std::function<void(json_value_reader &)> &reader_callback)
+  {
+    // one buffer per nesting level, so fragments of an outer document stay valid while inner ones are parsed
+    thread_local std::vector<std::unique_ptr<read_buffer>> buffers;
+    thread_local size_t nesting = 0;
+
+    if (nesting == buffers.size())
+      buffers.emplace_back(std::make_unique<read_buffer>());
+    read_buffer &buffer = *buffers[nesting];
+
+    struct nesting_guard
+    {
+      nesting_guard() { ++nesting; }
+      ~nesting_guard() { --nesting; }
+    } guard;
+
+    buffer.content.reserve(utf8_str.size() + simdjson::SIMDJSON_PADDING);
+    buffer.content.assign(utf8_str);
+
+    try
+    {
+      simdjson::ondemand::document doc = buffer.parser.iterate(buffer.content.data(), buffer.content.size(), buffer.content.capacity());
+
+      const auto type = doc.type().value();
+      if (type == simdjson::ondemand::json_type::array || type == simdjson::ondemand::json_type::object)
+      {
+        // on-demand parsing never looks past the root value, so reject trailing content up front
+        std::string_view root = doc.raw_json();
+        const size_t root_end = size_t(root.data() - buffer.content.data()) + root.size();
+        if (buffer.content.find_first_not_of(" \t\n\r", root_end) != std::string::npos)
+          FC_THROW_EXCEPTION(parse_error_exception, "Unexpected content after the end of json document");
+        doc.rewind();
+      }
+
+      ondemand_reader<simdjson::ondemand::document> root_reader(doc);
+      reader_callback(root_reader);
+    }
+    catch (const simdjson::simdjson_error &e)
+    {
+      FC_THROW_EXCEPTION(parse_error_exception, "Invalid json: ${what}", ("what", e.what()));
+    }
+  }
+
   namespace
   {
     void validate_element(simdjson::ondemand::value element)
@@ -0,0 +1,304 @@
+#include <fc/log/async_log_queue.hpp>
+#include <fc/log/logger.hpp>
+#include <fc/optional.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace fc {
+
+   namespace detail {
+
+      /**
+       *  Bounded MPSC queue (sequence numbered slots as in D. Vyukov's bounded MPMC queue, with single consumer).
+       *  Slot is free for producer when its sequence equals enqueue position and ready for consumer when it equals
+       *  dequeue position + 1.
+       */
+      class async_log_queue_impl
+      {
+         public:
+            explicit async_log_queue_impl( uint32_t capacity )
+            {
+               uint32_t size = 2;
+               while( size < capacity )
+                  size <<= 1;
+               _mask = size - 1;
+               _slots.reset( new slot[ size ] );
+               for( uint32_t i = 0; i < size; ++i )
+                  _slots[i].sequence.store( i, std::memory_order_relaxed );
+            }
+
+            bool push( const appender::ptr& a, const log_message& m )
+            {
+               size_t pos = _enqueue_pos.load( std::memory_order_relaxed );
+               slot* s = nullptr;
+               for( ;; )
+               {
+                  s = &_slots[ pos & _mask ];
+                  const size_t seq = s->sequence.load( std::memory_order_acquire );
+                  const intptr_t diff = intptr_t( seq ) - intptr_t( pos );
+                  if( diff == 0 )
+                  {
+                     if( _enqueue_pos.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                        break;
+                  }
+                  else if( diff < 0 )
+                  {
+                     _dropped.fetch_add( 1, std::memory_order_relaxed );
+                     return false;
+                  }
+                  else
+                  {
+                     pos = _enqueue_pos.load( std::memory_order_relaxed );
+                  }
+               }
+
+               s->target = a;
+               s->message = m;
+               s->sequence.store( pos + 1, std::memory_order_release );
+               return true;
+            }
+
+            /// only called from logging thread
+            bool pop( appender::ptr& a, fc::optional< log_message >& m )
+            {
+               slot& s = _slots[ _dequeue_pos & _mask ];
+               if( s.sequence.load( std::memory_order_acquire ) != _dequeue_pos + 1 )
+                  return false;
+
+               a = std::move( s.target );
+               s.target = appender::ptr();
+               m = std::move( s.message );
+               s.message.reset();
+               s.sequence.store( _dequeue_pos + _mask + 1, std::memory_order_release );
+               ++_dequeue_pos;
+               return true;
+            }
+
+            void start()
+            {
+               _stop = false;
+               _thread = std::thread( [this]() { run(); } );
+            }
+
+            void stop()
+            {
+               if( !_thread.joinable() )
+                  return;
+               {
+                  std::lock_guard< std::mutex > guard( _mutex );
+                  _stop = true;
+               }
+               _cv.notify_one();
+               _thread.join();
+            }
+
+            uint64_t get_dropped_count()const { return _dropped.load( std::memory_order_relaxed ); }
+
+         private:
+            static constexpr size_t batch_size = 1024;
+
+            struct slot
+            {
+               std::atomic< size_t >       sequence;
+               appender::ptr               target;
+               fc::optional< log_message > message;
+            };
+
+            void run()
+            {
+#ifdef __linux__
+               pthread_setname_np( pthread_self(), "async_logging" );
+#endif
+               std::vector< appender::ptr > touched; // usually just few distinct appenders per batch
+               appender::ptr target;
+               fc::optional< log_message > message;
+               uint64_t reported_dropped = get_dropped_count();
+
+               for( ;; )
+               {
+                  size_t count = 0;
+                  touched.clear();
+                  while( count < batch_size && pop( target, message ) )
+                  {
+                     ++count;
+                     try
+                     {
+                        target->log( *message );
+                     }
+                     catch( ... )
+                     {
+                        // logging must not kill logging thread
+                     }
+                     bool known = false;
+                     for( const auto& a : touched )
+                        known = known || a == target;
+                     if( !known )
+                        touched.push_back( std::move( target ) );
+                  }
+
+                  for( const auto& a : touched )
+                     flush( *a );
+
+                  const uint64_t dropped = get_dropped_count();
+                  if( dropped != reported_dropped )
+                  {
+                     report_dropped( dropped - reported_dropped );
+                     reported_dropped = dropped;
+                  }
+
+                  if( count == 0 )
+                  {
+                     std::unique_lock< std::mutex > lock( _mutex );
+                     if( _stop )
+                        break;
+                     // producers never wake us up (that would need a lock on their side), so just poll
+                     _cv.wait_for( lock, std::chrono::milliseconds( 2 ) );
+                  }
+               }
+
+               // stop is only requested once all producers are done with push(), but their messages could still
+               // land after the last (empty) batch above
+               touched.clear();
+               while( pop( target, message ) )
+               {
+                  try
+                  {
+                     target->log( *message );
+                  }
+                  catch( ... )
+                  {
+                  }
+                  bool known = false;
+                  for( const auto& a : touched )
+                     known = known || a == target;
+                  if( !known )
+                     touched.push_back( std::move( target ) );
+               }
+               for( const auto& a : touched )
+                  flush( *a );
+            }
+
+            static void flush( appender& a )
+            {
+               try
+               {
+                  a.flush();
+               }
+               catch( ... )
+               {
+               }
+            }
+
+            static void report_dropped( uint64_t dropped )
+            {
+               try
+               {
+                  log_message m( FC_LOG_CONTEXT( warn ), "Logging queue was full, dropped ${n} log messages",
+                     fc::mutable_variant_object()( "n", dropped ) );
+                  for( const auto& a : logger::get().get_appenders() )
+                     a->log( m );
+               }
+               catch( ... )
+               {
+                  std::cerr << "async logging dropped " << dropped << " log messages\n";
+               }
+            }
+
+            std::unique_ptr< slot[] >   _slots;
+            size_t                      _mask = 0;
+            alignas( 64 ) std::atomic< size_t > _enqueue_pos = { 0 };
+            alignas( 64 ) size_t        _dequeue_pos = 0;
+            std::atomic< uint64_t >     _dropped = { 0 };
+
+            std::thread                 _thread;
+            std::mutex                  _mutex;
+            std::condition_variable     _cv;
+            bool                        _stop = false;
+      };
+
+      enum async_log_queue_state : uint32_t
+      {
+         async_log_queue_disabled,
+         async_log_queue_enabled,
+         async_log_queue_stopping ///< no new messages accepted, queued ones are being written out
+      };
+
+      // never destroyed - producers can still be inside push() while the process is going down
+      static std::atomic< async_log_queue_impl* > _async_log_queue = { nullptr };
+      static std::atomic< uint32_t >              _async_log_queue_state = { async_log_queue_disabled };
+      /// number of producers inside push() - stop() waits for them before it lets logging thread finish
+      static std::atomic< uint32_t >              _async_log_queue_producers = { 0 };
+      static std::mutex                           _async_log_queue_control;
+
+   } // namespace detail
+
+   void async_log_queue::start( uint32_t capacity )
+   {
+      std::lock_guard< std::mutex > guard( detail::_async_log_queue_control );
+      if( detail::_async_log_queue_state.load() != detail::async_log_queue_disabled )
+         return;
+      // queue is reused after stop() (capacity of first start applies), so late producers never see freed memory
+      detail::async_log_queue_impl* q = detail::_async_log_queue.load();
+      if( q == nullptr )
+      {
+         q = new detail::async_log_queue_impl( capacity );
+         detail::_async_log_queue.store( q );
+      }
+      q->start();
+      detail::_async_log_queue_state.store( detail::async_log_queue_enabled );
+   }
+
+   void async_log_queue::stop()
+   {
+      std::lock_guard< std::mutex > guard( detail::_async_log_queue_control );
+      if( detail::_async_log_queue_state.load() != detail::async_log_queue_enabled )
+         return;
+      detail::_async_log_queue_state.store( detail::async_log_queue_stopping );
+      // producer that registered before state change pushes its message, later ones fall back to synchronous logging
+      while( detail::_async_log_queue_producers.load() != 0 )
+         std::this_thread::yield();
+      detail::_async_log_queue.load()->stop();
+      detail::_async_log_queue_state.store( detail::async_log_queue_disabled );
+   }
+
+   bool async_log_queue::is_enabled()
+   {
+      return detail::_async_log_queue_state.load( std::memory_order_relaxed ) != detail::async_log_queue_disabled;
+   }
+
+   bool async_log_queue::push( const appender::ptr& a, const log_message& m )
+   {
+      detail::_async_log_queue_producers.fetch_add( 1 );
+      const uint32_t state = detail::_async_log_queue_state.load();
+      if( state == detail::async_log_queue_enabled )
+         detail::_async_log_queue.load()->push( a, m ); // when queue is full message is just counted as dropped
+      detail::_async_log_queue_producers.fetch_sub( 1 );
+
+      if( state == detail::async_log_queue_enabled )
+         return true;
+      if( state == detail::async_log_queue_stopping )
+      {
+         // wait until messages queued earlier are written out, so the caller's synchronous message comes after them
+         std::lock_guard< std::mutex > guard( detail::_async_log_queue_control );
+      }
+      return false;
+   }
+
+   uint64_t async_log_queue::get_dropped_count()
+   {
+      detail::async_log_queue_impl* q = detail::_async_log_queue.load();
+      return q != nullptr ? q->get_dropped_count() : 0;
+   }
+
+} // namespace fc
@@ -1,6 +1,7 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/log/file_appender.hpp>
+#include <fc/log/async_log_queue.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/thread/scoped_lock.hpp>
 #include <fc/thread/thread.hpp>
@@ -230,11 +231,19 @@ namespace fc {
       {
         fc::scoped_lock<boost::mutex> lock( my->slock );
         my->out << line.str();
-        if( my->cfg.flush )
+        if( my->cfg.flush && !async_log_queue::is_enabled() )
           my->out.flush();
       }
    }
 
+   void file_appender::flush()
+   {
+      if( !my->cfg.flush )
+        return;
+      fc::scoped_lock<boost::mutex> lock( my->slock );
+      my->out.flush();
+   }
+
    static bool reg_file_appender = []( __attribute__((unused)) bool* )->bool
    {
       return appender::register_appender<file_appender>( "file" );
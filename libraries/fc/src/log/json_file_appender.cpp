@@ -1,6 +1,7 @@
 #include <fc/exception/exception.hpp>
 #include <fc/io/fstream.hpp>
 #include <fc/log/json_file_appender.hpp>
+#include <fc/log/async_log_queue.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/io/json.hpp>
 #include <fc/thread/scoped_lock.hpp>
@@ -273,7 +274,7 @@ namespace fc {
       {
         fc::scoped_lock<boost::mutex> lock( my->slock );
         my->out << json::to_string((mutable_variant_object)log_message_json) << "\n";
-        if( my->cfg.flush )
+        if( my->cfg.flush && !async_log_queue::is_enabled() )
           my->out.flush();
       }
 
@@ -281,4 +282,12 @@ namespace fc {
 
    }
 
+   void json_file_appender::flush()
+   {
+      if( !my->cfg.flush )
+        return;
+      fc::scoped_lock<boost::mutex> lock( my->slock );
+      my->out.flush();
+   }
+
 } // fc
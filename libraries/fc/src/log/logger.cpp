@@ -3,6 +3,7 @@
 #include <fc/thread/spin_lock.hpp>
 #include <fc/thread/scoped_lock.hpp>
 #include <fc/log/appender.hpp>
+#include <fc/log/async_log_queue.hpp>
 #include <fc/filesystem.hpp>
 #include <unordered_map>
 #include <string>
@@ -63,6 +64,23 @@ namespace fc {
     void logger::log( log_message m ) {
        m.get_context().append_context( my->_name );
 
+       if( async_log_queue::is_enabled() )
+       {
+          // copies of message share log_context, so it has to be complete (contexts of all parents appended)
+          // before first copy is handed over to logging thread
+          std::vector< const impl* > chain( 1, my.get() );
+          while( chain.back()->_additivity && chain.back()->_parent != nullptr )
+          {
+             chain.push_back( chain.back()->_parent.my.get() );
+             m.get_context().append_context( chain.back()->_name );
+          }
+          for( const impl* l : chain )
+             for( const auto& a : l->_appenders )
+                if( !async_log_queue::push( a, m ) )
+                   a->log( m ); // async logging was stopped after is_enabled() check
+          return;
+       }
+
        for( auto itr = my->_appenders.begin(); itr != my->_appenders.end(); ++itr )
           (*itr)->log( m );
 
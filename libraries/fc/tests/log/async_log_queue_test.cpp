@@ -0,0 +1,182 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/log/async_log_queue.hpp>
+#include <fc/log/logger.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace fc;
+
+namespace {
+
+// capacity of the queue is fixed by the first start() in the process, so all tests use the same one
+constexpr uint32_t queue_capacity = 1024;
+
+/// remembers (producer, index) of every message; optionally blocks until released
+class collecting_appender : public appender
+{
+   public:
+      void log( const log_message& m ) override
+      {
+         std::unique_lock< std::mutex > lock( _mutex );
+         _released.wait( lock, [this]() { return !_blocked; } );
+         const auto data = m.get_data();
+         _messages.emplace_back( data[ "p" ].as_uint64(), data[ "i" ].as_uint64() );
+      }
+
+      void block()
+      {
+         std::lock_guard< std::mutex > guard( _mutex );
+         _blocked = true;
+      }
+
+      void release()
+      {
+         {
+            std::lock_guard< std::mutex > guard( _mutex );
+            _blocked = false;
+         }
+         _released.notify_all();
+      }
+
+      std::vector< std::pair< uint64_t, uint64_t > > get_messages()
+      {
+         std::lock_guard< std::mutex > guard( _mutex );
+         return _messages;
+      }
+
+   private:
+      std::mutex                                      _mutex;
+      std::condition_variable                         _released;
+      bool                                            _blocked = false;
+      std::vector< std::pair< uint64_t, uint64_t > >  _messages;
+};
+
+struct test_logger
+{
+   test_logger() : appender( new collecting_appender() ), log( "async_log_queue_test" )
+   {
+      log.set_log_level( log_level::info );
+      log.add_appender( appender );
+   }
+
+   void write( uint64_t producer, uint64_t index )
+   {
+      fc_ilog( log, "message ${i} of producer ${p}", ( "p", producer )( "i", index ) );
+   }
+
+   /// checks that messages of each producer come in the order they were logged; returns their total number
+   size_t check_order( uint64_t producers )
+   {
+      const auto messages = static_cast< collecting_appender* >( appender.get() )->get_messages();
+      std::vector< int64_t > last( producers, -1 );
+      for( const auto& m : messages )
+      {
+         BOOST_REQUIRE_LT( m.first, producers );
+         BOOST_REQUIRE_LT( last[ m.first ], int64_t( m.second ) );
+         last[ m.first ] = m.second;
+      }
+      return messages.size();
+   }
+
+   collecting_appender& get_appender() { return *static_cast< collecting_appender* >( appender.get() ); }
+
+   fc::shared_ptr< fc::appender > appender;
+   logger                         log;
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(async_log_queue_tests)
+
+BOOST_AUTO_TEST_CASE(concurrent_producers_keep_order)
+{
+   const uint64_t producers = 4;
+   const uint64_t messages_per_producer = 5000;
+   test_logger t;
+   const uint64_t dropped_before = async_log_queue::get_dropped_count();
+
+   async_log_queue::start( queue_capacity );
+   std::vector< std::thread > threads;
+   for( uint64_t p = 0; p < producers; ++p )
+      threads.emplace_back( [&t, p, messages_per_producer]()
+      {
+         for( uint64_t i = 0; i < messages_per_producer; ++i )
+            t.write( p, i );
+      } );
+   for( auto& thread : threads )
+      thread.join();
+   async_log_queue::stop();
+
+   const uint64_t dropped = async_log_queue::get_dropped_count() - dropped_before;
+   const size_t received = t.check_order( producers );
+   BOOST_REQUIRE_EQUAL( received + dropped, producers * messages_per_producer );
+}
+
+BOOST_AUTO_TEST_CASE(full_queue_drops_are_counted)
+{
+   const uint64_t total = 5 * queue_capacity;
+   test_logger t;
+   const uint64_t dropped_before = async_log_queue::get_dropped_count();
+
+   async_log_queue::start( queue_capacity );
+   t.get_appender().block(); // logging thread gets stuck on first message, so the queue fills up
+   for( uint64_t i = 0; i < total; ++i )
+      t.write( 0, i );
+   const uint64_t dropped = async_log_queue::get_dropped_count() - dropped_before;
+   t.get_appender().release();
+   async_log_queue::stop();
+
+   // at most whole queue plus the message taken by logging thread could be accepted
+   BOOST_REQUIRE_GE( dropped, total - queue_capacity - 1 );
+   const size_t received = t.check_order( 1 );
+   BOOST_REQUIRE_EQUAL( received + dropped, total );
+}
+
+BOOST_AUTO_TEST_CASE(stop_and_start_while_producers_log)
+{
+   const uint64_t producers = 4;
+   test_logger t;
+   const uint64_t dropped_before = async_log_queue::get_dropped_count();
+   std::atomic< bool > done = { false };
+   std::vector< uint64_t > written( producers, 0 );
+
+   async_log_queue::start( queue_capacity );
+   std::vector< std::thread > threads;
+   for( uint64_t p = 0; p < producers; ++p )
+      threads.emplace_back( [&t, &done, &written, p]()
+      {
+         uint64_t i = 0;
+         while( !done.load() )
+            t.write( p, i++ );
+         written[ p ] = i;
+      } );
+
+   // messages pushed right before stop() must not get stranded in the queue, and those that are logged
+   // synchronously meanwhile must not overtake them
+   for( int round = 0; round < 50; ++round )
+   {
+      std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+      async_log_queue::stop();
+      std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+      async_log_queue::start( queue_capacity );
+   }
+   done.store( true );
+   for( auto& thread : threads )
+      thread.join();
+   async_log_queue::stop();
+
+   uint64_t total = 0;
+   for( uint64_t w : written )
+      total += w;
+   const uint64_t dropped = async_log_queue::get_dropped_count() - dropped_before;
+   const size_t received = t.check_order( producers );
+   BOOST_REQUIRE_EQUAL( received + dropped, total );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,8 @@ class abstract_account_history_api_impl
     virtual get_account_history_return get_account_history( const get_account_history_args& ) = 0;
     virtual enum_virtual_ops_return enum_virtual_ops( const enum_virtual_ops_args& ) = 0;
 
+    virtual void get_ops_in_block_binary( const get_ops_in_block_args&, json_rpc::binary_api_writer& ) = 0;
+
     const hive::chain::block_read_i& _block_reader;
 };
 
@@ -32,6 +34,8 @@ class account_history_api_rocksdb_impl : public abstract_account_history_api_imp
     get_account_history_return get_account_history( const get_account_history_args& ) override;
     enum_virtual_ops_return enum_virtual_ops( const enum_virtual_ops_args& ) override;
 
+    void get_ops_in_block_binary( const get_ops_in_block_args&, json_rpc::binary_api_writer& ) override;
+
     const account_history_rocksdb::account_history_rocksdb_plugin& _dataSource;
 };
 
@@ -51,6 +55,40 @@ DEFINE_API_IMPL( account_history_api_rocksdb_impl, get_ops_in_block )
   return result;
 }
 
+void account_history_api_rocksdb_impl::get_ops_in_block_binary( const get_ops_in_block_args& args, json_rpc::binary_api_writer& out )
+{
+  // same selection and order as get_ops_in_block, but operations are passed on exactly as they are stored
+  std::vector< account_history_rocksdb::rocksdb_operation_object > ops;
+
+  bool include_reversible = args.include_reversible.valid() ? *args.include_reversible : false;
+  _dataSource.find_operations_by_block(args.block_num, include_reversible,
+    [&ops, &args](const account_history_rocksdb::rocksdb_operation_object& op)
+    {
+      if( !args.only_virtual || op.is_virtual )
+        ops.push_back(op);
+    }
+  );
+
+  std::stable_sort( ops.begin(), ops.end(),
+    []( const account_history_rocksdb::rocksdb_operation_object& a, const account_history_rocksdb::rocksdb_operation_object& b )
+    {
+      return std::tie( a.block, a.trx_in_block, a.op_in_trx ) < std::tie( b.block, b.trx_in_block, b.op_in_trx );
+    } );
+
+  out.set_item_type( json_rpc::binary_item_type::operation );
+  for( const auto& op : ops )
+  {
+    binary_operation_header header;
+    header.trx_id = op.trx_id;
+    header.block = op.block;
+    header.trx_in_block = op.trx_in_block;
+    header.op_in_trx = op.op_in_trx;
+    header.virtual_op = op.is_virtual;
+    header.timestamp = op.timestamp;
+    out.add_item( header, op.serialized_op.data(), op.serialized_op.size() );
+  }
+}
+
 #define CHECK_OPERATION_LOW( r, data, CLASS_NAME ) \
   void operator()( const hive::protocol::CLASS_NAME& ) { \
     _accepted = _filter_low & static_cast< uint64_t >( get_account_history_op_filter_low::CLASS_NAME ); }
@@ -351,6 +389,12 @@ account_history_api::account_history_api( appbase::application& app )
 {
   my = std::make_unique< detail::account_history_api_rocksdb_impl >( app );
   JSON_RPC_REGISTER_API( HIVE_ACCOUNT_HISTORY_API_PLUGIN_NAME );
+
+  app.get_plugin< json_rpc::json_rpc_plugin >().add_binary_api_method( HIVE_ACCOUNT_HISTORY_API_PLUGIN_NAME, "get_ops_in_block",
+    [this]( const fc::variant& args, json_rpc::binary_api_writer& out )
+    {
+      my->get_ops_in_block_binary( args.as< get_ops_in_block_args >(), out );
+    } );
 }
 
 account_history_api::~account_history_api() {}
@@ -62,6 +62,20 @@ struct get_ops_in_block_return
   std::multiset< api_operation_object > ops;
 };
 
+/**
+  * Precedes every packed operation in binary response of get_ops_in_block
+  * (see json_rpc::binary_item_type::operation).
+  */
+struct binary_operation_header
+{
+  hive::protocol::transaction_id_type trx_id;
+  uint32_t                            block = 0;
+  uint32_t                            trx_in_block = 0;
+  uint32_t                            op_in_trx = 0;
+  bool                                virtual_op = false;
+  fc::time_point_sec                  timestamp;
+};
+
 
 struct get_transaction_args
 {
@@ -323,6 +337,9 @@ FC_REFLECT( hive::plugins::account_history::get_ops_in_block_args,
 FC_REFLECT( hive::plugins::account_history::get_ops_in_block_return,
   (ops) )
 
+FC_REFLECT( hive::plugins::account_history::binary_operation_header,
+  (trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp) )
+
 FC_REFLECT( hive::plugins::account_history::get_transaction_args,
   (id)(include_reversible) )
 
@@ -20,7 +20,12 @@ class block_api_impl
       (get_block_range)
     )
 
+    void get_block_range_binary( const get_block_range_args& args, json_rpc::binary_api_writer& out );
+
     const hive::chain::block_read_i& _block_reader;
+
+  private:
+    std::vector<std::shared_ptr<full_block_type>> fetch_block_range( const get_block_range_args& args );
 };
 
 //////////////////////////////////////////////////////////////////////
@@ -33,6 +38,12 @@ block_api::block_api( appbase::application& app )
   : my( new block_api_impl( app ) )
 {
   JSON_RPC_REGISTER_API( HIVE_BLOCK_API_PLUGIN_NAME );
+
+  app.get_plugin< json_rpc::json_rpc_plugin >().add_binary_api_method( HIVE_BLOCK_API_PLUGIN_NAME, "get_block_range",
+    [this]( const fc::variant& args, json_rpc::binary_api_writer& out )
+    {
+      my->get_block_range_binary( args.as< get_block_range_args >(), out );
+    } );
 }
 
 block_api::~block_api() {}
@@ -68,9 +79,8 @@ DEFINE_API_IMPL( block_api_impl, get_block )
   return result;
 }
 
-DEFINE_API_IMPL( block_api_impl, get_block_range )
+std::vector<std::shared_ptr<full_block_type>> block_api_impl::fetch_block_range( const get_block_range_args& args )
 {
-  get_block_range_return result;
   auto count = args.count;
   auto head = _block_reader.head_block_num(fc::seconds(1));
   if( args.starting_block_num > head )
@@ -78,14 +88,29 @@ DEFINE_API_IMPL( block_api_impl, get_block_range )
   else if( args.starting_block_num + count - 1 > head )
     count = head - args.starting_block_num + 1;
   if( count )
+    return _block_reader.fetch_block_range(args.starting_block_num, count, fc::seconds(1));
+  return {};
+}
+
+DEFINE_API_IMPL( block_api_impl, get_block_range )
+{
+  get_block_range_return result;
+  std::vector<std::shared_ptr<full_block_type>> full_blocks = fetch_block_range( args );
+  result.blocks.reserve(full_blocks.size());
+  for (const std::shared_ptr<full_block_type>& full_block : full_blocks)
+    result.blocks.push_back(full_block);
+  return result;
+}
+
+// blocks go out exactly as they are packed, no api_signed_block_object/JSON rendering involved
+void block_api_impl::get_block_range_binary( const get_block_range_args& args, json_rpc::binary_api_writer& out )
+{
+  out.set_item_type( json_rpc::binary_item_type::signed_block );
+  for( const std::shared_ptr<full_block_type>& full_block : fetch_block_range( args ) )
   {
-    std::vector<std::shared_ptr<full_block_type>> full_blocks = 
-      _block_reader.fetch_block_range(args.starting_block_num, count, fc::seconds(1));
-    result.blocks.reserve(full_blocks.size());
-    for (const std::shared_ptr<full_block_type>& full_block : full_blocks)
-      result.blocks.push_back(full_block);
+    const uncompressed_block_data& block = full_block->get_uncompressed_block();
+    out.add_item( block.raw_bytes.get(), block.raw_size );
   }
-  return result;
 }
 
 DEFINE_LOCKLESS_APIS( block_api,
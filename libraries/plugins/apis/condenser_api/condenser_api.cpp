@@ -277,10 +277,14 @@ namespace detail
       only_virtual = args.at(1).as< bool >();
     auto ops = _account_history_api->get_ops_in_block( { args.at(0).as< uint32_t >(), only_virtual } ).ops;
     get_ops_in_block_return result;
+    result.reserve( ops.size() );
 
-    for( auto& op_obj : ops )
+    while( !ops.empty() )
     {
-      result.push_back( hive::protocol::serializer_wrapper<api_operation_object>{ api_operation_object( op_obj, op_obj.op ), transaction_serialization_type::legacy } );
+      // extracted node can give away its operation instead of copying it
+      auto node = ops.extract( ops.begin() );
+      auto& op_obj = node.value();
+      result.push_back( hive::protocol::serializer_wrapper<api_operation_object>{ api_operation_object( op_obj, std::move( op_obj.op ) ), transaction_serialization_type::legacy } );
       result.back().value.op_in_trx = op_obj.op_in_trx;
     }
 
@@ -951,9 +955,9 @@ namespace detail
 
     for( auto& entry : history )
     {
-      api_operation_object obj( entry.second, entry.second.op );
+      api_operation_object obj( entry.second, std::move( entry.second.op ) );
       obj.op_in_trx = entry.second.op_in_trx;
-      result.emplace( entry.first, hive::protocol::serializer_wrapper<api_operation_object>{ obj, transaction_serialization_type::legacy } );
+      result.emplace( entry.first, hive::protocol::serializer_wrapper<api_operation_object>{ std::move( obj ), transaction_serialization_type::legacy } );
     }
 
     return result;
@@ -1362,6 +1366,19 @@ condenser_api::condenser_api( appbase::application& app )
   : my( new detail::condenser_api_impl( app ) ), theApp( app )
 {
   JSON_RPC_REGISTER_API( HIVE_CONDENSER_API_PLUGIN_NAME );
+
+  // the biggest results of condenser_api - rendered in legacy format straight from protocol objects
+  auto& rpc = app.get_plugin< json_rpc::json_rpc_plugin >();
+  rpc.add_rendered_api_method( HIVE_CONDENSER_API_PLUGIN_NAME, "get_ops_in_block",
+    [this]( const fc::variant& args, std::string& json_result )
+    {
+      fc::json_encode< fc::json_default_format >( json_result, get_ops_in_block( args.as< get_ops_in_block_args >(), true ) );
+    } );
+  rpc.add_rendered_api_method( HIVE_CONDENSER_API_PLUGIN_NAME, "get_account_history",
+    [this]( const fc::variant& args, std::string& json_result )
+    {
+      fc::json_encode< fc::json_default_format >( json_result, get_account_history( args.as< get_account_history_args >(), true ) );
+    } );
 }
 
 condenser_api::~condenser_api() {}
@@ -11,6 +11,8 @@
 #include <hive/plugins/condenser_api/condenser_api_legacy_objects.hpp>
 #include <hive/plugins/rc_api/rc_api.hpp>
 
+#include <hive/protocol/legacy_json.hpp>
+
 #include <fc/optional.hpp>
 #include <fc/variant.hpp>
 #include <fc/vector.hpp>
@@ -74,6 +76,14 @@ struct api_operation_object
     timestamp( obj.timestamp ),
     op( _op )
   {}
+  api_operation_object( const account_history::api_operation_object& obj, operation&& _op ) :
+    trx_id( obj.trx_id ),
+    block( obj.block ),
+    trx_in_block( obj.trx_in_block ),
+    virtual_op( obj.virtual_op ),
+    timestamp( obj.timestamp ),
+    op( std::move( _op ) )
+  {}
 
   transaction_id_type  trx_id;
   uint32_t             block = 0;
@@ -1090,6 +1100,7 @@ FC_REFLECT( hive::plugins::condenser_api::api_limit_order_object,
 
 FC_REFLECT( hive::plugins::condenser_api::api_operation_object,
           (trx_id)(block)(trx_in_block)(op_in_trx)(virtual_op)(timestamp)(op) )
+FC_JSON_DIRECT_ENCODE( hive::plugins::condenser_api::api_operation_object )
 
 FC_REFLECT( hive::plugins::condenser_api::api_account_object,
           (id)(name)(owner)(active)(posting)(memo_key)(json_metadata)(posting_json_metadata)
@@ -9,6 +9,7 @@
 #include <hive/protocol/exceptions.hpp>
 #include <hive/protocol/transaction_util.hpp>
 
+#include <hive/chain/index.hpp>
 #include <hive/chain/util/smt_token.hpp>
 
 #include <hive/utilities/git_revision.hpp>
@@ -38,10 +39,19 @@ api_commment_cashout_info::api_commment_cashout_info(const comment_cashout_objec
 }
 
 
+/// key of API-only ordering of accounts (richest first), see database-api-accounts-by-vesting-shares
+struct account_vesting_shares_key
+{
+  int64_t operator()( const account_object& a )const { return a.get_vesting().amount.value; }
+};
+
+typedef chainbase::ordered_secondary_index< account_object, account_vesting_shares_key, std::greater<> >
+  accounts_by_vesting_shares_index;
+
 class database_api_impl
 {
   public:
-    database_api_impl( appbase::application& app );
+    database_api_impl( appbase::application& app, bool accounts_by_vesting_shares );
     ~database_api_impl();
 
     DECLARE_API_IMPL
@@ -229,6 +239,7 @@ class database_api_impl
     }
 
     chain::database& _db;
+    std::shared_ptr< accounts_by_vesting_shares_index > _accounts_by_vesting_shares;
 };
 
 
@@ -240,16 +251,23 @@ class database_api_impl
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( appbase::application& app )
-  : my( new database_api_impl( app ) )
+database_api::database_api( appbase::application& app, bool accounts_by_vesting_shares )
+  : my( new database_api_impl( app, accounts_by_vesting_shares ) )
 {
   JSON_RPC_REGISTER_API( HIVE_DATABASE_API_PLUGIN_NAME );
 }
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( appbase::application& app )
-  : _db( app.get_plugin< hive::plugins::chain::chain_plugin >().db() ) {}
+database_api_impl::database_api_impl( appbase::application& app, bool accounts_by_vesting_shares )
+  : _db( app.get_plugin< hive::plugins::chain::chain_plugin >().db() )
+{
+  if( accounts_by_vesting_shares )
+  {
+    _accounts_by_vesting_shares = std::make_shared< accounts_by_vesting_shares_index >();
+    hive::chain::add_plugin_secondary_index< chain::account_index >( _db, _accounts_by_vesting_shares );
+  }
+}
 
 database_api_impl::~database_api_impl() {}
 
@@ -544,6 +562,23 @@ DEFINE_API_IMPL( database_api_impl, list_accounts )
         &database_api_impl::filter_default< account_object > );
       break;
     }
+    case( by_vesting_shares ):
+    {
+      FC_ASSERT( _accounts_by_vesting_shares, "Order by_vesting_shares needs database-api-accounts-by-vesting-shares option" );
+      // start is [ max vesting shares, first account ] (empty account name to start with first one with such vests)
+      auto key = args.start.as< std::pair< share_type, account_name_type > >();
+      auto itr = _accounts_by_vesting_shares->lower_bound( key.first.value );
+      if( key.second != account_name_type() )
+      {
+        const auto* start_account = _db.find_account( key.second );
+        FC_ASSERT( start_account != nullptr, "Given start account does not exist." );
+        itr = _accounts_by_vesting_shares->lower_bound( key.first.value, start_account->get_id() );
+      }
+      iteration_loop( itr, _accounts_by_vesting_shares->end(), result.accounts, args.limit,
+        [&]( const accounts_by_vesting_shares_index::entry& e, const database& db ){ return api_account_object( *e.object, db, args.delayed_votes_active ); },
+        &database_api_impl::filter_default< accounts_by_vesting_shares_index::entry > );
+      break;
+    }
     default:
       FC_ASSERT( false, "Unknown or unsupported sort order '${o}'", ( "o", args.order ) );
   }
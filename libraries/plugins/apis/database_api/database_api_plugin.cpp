@@ -8,11 +8,17 @@ database_api_plugin::~database_api_plugin() {}
 
 void database_api_plugin::set_program_options(
   options_description& cli,
-  options_description& cfg ) {}
+  options_description& cfg )
+{
+  cfg.add_options()
+    ( "database-api-accounts-by-vesting-shares", boost::program_options::value< bool >()->default_value( false ),
+      "Keep in-memory ordering of accounts by vesting shares for list_accounts with by_vesting_shares order" )
+    ;
+}
 
 void database_api_plugin::plugin_initialize( const variables_map& options )
 {
-  api = std::make_shared< database_api >( get_app() );
+  api = std::make_shared< database_api >( get_app(), options.at( "database-api-accounts-by-vesting-shares" ).as< bool >() );
 }
 
 void database_api_plugin::plugin_startup() {}
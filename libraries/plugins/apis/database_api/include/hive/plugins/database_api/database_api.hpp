@@ -12,7 +12,8 @@ class database_api_impl;
 class database_api
 {
   public:
-    database_api( appbase::application& app );
+    /// @param accounts_by_vesting_shares maintain API-only ordering needed for list_accounts by_vesting_shares
+    database_api( appbase::application& app, bool accounts_by_vesting_shares = false );
     ~database_api();
 
     DECLARE_API(
@@ -7,6 +7,8 @@
 
 #include <hive/plugins/json_rpc/utility.hpp>
 
+#include <fc/io/json_decode.hpp>
+
 #define DATABASE_API_DEFAULT_QUERY_LIMIT 0
 #define DATABASE_API_SINGLE_QUERY_LIMIT 1000
 
@@ -65,6 +67,7 @@ enum sort_order_type
   by_proposal_voter,
   by_contributor,
   by_symbol_id,
+  by_vesting_shares, //< needs database-api-accounts-by-vesting-shares (not a consensus index)
   not_set //< keep it as last (it would be better if it was first == 0, however people are using enums
     //not just with names, but with values as well and those would change if not_set was made first
 };
@@ -755,6 +758,7 @@ FC_REFLECT_ENUM( hive::plugins::database_api::sort_order_type,
   (by_proposal_voter)
   (by_contributor)
   (by_symbol_id)
+  (by_vesting_shares)
   (not_set) )
 
 FC_REFLECT_ENUM( hive::plugins::database_api::order_direction_type,
@@ -991,3 +995,15 @@ FC_REFLECT( hive::plugins::database_api::is_known_transaction_args,
 
 FC_REFLECT( hive::plugins::database_api::is_known_transaction_return,
   (is_known) )
+
+// argument types of the most frequent and largest lookups are decoded straight from request json
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::list_object_args_type )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::list_accounts_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_accounts_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_witnesses_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::get_active_witnesses_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_comments_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_votes_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_limit_orders_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::find_proposals_args )
+FC_JSON_DIRECT_DECODE( hive::plugins::database_api::is_known_transaction_args )
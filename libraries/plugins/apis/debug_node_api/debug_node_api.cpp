@@ -35,6 +35,8 @@ class debug_node_api_impl
       (debug_has_hardfork)
       (debug_get_json_schema)
       (debug_throw_exception)
+      (debug_set_operation_profiling)
+      (debug_get_operation_profile)
     )
 
     chain::chain_plugin&              _chain;
@@ -116,6 +118,27 @@ DEFINE_API_IMPL( debug_node_api_impl, debug_throw_exception )
   return {};
 }
 
+DEFINE_API_IMPL( debug_node_api_impl, debug_set_operation_profiling )
+{
+  auto& profiler = _db.get_operation_profiler();
+  if( args.reset )
+    profiler.reset();
+  profiler.set_enabled( args.enabled );
+  return {};
+}
+
+DEFINE_API_IMPL( debug_node_api_impl, debug_get_operation_profile )
+{
+  const auto& profiler = _db.get_operation_profiler();
+
+  debug_get_operation_profile_return result;
+  result.enabled = profiler.is_enabled();
+  result.entries = profiler.get_entries();
+  if( args.include_folded_stacks )
+    result.folded_stacks = profiler.get_folded_stacks();
+  return result;
+}
+
 } // detail
 
 debug_node_api::debug_node_api( appbase::application& app): my( new detail::debug_node_api_impl( app ) )
@@ -141,6 +164,8 @@ DEFINE_READ_APIS( debug_node_api,
 DEFINE_LOCKLESS_APIS( debug_node_api,
   (debug_get_json_schema) // the whole schema thing is (and pretty much always was) dead
   (debug_throw_exception) // might be lockless because it just sets flag to trigger exception on next on_post_apply_block
+  (debug_set_operation_profiling) // profiler state is atomic/guarded by its own mutex
+  (debug_get_operation_profile)
 )
 
 } } } // hive::plugins::debug_node
@@ -3,6 +3,8 @@
 #include <hive/plugins/database_api/database_api_objects.hpp>
 #include <hive/plugins/debug_node/debug_node_plugin.hpp>
 
+#include <hive/chain/util/operation_profiler.hpp>
+
 #include <hive/protocol/types.hpp>
 
 #include <fc/optional.hpp>
@@ -137,6 +139,27 @@ struct debug_throw_exception_args
 
 typedef void_type debug_throw_exception_return;
 
+struct debug_set_operation_profiling_args
+{
+  bool enabled = false;
+  bool reset = false; // clears times collected so far
+};
+
+typedef void_type debug_set_operation_profiling_return;
+
+struct debug_get_operation_profile_args
+{
+  bool include_folded_stacks = false;
+};
+
+struct debug_get_operation_profile_return
+{
+  bool                                                        enabled = false;
+  std::vector< hive::chain::util::operation_profiler::entry > entries;
+  // input for flamegraph tools (f.e. flamegraph.pl), one stack per line with its self time in nanoseconds
+  fc::optional< std::string >                                 folded_stacks;
+};
+
 class debug_node_api
 {
   public:
@@ -164,6 +187,12 @@ class debug_node_api
       (debug_get_json_schema)
       (debug_throw_exception)
       (debug_set_vest_price)
+
+      /*
+      * Switch per-operation profiling of block application on/off (see --profile-operations) and read its results.
+      */
+      (debug_set_operation_profiling)
+      (debug_get_operation_profile)
     )
 
   private:
@@ -218,3 +247,12 @@ FC_REFLECT( hive::plugins::debug_node::debug_get_json_schema_return,
 
 FC_REFLECT( hive::plugins::debug_node::debug_throw_exception_args,
         (throw_exception) )
+
+FC_REFLECT( hive::plugins::debug_node::debug_set_operation_profiling_args,
+        (enabled)(reset) )
+
+FC_REFLECT( hive::plugins::debug_node::debug_get_operation_profile_args,
+        (include_folded_stacks) )
+
+FC_REFLECT( hive::plugins::debug_node::debug_get_operation_profile_return,
+        (enabled)(entries)(folded_stacks) )
@@ -0,0 +1,39 @@
+#pragma once
+#include <hive/plugins/json_rpc/utility.hpp>
+#include <hive/plugins/statsd/statsd_plugin.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+namespace hive { namespace plugins { namespace statsd_api {
+
+using hive::plugins::statsd::aggregated_metric;
+
+/* get_metrics */
+struct get_metrics_args
+{
+  std::string prefix; ///< only metrics with names starting with it (all when empty)
+};
+
+struct get_metrics_return
+{
+  std::vector< aggregated_metric > metrics;
+};
+
+namespace detail{ class statsd_api_impl; }
+
+class statsd_api
+{
+  public:
+    statsd_api(appbase::application& app);
+    ~statsd_api();
+
+    DECLARE_API((get_metrics))
+
+  private:
+    std::unique_ptr<detail::statsd_api_impl> my;
+};
+
+} } } // hive::plugins::statsd_api
+
+FC_REFLECT(hive::plugins::statsd_api::get_metrics_args, (prefix))
+FC_REFLECT(hive::plugins::statsd_api::get_metrics_return, (metrics))
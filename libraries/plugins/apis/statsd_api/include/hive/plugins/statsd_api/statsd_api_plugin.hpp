@@ -0,0 +1,36 @@
+#pragma once
+#include <hive/plugins/json_rpc/json_rpc_plugin.hpp>
+#include <hive/plugins/statsd/statsd_plugin.hpp>
+
+#include <appbase/application.hpp>
+
+#define HIVE_STATSD_API_PLUGIN_NAME "statsd_api"
+
+namespace hive { namespace plugins { namespace statsd_api {
+
+using namespace appbase;
+
+class statsd_api_plugin : public appbase::plugin< statsd_api_plugin >
+{
+  public:
+    APPBASE_PLUGIN_REQUIRES((hive::plugins::json_rpc::json_rpc_plugin)
+                            (hive::plugins::statsd::statsd_plugin))
+
+    statsd_api_plugin();
+    virtual ~statsd_api_plugin();
+
+    static const std::string& name()
+    {
+      static std::string name = HIVE_STATSD_API_PLUGIN_NAME;
+      return name;
+    }
+
+    virtual void set_program_options(options_description& cli, options_description& cfg) override;
+    virtual void plugin_initialize(const variables_map& options) override;
+    virtual void plugin_startup() override;
+    virtual void plugin_shutdown() override;
+
+    std::shared_ptr<class statsd_api> api;
+};
+
+} } } // hive::plugins::statsd_api
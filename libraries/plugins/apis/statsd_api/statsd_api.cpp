@@ -0,0 +1,42 @@
+#include <hive/plugins/statsd_api/statsd_api.hpp>
+#include <hive/plugins/statsd_api/statsd_api_plugin.hpp>
+
+#include <appbase/application.hpp>
+
+namespace hive { namespace plugins { namespace statsd_api {
+
+namespace detail
+{
+  class statsd_api_impl
+  {
+    public:
+      statsd_api_impl( appbase::application& app ) : _statsd( app.get_plugin< hive::plugins::statsd::statsd_plugin >() )
+      {}
+
+      DECLARE_API_IMPL((get_metrics))
+      const hive::plugins::statsd::statsd_plugin& _statsd;
+  };
+
+
+  DEFINE_API_IMPL(statsd_api_impl, get_metrics)
+  {
+    get_metrics_return result;
+    for( auto& metric : _statsd.get_metrics() )
+    {
+      if( metric.name.compare( 0, args.prefix.size(), args.prefix ) == 0 )
+        result.metrics.emplace_back( std::move( metric ) );
+    }
+    return result;
+  }
+} // detail
+
+statsd_api::statsd_api( appbase::application& app ) : my(new detail::statsd_api_impl( app ))
+{
+  JSON_RPC_REGISTER_API(HIVE_STATSD_API_PLUGIN_NAME);
+}
+
+statsd_api::~statsd_api() {}
+
+DEFINE_LOCKLESS_APIS(statsd_api, (get_metrics))
+
+} } } // hive::plugins::statsd_api
@@ -0,0 +1,19 @@
+#include <hive/plugins/statsd_api/statsd_api.hpp>
+#include <hive/plugins/statsd_api/statsd_api_plugin.hpp>
+
+namespace hive { namespace plugins { namespace statsd_api {
+
+statsd_api_plugin::statsd_api_plugin() {}
+statsd_api_plugin::~statsd_api_plugin() {}
+
+void statsd_api_plugin::set_program_options(options_description& cli, options_description& cfg) {}
+
+void statsd_api_plugin::plugin_initialize(const variables_map& options)
+{
+  api = std::make_shared<statsd_api>(get_app());
+}
+
+void statsd_api_plugin::plugin_startup() {}
+void statsd_api_plugin::plugin_shutdown() {}
+
+} } } // hive::plugins::statsd_api
@@ -22,7 +22,7 @@ class wallet_bridge_api_impl
     wallet_bridge_api_impl( appbase::application& app );
     ~wallet_bridge_api_impl();
 
-    void on_post_apply_block( const chain::block_notification& note );
+    void on_post_apply_block( const chain::block_observation& note );
 
     DECLARE_API_IMPL(
         (get_version)
@@ -165,13 +165,20 @@ void wallet_bridge_api::api_startup()
     ilog("Wallet bridge api initialized. Missing plugins: ${missing_plugins}", ( "missing_plugins", not_enabled_plugins ));
 }
 
+void wallet_bridge_api::api_shutdown()
+{
+  chain::util::disconnect_signal( my->_on_post_apply_block_conn );
+  my->_db.flush_observers();
+}
+
 wallet_bridge_api_impl::wallet_bridge_api_impl( appbase::application& app ): 
                 _chain(app.get_plugin< hive::plugins::chain::chain_plugin >()),
                 _db( _chain.db() ),
                 theApp( app )
 {
-  _on_post_apply_block_conn = _db.add_post_apply_block_handler([&]( const chain::block_notification& note ){ on_post_apply_block( note ); },
-  theApp.get_plugin< hive::plugins::wallet_bridge_api::wallet_bridge_api_plugin >(), 0 );
+  // only uses block data, so it can be run outside of block processing
+  _on_post_apply_block_conn = _db.add_post_apply_block_observer([&]( const chain::block_observation& note ){ on_post_apply_block( note ); },
+  theApp.get_plugin< hive::plugins::wallet_bridge_api::wallet_bridge_api_plugin >() );
 }
 
 wallet_bridge_api_impl::~wallet_bridge_api_impl() {}
@@ -183,7 +190,7 @@ void wallet_bridge_api_impl::verify_args( const variant& v, size_t length_requir
     ("size", v.get_array().size())("req",length_required) );
 }
 
-void wallet_bridge_api_impl::on_post_apply_block( const chain::block_notification& note )
+void wallet_bridge_api_impl::on_post_apply_block( const chain::block_observation& note )
 { try {
   boost::lock_guard< boost::mutex > guard( _mtx );
   int32_t block_num = int32_t(note.block_num);
@@ -21,6 +21,9 @@ void wallet_bridge_api_plugin::plugin_startup()
   api->api_startup();
 }
 
-void wallet_bridge_api_plugin::plugin_shutdown() {}
+void wallet_bridge_api_plugin::plugin_shutdown()
+{
+  api->api_shutdown();
+}
 
 } } } //hive::plugins::wallet_bridge_api
@@ -31,6 +31,7 @@
 
 #include <thread>
 #include <chrono>
+#include <fstream>
 #include <memory>
 #include <iostream>
 #include <mutex>
@@ -177,9 +178,11 @@ class chain_plugin_impl
     using block_log_open_args=block_storage_i::block_log_open_args;
 
     uint64_t                         shared_memory_size = 0;
+    uint64_t                         shared_memory_max_size = 0;
     uint16_t                         shared_file_full_threshold = 0;
     uint16_t                         shared_file_scale_rate = 0;
     uint32_t                         chainbase_flags = 0;
+    uint64_t                         shared_file_numa_nodes = 0;
     bfs::path                        shared_memory_dir;
     bool                             replay = false;
     bool                             resync   = false;
@@ -197,6 +200,7 @@ class chain_plugin_impl
     bool                             validate_during_replay = false;
     uint32_t                         benchmark_interval = 0;
     uint32_t                         flush_interval = 0;
+    uint64_t                         background_flush_rate = 0;
     bool                             replay_in_memory = false;
     std::vector< std::string >       replay_memory_indices{};
     bool                             enable_block_log_compression = true;
@@ -222,6 +226,7 @@ class chain_plugin_impl
     bool                             running = true;
 
     int16_t                          write_lock_hold_time = HIVE_BLOCK_INTERVAL * 1000 / 6; // 1/6 of block time (millseconds)
+    chain_plugin::write_lock_stats_handler on_write_lock_released;
 
     vector< string >                 loaded_plugins;
     fc::mutable_variant_object       plugin_state_opts;
@@ -664,6 +669,8 @@ void chain_plugin_impl::start_write_processing()
             last_popped_item_time = fc::time_point::now();
           } // while items in priority_write_queue or write_queue and time limit not exceeded for live sync
           head_block_time = db.head_block_time();
+          if( on_write_lock_released )
+            on_write_lock_released( write_lock_acquisition_time, fc::time_point::now() - write_lock_acquired_time, write_queue_items_processed );
         }); // with_write_lock
 
         if (is_syncing && get_time_gap_to_live_sync( head_block_time ).count() < 0) //we're syncing, see if we are close enough to move to live sync
@@ -807,6 +814,7 @@ void chain_plugin_impl::initial_settings()
   }
 
   db.set_flush_interval( flush_interval );
+  db.set_background_flush_rate( background_flush_rate );
   add_checkpoints( loaded_checkpoints, thread_pool  );
   db.set_require_locking( check_locks );
 
@@ -830,9 +838,11 @@ void chain_plugin_impl::initial_settings()
   db_open_args.data_dir = theApp.data_dir() / "blockchain";
   db_open_args.shared_mem_dir = shared_memory_dir;
   db_open_args.shared_file_size = shared_memory_size;
+  db_open_args.shared_file_max_size = shared_memory_max_size;
   db_open_args.shared_file_full_threshold = shared_file_full_threshold;
   db_open_args.shared_file_scale_rate = shared_file_scale_rate;
   db_open_args.chainbase_flags = chainbase_flags;
+  db_open_args.shared_file_numa_nodes = shared_file_numa_nodes;
   db_open_args.do_validate_invariants = validate_invariants;
   db_open_args.stop_replay_at = stop_replay_at;
   db_open_args.force_replay = force_replay;
@@ -1179,6 +1189,15 @@ uint32_t chain_plugin_impl::reindex( const open_args& args, const block_read_i&
     ilog("Done reindexing, elapsed time: ${elapsed_time} sec",
          ("elapsed_time", double((end_time - start_time).count()) / 1000000.0));
 
+    const auto& profiler = db.get_operation_profiler();
+    if( profiler.is_enabled() )
+    {
+      const fc::path profile_path = args.data_dir / "operation_profile";
+      fc::json::save_to_file( profiler.get_entries(), profile_path.generic_string() + ".json" );
+      std::ofstream( profile_path.generic_string() + ".folded" ) << profiler.get_folded_stacks();
+      ilog( "Operation profile of replay saved to ${profile_path}.json/.folded", (profile_path) );
+    }
+
     note.reindex_success = true;
 
     return note.last_block_number;
@@ -1443,13 +1462,29 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
       ("shared-file-dir", bpo::value<bfs::path>()->default_value("blockchain")->value_name("dir"), // NOLINT(clang-analyzer-optin.cplusplus.VirtualCall)
         "the location of the chain shared memory files (absolute path or relative to application data dir)")
       ("shared-file-size", bpo::value<string>()->default_value("24G"), "Size of the shared memory file. Default: 24G. If running with many plugins, increase this value to 28G.")
+      ("shared-file-max-size", bpo::value<string>()->default_value("0"),
+        "Size of address space reserved for the shared memory file. When greater than shared-file-size, autoscaling extends the file in place (also in live mode), without remapping it. Default: 0 (no reservation)." )
       ("shared-file-full-threshold", bpo::value<uint16_t>()->default_value(0),
         "A 2 precision percentage (0-10000) that defines the threshold for when to autoscale the shared memory file. Setting this to 0 disables autoscaling. Recommended value for consensus node is 9500 (95%)." )
       ("shared-file-scale-rate", bpo::value<uint16_t>()->default_value(0),
         "A 2 precision percentage (0-10000) that defines how quickly to scale the shared memory file. When autoscaling occurs the file's size will be increased by this percent. Setting this to 0 disables autoscaling. Recommended value is between 1000-2000 (10-20%)" )
+      ("shared-file-huge-pages", bpo::bool_switch()->default_value(false),
+        "Advise the kernel to back the shared memory file mapping with transparent huge pages. To use explicit huge pages instead, point shared-file-dir to a hugetlbfs mount." )
+      ("shared-file-prefault", bpo::bool_switch()->default_value(false),
+        "Fault in whole shared memory file at startup (using all cores), instead of paging it in during first blocks and API calls." )
+      ("shared-file-in-memory", bpo::bool_switch()->default_value(false),
+        "Keep chain state in anonymous process memory instead of the shared memory file. Nothing is stored in shared-file-dir and state is lost on exit - meant for tests and throwaway nodes." )
+      ("shared-file-copy-on-write", bpo::bool_switch()->default_value(false),
+        "Start from existing shared memory file (of stopped node) mapped copy-on-write: changes are kept in process memory and the file is never modified, so many nodes can start from the same prepared state. Block log has to be a copy of the one that produced the state." )
+      ("shared-file-numa-policy", bpo::value<string>()->default_value("default"),
+        "NUMA placement of shared memory file pages: default, interleave or bind. Affects pages allocated after startup, so it is fully effective for files on tmpfs or hugetlbfs." )
+      ("shared-file-numa-nodes", bpo::value< vector<uint32_t> >()->composing(),
+        "NUMA nodes used by shared-file-numa-policy (can be specified multiple times). By default all nodes are used." )
       ("checkpoint,c", bpo::value<vector<string>>()->composing(), "Pairs of [BLOCK_NUM,BLOCK_ID] that should be enforced as checkpoints.")
       ("flush-state-interval", bpo::value<uint32_t>(),
         "flush shared memory changes to disk every N blocks")
+      ("flush-state-background-rate", bpo::value<string>()->default_value("0"),
+        "Continuously write back shared memory changes from a background thread, covering at most given size of the file per second (i.e. 256M). Replaces periodic flush-state-interval flushes. 0 disables." )
       ("enable-block-log-compression", boost::program_options::value<bool>()->default_value(true), "Compress blocks using zstd as they're added to the block log" )
       ("enable-block-log-auto-fixing", boost::program_options::value<bool>()->default_value(true), "If enabled, corrupted block_log will try to fix itself automatically." )
       ("block-log-compression-level", bpo::value<int>()->default_value(15), "Block log zstd compression level 0 (fast, low compression) - 22 (slow, high compression)" )
@@ -1465,6 +1500,7 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
       ("max-mempool-size", bpo::value<string>()->default_value( "100M" ), "Postponed transactions that exceed limit are dropped from pending. Setting 0 means only pending transactions that fit in reapplication window of 200ms will stay in mempool.")
       ("rc-flood-level", bpo::value<uint16_t>()->default_value( 20 ), "Number of full blocks that can be present in mempool before RC surcharge is applied. 0-65535. Default 20 (one minute of full blocks).")
       ("rc-flood-surcharge", bpo::value<uint16_t>()->default_value( HIVE_100_PERCENT ), "Multiplication factor for temporary extra RC cost charged for each block above flood level before transaction is allowed to enter and remain in pending. 0-10000. Default 10000 (100%).")
+      ("observer-queue-limit", bpo::value<uint32_t>()->default_value( hive::chain::util::notification_observers::default_queue_limit ), "Number of notifications each plugin observing them can fall behind block processing before it has to wait for that plugin. Must be positive.")
       ;
   cli.add_options()
       ("replay-blockchain", bpo::bool_switch()->default_value(false), "clear chain database and replay all blocks" )
@@ -1475,6 +1511,8 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
       ("force-replay", bpo::bool_switch()->default_value(false), "Before replaying clean all old files. If specifed, `--replay-blockchain` flag is implied")
       ("validate-during-replay", bpo::bool_switch()->default_value(false), "Runs all validations that are normally turned off during replay")
       ("advanced-benchmark", "Make profiling for every plugin.")
+      ("profile-operations", bpo::bool_switch()->default_value(false), "Attribute block application time to operation types, evaluators, RC and handlers of each plugin from the start "
+        "(can be switched at any time with debug_node_api.debug_set_operation_profiling). Profile of replay is saved to operation_profile.json and operation_profile.folded in data dir.")
       ("set-benchmark-interval", bpo::value<uint32_t>(), "Print time and memory usage every given number of blocks")
       ("dump-memory-details", bpo::bool_switch()->default_value(false), "Dump database objects memory usage info. Use set-benchmark-interval to set dump interval.")
       ("check-locks", bpo::bool_switch()->default_value(false), "Check correctness of chainbase locking" )
@@ -1516,6 +1554,7 @@ void chain_plugin::plugin_initialize(const variables_map& options)
   }
 
   my->shared_memory_size = fc::parse_size( options.at( "shared-file-size" ).as< string >() );
+  my->shared_memory_max_size = fc::parse_size( options.at( "shared-file-max-size" ).as< string >() );
 
   if( options.count( "shared-file-full-threshold" ) )
     my->shared_file_full_threshold = options.at( "shared-file-full-threshold" ).as< uint16_t >();
@@ -1523,6 +1562,32 @@ void chain_plugin::plugin_initialize(const variables_map& options)
   if( options.count( "shared-file-scale-rate" ) )
     my->shared_file_scale_rate = options.at( "shared-file-scale-rate" ).as< uint16_t >();
 
+  if( options.at( "shared-file-huge-pages" ).as< bool >() )
+    my->chainbase_flags |= chainbase::huge_pages;
+  if( options.at( "shared-file-prefault" ).as< bool >() )
+    my->chainbase_flags |= chainbase::prefault;
+  if( options.at( "shared-file-in-memory" ).as< bool >() )
+    my->chainbase_flags |= chainbase::heap_backed;
+  if( options.at( "shared-file-copy-on-write" ).as< bool >() )
+    my->chainbase_flags |= chainbase::copy_on_write;
+
+  const std::string numa_policy = options.at( "shared-file-numa-policy" ).as< string >();
+  if( numa_policy == "interleave" )
+    my->chainbase_flags |= chainbase::numa_interleave;
+  else if( numa_policy == "bind" )
+    my->chainbase_flags |= chainbase::numa_bind;
+  else
+    FC_ASSERT( numa_policy == "default", "Unknown shared-file-numa-policy: ${numa_policy}", ( numa_policy ) );
+
+  if( options.count( "shared-file-numa-nodes" ) )
+  {
+    for( uint32_t node : options.at( "shared-file-numa-nodes" ).as< vector< uint32_t > >() )
+    {
+      FC_ASSERT( node < 64, "NUMA node number out of range: ${node}", ( node ) );
+      my->shared_file_numa_nodes |= uint64_t( 1 ) << node;
+    }
+  }
+
   my->force_replay        = options.count( "force-replay" ) ? options.at( "force-replay" ).as<bool>() : false;
   my->validate_during_replay =
     options.count( "validate-during-replay" ) ? options.at( "validate-during-replay" ).as<bool>() : false;
@@ -1559,6 +1624,13 @@ void chain_plugin::plugin_initialize(const variables_map& options)
   else
     my->flush_interval = 10000;
 
+  my->background_flush_rate = fc::parse_size( options.at( "flush-state-background-rate" ).as< string >() );
+  if( my->background_flush_rate != 0 )
+  {
+    ilog( "Shared memory changes will be flushed in background, periodic flush every ${n} blocks is disabled", ( "n", my->flush_interval ) );
+    my->flush_interval = 0;
+  }
+
   if(options.count("checkpoint"))
   {
     auto cps = options.at("checkpoint").as<vector<string>>();
@@ -1572,6 +1644,11 @@ void chain_plugin::plugin_initialize(const variables_map& options)
 
   this->my->setup_benchmark_dumper();
   my->benchmark_is_enabled = (options.count( "advanced-benchmark" ) != 0);
+  my->db.get_operation_profiler().set_enabled( options.at( "profile-operations" ).as< bool >() );
+
+  const uint32_t observer_queue_limit = options.at( "observer-queue-limit" ).as< uint32_t >();
+  FC_ASSERT( observer_queue_limit > 0, "observer-queue-limit must be positive" );
+  my->db.set_observer_queue_limit( observer_queue_limit );
 
   if( options.count( "statsd-record-on-replay" ) )
   {
@@ -2047,6 +2124,14 @@ int16_t chain_plugin::set_write_lock_hold_time( int16_t new_time )
   return old_time;
 }
 
+void chain_plugin::set_write_lock_stats_handler( write_lock_stats_handler handler )
+{
+  FC_ASSERT( get_state() == appbase::abstract_plugin::state::initialized,
+    "Can only set write lock stats handler while chain_plugin is initialized." );
+
+  my->on_write_lock_released = std::move( handler );
+}
+
 void chain_plugin::check_time_in_block(const hive::chain::signed_block& block)
 {
   const fc::time_point_sec max_accept_time = fc::time_point_sec(fc::time_point::now()) + my->allow_future_time;
@@ -93,6 +93,19 @@ public:
     */
   int16_t set_write_lock_hold_time( int16_t new_time );
 
+  /**
+    * Handler called by the write thread right before it releases write lock, with time spent waiting
+    * for the lock, time it was held and number of write requests processed under it.
+    */
+  typedef std::function< void( const fc::microseconds& acquisition_time, const fc::microseconds& hold_time,
+    uint32_t items_processed ) > write_lock_stats_handler;
+
+  /**
+    * Sets handler for write lock statistics (used by benchmarking tools). Only one handler can be set
+    * and only while chain_plugin is initialized.
+    */
+  void set_write_lock_stats_handler( write_lock_stats_handler handler );
+
   void check_time_in_block( const hive::chain::signed_block& block );
 
   template< typename MultiIndexType >
@@ -0,0 +1,59 @@
+#include <hive/plugins/json_rpc/binary_api.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/io/raw.hpp>
+
+#include <zstd.h>
+
+#include <limits>
+
+namespace hive { namespace plugins { namespace json_rpc {
+
+void binary_api_writer::append_size( size_t size )
+{
+  FC_ASSERT( size <= std::numeric_limits< uint32_t >::max(), "Binary response item too large" );
+  char buffer[ 8 ];
+  fc::datastream< char* > ds( buffer, sizeof( buffer ) );
+  fc::raw::pack( ds, fc::unsigned_int( static_cast< uint32_t >( size ) ) );
+  _payload.append( buffer, ds.tellp() );
+}
+
+std::string binary_api_writer::finish( binary_compression compression )const
+{
+  FC_ASSERT( _payload.size() <= std::numeric_limits< uint32_t >::max(), "Binary response too large" );
+
+  std::string result( "HIVB" );
+  result.push_back( static_cast< char >( version ) );
+  result.push_back( static_cast< char >( compression ) );
+
+  char header[ sizeof( uint16_t ) + 2 * sizeof( uint32_t ) ];
+  fc::datastream< char* > ds( header, sizeof( header ) );
+  fc::raw::pack( ds, static_cast< uint16_t >( _type ) );
+  fc::raw::pack( ds, _count );
+  fc::raw::pack( ds, static_cast< uint32_t >( _payload.size() ) );
+  result.append( header, sizeof( header ) );
+
+  switch( compression )
+  {
+    case binary_compression::none:
+      result.append( _payload );
+      break;
+    case binary_compression::zstd:
+    {
+      const size_t offset = result.size();
+      result.resize( offset + ZSTD_compressBound( _payload.size() ) );
+      const size_t compressed_size = ZSTD_compress( &result[ offset ], result.size() - offset,
+        _payload.data(), _payload.size(), ZSTD_CLEVEL_DEFAULT );
+      FC_ASSERT( !ZSTD_isError( compressed_size ), "Error compressing binary response with zstd: ${e}",
+        ( "e", ZSTD_getErrorName( compressed_size ) ) );
+      result.resize( offset + compressed_size );
+      break;
+    }
+    default:
+      FC_ASSERT( false, "Unknown compression ${c}", ( "c", static_cast< uint32_t >( compression ) ) );
+  }
+
+  return result;
+}
+
+} } } // hive::plugins::json_rpc
@@ -0,0 +1,90 @@
+#pragma once
+#include <fc/io/datastream.hpp>
+#include <fc/io/raw_fwd.hpp>
+#include <fc/variant.hpp>
+
+#include <functional>
+#include <string>
+
+#define HIVE_BINARY_API_CONTENT_TYPE "application/x-hive-binary"
+
+namespace hive { namespace plugins { namespace json_rpc {
+
+enum class binary_compression : uint8_t
+{
+  none = 0,
+  zstd = 1 ///< payload is a single, regular zstd frame
+};
+
+enum class binary_item_type : uint16_t
+{
+  unknown = 0,
+  signed_block = 1, ///< fc::raw packed signed_block
+  operation = 2     ///< fc::raw packed binary_operation_header followed by fc::raw packed operation
+};
+
+/**
+  * Builds responses of the binary transport (see json_rpc_plugin::call_binary). Layout:
+  *
+  *   char[4]   magic "HIVB"
+  *   uint8_t   version (1)
+  *   uint8_t   compression of the payload (binary_compression)
+  *   uint16_t  type of items (binary_item_type)
+  *   uint32_t  number of items
+  *   uint32_t  size of uncompressed payload
+  *   payload   for each item: its size as fc::unsigned_int (varint) followed by its bytes
+  *
+  * Integers are little endian like everything fc::raw packs.
+  */
+class binary_api_writer
+{
+  public:
+    static constexpr uint8_t version = 1;
+
+    void set_item_type( binary_item_type type ) { _type = type; }
+
+    /// appends item that is already packed, e.g. uncompressed block from full_block_type
+    void add_item( const char* data, size_t size )
+    {
+      append_size( size );
+      _payload.append( data, size );
+      ++_count;
+    }
+
+    /// appends item made of packed `prefix` immediately followed by already packed `data`
+    template< typename Prefix >
+    void add_item( const Prefix& prefix, const char* data, size_t size )
+    {
+      const size_t prefix_size = fc::raw::pack_size( prefix );
+      append_size( prefix_size + size );
+
+      const size_t offset = _payload.size();
+      _payload.resize( offset + prefix_size );
+      fc::datastream< char* > ds( &_payload[ offset ], prefix_size );
+      fc::raw::pack( ds, prefix );
+
+      _payload.append( data, size );
+      ++_count;
+    }
+
+    uint32_t item_count()const { return _count; }
+
+    /// header followed by (optionally compressed) payload
+    std::string finish( binary_compression compression )const;
+
+  private:
+    void append_size( size_t size );
+
+    binary_item_type  _type = binary_item_type::unknown;
+    uint32_t          _count = 0;
+    std::string       _payload;
+};
+
+/**
+  * @brief Binding of a method that can also answer with binary_api_writer frame instead of JSON.
+  *
+  * Arguments still come as JSON-RPC params.
+  */
+typedef std::function< void( const fc::variant& args, binary_api_writer& out ) > api_binary_method;
+
+} } } // hive::plugins::json_rpc
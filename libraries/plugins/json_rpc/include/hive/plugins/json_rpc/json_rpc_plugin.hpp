@@ -2,8 +2,11 @@
 #include <chainbase/forward_declarations.hpp>
 #include <appbase/application.hpp>
 
+#include <hive/plugins/json_rpc/binary_api.hpp>
+
 #include <fc/variant.hpp>
 #include <fc/io/json.hpp>
+#include <fc/io/json_decode.hpp>
 #include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
 
@@ -73,6 +76,21 @@ using namespace appbase;
   */
 typedef std::function< fc::variant(const fc::variant&) > api_method;
 
+/**
+  * @brief Binding used for methods whose argument type is marked with FC_JSON_DIRECT_DECODE
+  *
+  * Arguments are decoded straight from the request json, `decoded` is set once that succeeded
+  * so errors of the call itself can be told apart from malformed arguments.
+  */
+typedef std::function< fc::variant(fc::json_value_reader& args, bool& decoded) > api_direct_method;
+
+/**
+  * @brief Binding that writes JSON text of the result itself (e.g. with fc::json_encode) instead of returning variant
+  *
+  * Used for JSON-RPC requests only, everything else keeps calling api_method registered under the same name.
+  */
+typedef std::function< void(const fc::variant& args, string& json_result) > api_rendered_method;
+
 /**
   * @brief An API, containing APIs and Methods
   *
@@ -110,9 +128,21 @@ class json_rpc_plugin : public appbase::plugin< json_rpc_plugin >
     virtual void plugin_shutdown() override;
     virtual void plugin_finalize_startup() override;
 
-    void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
-    void add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
+    void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig,
+      const api_direct_method& direct_api = api_direct_method() );
+    void add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig,
+      const api_direct_method& direct_api = api_direct_method() );
+    /// registers binary form of already registered method, see binary_api_writer
+    void add_binary_api_method( const string& api_name, const string& method_name, const api_binary_method& api );
+    /// registers form of already registered method that renders its JSON result directly, see api_rendered_method
+    void add_rendered_api_method( const string& api_name, const string& method_name, const api_rendered_method& api );
     string call( const string& body );
+    /**
+      * Answers single "api.method" request with binary frame when the method has binary form. Otherwise
+      * (no binary form, batches, "call" requests, errors) `response` holds regular JSON-RPC response.
+      * Returns true for binary response.
+      */
+    bool call_binary( const string& body, binary_compression compression, string& response );
 
     void add_serialization_status( const std::function<bool()>& serialization_status );
 
@@ -122,7 +152,8 @@ class json_rpc_plugin : public appbase::plugin< json_rpc_plugin >
 
 namespace detail {
 
-  template <void (json_rpc_plugin::*add_api_method_function)(const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig)>
+  template <void (json_rpc_plugin::*add_api_method_function)(const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig,
+    const api_direct_method& direct_api)>
   class register_api_method_visitor_template
   {
     public:
@@ -139,12 +170,24 @@ namespace detail {
         Args* args,
         Ret* ret )
       {
+        api_direct_method direct_api;
+        if constexpr( fc::json_direct_decode< Args >::value )
+        {
+          direct_api = [&plugin,method]( fc::json_value_reader& reader, bool& decoded ) -> fc::variant
+          {
+            Args args;
+            fc::json_decode( reader, args );
+            decoded = true;
+            return fc::variant( (plugin.*method)( args, /* lock= */ true ) );
+          };
+        }
+
         (_json_rpc_plugin.*add_api_method_function)( _api_name, method_name,
           [&plugin,method]( const fc::variant& args ) -> fc::variant
           {
             return fc::variant( (plugin.*method)( args.as< Args >(), /* lock= */ true ) ); //lock=true means it will lock if not in DEFINE_LOCKLESS_API
           },
-          api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) } );
+          api_method_signature{ fc::variant( Args() ), fc::variant( Ret() ) }, direct_api );
       }
 
     private:
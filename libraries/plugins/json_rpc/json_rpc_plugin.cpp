@@ -124,8 +124,40 @@ namespace detail
     fc::optional< fc::variant >      result;
     fc::optional< json_rpc_error >   error;
     fc::variant                      id;
+
+    /// JSON text of result produced by api_rendered_method, not reflected - see to_json()
+    fc::optional< std::string >      rendered_result;
   };
 
+  string to_json( const json_rpc_response& response )
+  {
+    if( !response.rendered_result.valid() )
+      return fc::json::to_string( response );
+
+    // same text fc::json::to_string gives for reflected members: jsonrpc, result, id (no error when there is result)
+    string json = "{\"jsonrpc\":";
+    fc::json::append_string( json, response.jsonrpc );
+    json += ",\"result\":";
+    json += *response.rendered_result;
+    json += ",\"id\":";
+    fc::json::append( json, response.id );
+    json += '}';
+    return json;
+  }
+
+  string to_json( const vector< json_rpc_response >& responses )
+  {
+    string json = "[";
+    for( const auto& response : responses )
+    {
+      if( json.size() > 1 )
+        json += ',';
+      json += to_json( response );
+    }
+    json += ']';
+    return json;
+  }
+
   typedef void_type             get_methods_args;
   typedef vector< string >      get_methods_return;
 
@@ -231,6 +263,9 @@ namespace detail
       map< string, api_description >                     _registered_apis;
       vector< string >                                   _methods;
       map< string, map< string, api_method_signature > > _method_sigs;
+      map< string, map< string, api_direct_method > >    _direct_apis;
+      map< string, map< string, api_binary_method > >    _binary_apis;
+      map< string, map< string, api_rendered_method > >  _rendered_apis;
     } data, proxy_data;
 
     detail::rpc_obfuscator obfuscator;
@@ -239,16 +274,22 @@ namespace detail
       json_rpc_plugin_impl( appbase::application& app );
       ~json_rpc_plugin_impl();
 
-      void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
-      void add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig );
+      void add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig, const api_direct_method& direct_api );
+      void add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig, const api_direct_method& direct_api );
       void plugin_finalize_startup();
       void plugin_pre_shutdown();
 
       api_method* find_api_method( const std::string& api, const std::string& method );
+      api_direct_method* find_direct_api_method( const std::string& api, const std::string& method );
+      void add_binary_api_method( const string& api_name, const string& method_name, const api_binary_method& api );
+      api_binary_method* find_binary_api_method( const std::string& method );
+      void add_rendered_api_method( const string& api_name, const string& method_name, const api_rendered_method& api );
+      api_rendered_method* find_rendered_api_method( const std::string& method );
       api_method* process_params( string method, const fc::variant_object& request, fc::variant& func_args, string* method_name );
       void rpc_id( const fc::variant_object& request, json_rpc_response& response );
       bool rpc_jsonrpc( const fc::variant_object& request, json_rpc_response& response );
       json_rpc_response rpc( const fc::variant& message );
+      bool direct_rpc( const string& message, string& result );
 
       void initialize();
 
@@ -272,26 +313,30 @@ namespace detail
   json_rpc_plugin_impl::~json_rpc_plugin_impl() {}
 
 
-  void json_rpc_plugin_impl::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig )
+  void json_rpc_plugin_impl::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig, const api_direct_method& direct_api )
   {
     wdump((api_name)(method_name));
     proxy_data._registered_apis[ api_name ][ method_name ] = api;
     proxy_data._method_sigs[ api_name ][ method_name ] = sig;
+    if( direct_api )
+      proxy_data._direct_apis[ api_name ][ method_name ] = direct_api;
 
     std::stringstream canonical_name;
     canonical_name << api_name << '.' << method_name;
     proxy_data._methods.push_back( canonical_name.str() );
   }
 
-  void json_rpc_plugin_impl::add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig )
+  void json_rpc_plugin_impl::add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig, const api_direct_method& direct_api )
   {
     data._registered_apis[api_name][method_name] = api;
     data._method_sigs[api_name][method_name] = sig;
+    if( direct_api )
+      data._direct_apis[api_name][method_name] = direct_api;
     std::stringstream canonical_name;
     canonical_name << api_name << '.' << method_name;
     data._methods.push_back(canonical_name.str());
 
-    add_api_method(api_name, method_name, api, sig);
+    add_api_method(api_name, method_name, api, sig, direct_api);
   }
 
   void json_rpc_plugin_impl::plugin_finalize_startup()
@@ -301,6 +346,9 @@ namespace detail
     data._registered_apis = std::move( proxy_data._registered_apis );
     data._methods         = std::move( proxy_data._methods );
     data._method_sigs     = std::move( proxy_data._method_sigs );
+    data._direct_apis     = std::move( proxy_data._direct_apis );
+    data._binary_apis     = std::move( proxy_data._binary_apis );
+    data._rendered_apis   = std::move( proxy_data._rendered_apis );
   }
 
   void json_rpc_plugin_impl::plugin_pre_shutdown()
@@ -308,6 +356,9 @@ namespace detail
     data._registered_apis.clear();
     data._methods.clear();
     data._method_sigs.clear();
+    data._direct_apis.clear();
+    data._binary_apis.clear();
+    data._rendered_apis.clear();
   }
 
   void json_rpc_plugin_impl::initialize()
@@ -351,6 +402,59 @@ namespace detail
     return &(method_itr->second);
   }
 
+  api_direct_method* json_rpc_plugin_impl::find_direct_api_method( const std::string& api, const std::string& method )
+  {
+    auto api_itr = data._direct_apis.find( api );
+    if( api_itr == data._direct_apis.end() )
+      return nullptr;
+
+    auto method_itr = api_itr->second.find( method );
+    if( method_itr == api_itr->second.end() )
+      return nullptr;
+
+    return &(method_itr->second);
+  }
+
+  void json_rpc_plugin_impl::add_binary_api_method( const string& api_name, const string& method_name, const api_binary_method& api )
+  {
+    proxy_data._binary_apis[ api_name ][ method_name ] = api;
+  }
+
+  /// looks up "api.method" in one of the optional bindings, nullptr when it has none
+  template< typename Method >
+  Method* find_optional_api_method( map< string, map< string, Method > >& apis, const std::string& method )
+  {
+    vector< std::string > v;
+    boost::split( v, method, boost::is_any_of( "." ) );
+    if( v.size() != 2 )
+      return nullptr;
+
+    auto api_itr = apis.find( v[0] );
+    if( api_itr == apis.end() )
+      return nullptr;
+
+    auto method_itr = api_itr->second.find( v[1] );
+    if( method_itr == api_itr->second.end() )
+      return nullptr;
+
+    return &(method_itr->second);
+  }
+
+  api_binary_method* json_rpc_plugin_impl::find_binary_api_method( const std::string& method )
+  {
+    return find_optional_api_method( data._binary_apis, method );
+  }
+
+  void json_rpc_plugin_impl::add_rendered_api_method( const string& api_name, const string& method_name, const api_rendered_method& api )
+  {
+    proxy_data._rendered_apis[ api_name ][ method_name ] = api;
+  }
+
+  api_rendered_method* json_rpc_plugin_impl::find_rendered_api_method( const std::string& method )
+  {
+    return find_optional_api_method( data._rendered_apis, method );
+  }
+
   api_method* json_rpc_plugin_impl::process_params( string method, const fc::variant_object& request, fc::variant& func_args, string* method_name )
   {
     STATSD_START_TIMER( "jsonrpc", "overhead", "process_params", 1.0f, theApp );
@@ -450,10 +554,22 @@ namespace detail
               {
                 STATSD_START_TIMER( "jsonrpc", "api", method_name, 1.0f, theApp );
 
+                // json-rpc logger needs the result as variant
+                api_rendered_method* rendered_call = _logger ? nullptr : find_rendered_api_method( method_name );
+
                 bool _change_of_serialization_is_allowed = false;
                 try
                 {
-                  response.result = (*call)( func_args );
+                  if( rendered_call )
+                  {
+                    string json_result;
+                    (*rendered_call)( func_args, json_result );
+                    response.rendered_result = std::move( json_result );
+                  }
+                  else
+                  {
+                    response.result = (*call)( func_args );
+                  }
                 }
                 catch( fc::bad_cast_exception& e )
                 {
@@ -586,11 +702,139 @@ namespace detail
 
     return response;
   }
+
+  /**
+    * Handles a single "api.method" request whose arguments are decoded straight from json, without building
+    * a variant tree of the request. Returns false (before the method was called) whenever the request needs
+    * anything from the regular path - batches, "call" requests, methods without direct binding, malformed
+    * or unusual envelopes or arguments - so that it can produce the response (or error) as it always did.
+    */
+  bool json_rpc_plugin_impl::direct_rpc( const string& message, string& result )
+  {
+    // json-rpc logger, debug dump of requests and obfuscation of their secrets all work on the variant tree
+    if( _logger || fc::logger::get( DEFAULT_LOGGER ).is_enabled( fc::log_level::debug ) )
+      return false;
+
+    STATSD_START_TIMER( "jsonrpc", "overhead", "direct_rpc", 1.0f, theApp );
+
+    json_rpc_response response;
+    bool handled = false;
+
+    try
+    {
+      fc::json::read( message, [&]( fc::json_value_reader& request )
+      {
+        if( request.kind() != fc::json_value_reader::object_kind )
+          return;
+
+        bool irregular = false;
+        bool has_jsonrpc = false;
+        bool has_id = false;
+        bool has_method = false;
+        std::string method;
+        fc::optional< std::string_view > params;
+
+        request.for_each_field( [&]( std::string_view key, fc::json_value_reader& field )
+        {
+          const auto kind = field.kind();
+          if( key == "jsonrpc" && !has_jsonrpc && kind == fc::json_value_reader::string_kind )
+          {
+            has_jsonrpc = true;
+            irregular |= field.get_string() != "2.0";
+          }
+          else if( key == "method" && !has_method && kind == fc::json_value_reader::string_kind )
+          {
+            has_method = true;
+            method = field.get_string();
+          }
+          else if( key == "id" && !has_id && ( kind == fc::json_value_reader::int64_kind ||
+                   kind == fc::json_value_reader::uint64_kind || kind == fc::json_value_reader::string_kind ) )
+          {
+            has_id = true;
+            response.id = field.to_variant();
+          }
+          else if( key == "params" && !params.valid() && kind == fc::json_value_reader::object_kind )
+          {
+            params = field.get_raw_json();
+          }
+          else
+          {
+            irregular |= ( key == "jsonrpc" || key == "method" || key == "id" || key == "params" );
+            field.to_variant();
+          }
+        } );
+
+        if( irregular || !has_jsonrpc || !has_method )
+          return;
+
+        const auto separator = method.find( '.' );
+        if( separator == std::string::npos || method.find( '.', separator + 1 ) != std::string::npos )
+          return;
+
+        api_direct_method* call = find_direct_api_method( method.substr( 0, separator ), method.substr( separator + 1 ) );
+        if( call == nullptr )
+          return;
+
+        bool decoded = false;
+        try
+        {
+          STATSD_START_TIMER( "jsonrpc", "api", method, 1.0f, theApp );
+          fc::json::read( params.valid() ? *params : std::string_view( "{}" ), [&]( fc::json_value_reader& args )
+          {
+            response.result = (*call)( args, decoded );
+          } );
+        }
+        // same error codes as rpc_jsonrpc() and rpc() give to failures of the call itself
+        catch( chainbase::lock_exception& e )
+        {
+          if( !decoded )
+            return;
+          response.error = json_rpc_error( JSON_RPC_ERROR_DURING_CALL, e.what() );
+        }
+        catch( fc::assert_exception& e )
+        {
+          if( !decoded )
+            return;
+          response.error = json_rpc_error( JSON_RPC_ERROR_DURING_CALL, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+        }
+        catch( fc::exception& e )
+        {
+          if( !decoded )
+            return;
+          response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+        }
+        catch( std::exception& e )
+        {
+          if( !decoded )
+            return;
+          response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown error - parsing rpc message failed", fc::variant( e.what() ) );
+        }
+        catch( ... )
+        {
+          if( !decoded )
+            return;
+          response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown error - parsing rpc message failed" );
+        }
+
+        handled = true;
+      } );
+    }
+    catch( ... )
+    {
+      // thrown before the method was called - let the regular path report the problem
+      return false;
+    }
+
+    if( handled )
+      result = fc::json::to_string( response );
+    return handled;
+  }
 }
 
 using detail::json_rpc_error;
 using detail::json_rpc_response;
 using detail::json_rpc_logger;
+using detail::to_json;
 
 json_rpc_plugin::json_rpc_plugin(){}
 json_rpc_plugin::~json_rpc_plugin() {}
@@ -635,14 +879,96 @@ void json_rpc_plugin::plugin_finalize_startup()
   my->plugin_finalize_startup();
 }
 
-void json_rpc_plugin::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig )
+void json_rpc_plugin::add_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig,
+  const api_direct_method& direct_api )
 {
-  my->add_api_method( api_name, method_name, api, sig );
+  my->add_api_method( api_name, method_name, api, sig, direct_api );
 }
 
-void json_rpc_plugin::add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig )
+void json_rpc_plugin::add_early_api_method( const string& api_name, const string& method_name, const api_method& api, const api_method_signature& sig,
+  const api_direct_method& direct_api )
 {
-  my->add_early_api_method( api_name, method_name, api, sig );
+  my->add_early_api_method( api_name, method_name, api, sig, direct_api );
+}
+
+void json_rpc_plugin::add_binary_api_method( const string& api_name, const string& method_name, const api_binary_method& api )
+{
+  my->add_binary_api_method( api_name, method_name, api );
+}
+
+void json_rpc_plugin::add_rendered_api_method( const string& api_name, const string& method_name, const api_rendered_method& api )
+{
+  my->add_rendered_api_method( api_name, method_name, api );
+}
+
+bool json_rpc_plugin::call_binary( const string& message, binary_compression compression, string& response )
+{
+  STATSD_START_TIMER( "jsonrpc", "overhead", "call_binary", 1.0f, get_app() );
+
+  api_binary_method* binary_call = nullptr;
+  fc::variant args;
+  fc::variant id;
+
+  try
+  {
+    fc::variant v = fc::json::from_string( message, fc::json::format_validation_mode::full );
+    if( v.is_object() )
+    {
+      const auto& request = v.get_object();
+      if( request.contains( "jsonrpc" ) && request[ "jsonrpc" ].is_string() && request[ "jsonrpc" ].as_string() == "2.0" &&
+          request.contains( "method" ) && request[ "method" ].is_string() )
+      {
+        binary_call = my->find_binary_api_method( request[ "method" ].as_string() );
+        args = request.contains( "params" ) ? request[ "params" ] : fc::variant( fc::variant_object() );
+        if( request.contains( "id" ) )
+          id = request[ "id" ];
+      }
+    }
+  }
+  catch( ... )
+  {
+    // malformed request - regular path reports it
+  }
+
+  if( binary_call == nullptr )
+  {
+    response = call( message );
+    return false;
+  }
+
+  json_rpc_response error_response;
+  error_response.id = id;
+
+  try
+  {
+    binary_api_writer writer;
+    (*binary_call)( args, writer );
+    response = writer.finish( compression );
+    return true;
+  }
+  catch( fc::bad_cast_exception& e )
+  {
+    error_response.error = json_rpc_error( JSON_RPC_PARSE_PARAMS_ERROR, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+  }
+  catch( fc::assert_exception& e )
+  {
+    error_response.error = json_rpc_error( JSON_RPC_ERROR_DURING_CALL, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+  }
+  catch( fc::exception& e )
+  {
+    error_response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, e.to_string(), fc::variant( *(e.dynamic_copy_exception()) ) );
+  }
+  catch( std::exception& e )
+  {
+    error_response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown error - parsing rpc message failed", fc::variant( e.what() ) );
+  }
+  catch( ... )
+  {
+    error_response.error = json_rpc_error( JSON_RPC_SERVER_ERROR, "Unknown error - parsing rpc message failed" );
+  }
+
+  response = fc::json::to_string( error_response );
+  return false;
 }
 
 string json_rpc_plugin::call( const string& message )
@@ -650,6 +976,10 @@ string json_rpc_plugin::call( const string& message )
   STATSD_START_TIMER( "jsonrpc", "overhead", "call", 1.0f, get_app() );
   try
   {
+    string result;
+    if( my->direct_rpc( message, result ) )
+      return result;
+
     fc::variant v = fc::json::from_string( message, fc::json::format_validation_mode::full );
 
     if( v.is_array() )
@@ -664,7 +994,7 @@ string json_rpc_plugin::call( const string& message )
         for( auto& m : messages )
           responses.push_back( my->rpc( m ) );
 
-        return fc::json::to_string( responses );
+        return to_json( responses );
       }
       else
       {
@@ -676,7 +1006,7 @@ string json_rpc_plugin::call( const string& message )
     }
     else
     {
-      return fc::json::to_string( my->rpc( v ) );
+      return to_json( my->rpc( v ) );
     }
   }
   catch( fc::exception& e )
@@ -1,10 +1,20 @@
 #include <hive/plugins/pacemaker/pacemaker_plugin.hpp>
 
 #include <hive/chain/block_log.hpp>
+#include <hive/chain/witness_objects.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
 #define BLOCK_EMISSION_LOOP_SLEEP_TIME (100000)
 
 namespace hive { namespace plugins { namespace pacemaker {
@@ -17,6 +27,110 @@ namespace bfs = boost::filesystem;
 
 namespace detail {
 
+/**
+ * Thread safe histogram of time measurements (in microseconds) for benchmark report. Uses fixed set of buckets,
+ * so memory does not grow with length of benchmark: values below 64 have their own buckets, each higher power
+ * of two range is split into 32 buckets (percentiles are reported with precision of about 3%).
+ */
+class latency_samples
+{
+public:
+  void add( const fc::microseconds& value )
+  {
+    const uint64_t v = std::max< int64_t >( value.count(), 0 );
+    std::lock_guard< std::mutex > guard( _mutex );
+    ++_buckets[ bucket_index( v ) ];
+    ++_count;
+    _total += v;
+    _max = std::max( _max, v );
+  }
+
+  fc::variant_object get_report() const
+  {
+    std::lock_guard< std::mutex > guard( _mutex );
+    fc::mutable_variant_object result;
+    result( "count", _count );
+    if( _count == 0 )
+      return result;
+
+    auto percentile = [&]( uint32_t p )
+    {
+      const uint64_t rank = ( _count - 1 ) * p / 100;
+      uint64_t seen = 0;
+      for( uint32_t i = 0; i < bucket_count; ++i )
+      {
+        seen += _buckets[i];
+        if( seen > rank )
+          return std::min( bucket_upper_bound( i ), _max );
+      }
+      return _max;
+    };
+    result( "avg", _total / _count )
+      ( "p50", percentile( 50 ) )( "p90", percentile( 90 ) )( "p99", percentile( 99 ) )
+      ( "max", _max );
+    return result;
+  }
+
+private:
+  static constexpr uint32_t sub_bucket_bits = 5;
+  static constexpr uint32_t linear_limit = 2u << sub_bucket_bits; // values below get exact buckets
+  static constexpr uint32_t bucket_count = linear_limit + ( 64 - sub_bucket_bits - 1 ) * ( 1u << sub_bucket_bits );
+
+  static uint32_t bucket_index( uint64_t v )
+  {
+    if( v < linear_limit )
+      return uint32_t( v );
+    const uint32_t exponent = 63 - __builtin_clzll( v ); // >= sub_bucket_bits + 1
+    const uint32_t sub_bucket = uint32_t( v >> ( exponent - sub_bucket_bits ) ) & ( ( 1u << sub_bucket_bits ) - 1 );
+    return linear_limit + ( ( exponent - sub_bucket_bits - 1 ) << sub_bucket_bits ) + sub_bucket;
+  }
+
+  static uint64_t bucket_upper_bound( uint32_t index )
+  {
+    if( index < linear_limit )
+      return index;
+    const uint32_t exponent = ( ( index - linear_limit ) >> sub_bucket_bits ) + sub_bucket_bits + 1;
+    const uint64_t sub_bucket = ( index - linear_limit ) & ( ( 1u << sub_bucket_bits ) - 1 );
+    const uint64_t width = uint64_t( 1 ) << ( exponent - sub_bucket_bits );
+    return ( uint64_t( 1 ) << exponent ) + ( sub_bucket + 1 ) * width - 1;
+  }
+
+  mutable std::mutex                           _mutex;
+  std::array< uint64_t, bucket_count >         _buckets = {};
+  uint64_t                                     _count = 0;
+  uint64_t                                     _total = 0;
+  uint64_t                                     _max = 0;
+};
+
+/**
+ * Statistics collected in benchmark mode. Filled from pacemaker, writer, injector and synthetic API threads.
+ */
+struct benchmark_data
+{
+  latency_samples emission_delay; // how late (on pacemaker clock) blocks were emitted in relation to planned time
+  latency_samples block_wait; // time block spent in write queue
+  latency_samples block_apply; // time of work on block itself
+  latency_samples mempool_reapply; // time of reapplication of pending transactions after block
+  latency_samples write_lock_wait; // time writer thread waited to acquire write lock
+  latency_samples write_lock_hold; // time writer thread held write lock
+  latency_samples api_call; // time of synthetic API call, including waiting for read lock
+
+  std::atomic< uint32_t > blocks = 0;
+  std::atomic< uint32_t > failed_blocks = 0;
+  std::atomic< uint32_t > late_blocks = 0;
+  std::atomic< uint32_t > txs_injected = 0;
+  std::atomic< uint32_t > txs_injection_failed = 0;
+  std::atomic< uint32_t > txs_reapplied = 0;
+  std::atomic< uint32_t > txs_failed_reapply = 0;
+  std::atomic< uint32_t > txs_expired = 0;
+  std::atomic< uint32_t > txs_postponed = 0;
+  std::atomic< uint32_t > txs_dropped = 0;
+
+  uint32_t first_block = 0;
+  uint32_t last_block = 0;
+  fc::time_point start_time;
+};
+
 class pacemaker_plugin_impl
 {
 public:
@@ -33,6 +147,19 @@ public:
   block_emission_condition block_emission_loop();
   block_emission_condition maybe_emit_block();
 
+  void inject_transactions( const std::shared_ptr<full_block_type>& block );
+  void simulate_api_load();
+  void write_benchmark_report() const;
+
+  // current time on pacemaker clock - wall clock or virtual clock running _speed_up times faster
+  fc::time_point now() const
+  {
+    fc::time_point wall_now = fc::time_point::now();
+    if( _speed_up <= 0 )
+      return wall_now;
+    return _virtual_clock_start + fc::microseconds( int64_t( ( wall_now - _wall_clock_start ).count() * _speed_up ) );
+  }
+
   fc::time_point block_time() const { return _next_block->get_block_header().timestamp; }
   fc::time_point emission_time() const { return block_time() + fc::microseconds( _min_offset ); }
   fc::time_point failure_time() const { return block_time() + fc::microseconds( _max_offset ); }
@@ -48,20 +175,61 @@ public:
   int64_t                          _min_offset = 0;
   int64_t                          _max_offset = 0;
   int64_t                          _catch_up_offset = 0;
+  uint32_t                         _last_block_num = 0;
+
+  double                           _speed_up = 0; // 0 means block timestamps are compared with wall clock
+  fc::time_point                   _virtual_clock_start;
+  fc::time_point                   _wall_clock_start;
 
   std::shared_ptr<full_block_type> _next_block;
 
+  std::unique_ptr< benchmark_data > _benchmark;
+  fc::path                         _benchmark_report;
+  uint32_t                         _inject_ahead = 0;
+  uint32_t                         _last_injected_block_num = 0;
+  std::unique_ptr< fc::thread >    _injector;
+  uint32_t                         _api_threads = 0;
+  fc::microseconds                 _api_interval;
+  std::vector< std::thread >       _api_load;
+  std::atomic< bool >              _running = true;
+
   appbase::application& theApp;
 };
 
 class pacemaker_emit_block_flow_control : public p2p_block_flow_control
 {
 public:
-  using p2p_block_flow_control::p2p_block_flow_control;
+  pacemaker_emit_block_flow_control( const std::shared_ptr<full_block_type>& _block, uint32_t _skip, benchmark_data* _benchmark )
+    : p2p_block_flow_control( _block, _skip ), benchmark( _benchmark ) {}
   virtual ~pacemaker_emit_block_flow_control() = default;
 
+  virtual void on_worker_done( appbase::application& app ) const override
+  {
+    if( benchmark )
+    {
+      if( finished() )
+      {
+        benchmark->block_wait.add( stats.get_wait_time() );
+        benchmark->block_apply.add( stats.get_work_time() );
+        benchmark->mempool_reapply.add( stats.get_cleanup_time() );
+        benchmark->txs_reapplied += stats.get_txs_reapplied_after_block();
+        benchmark->txs_failed_reapply += stats.get_txs_failed_after_block();
+        benchmark->txs_expired += stats.get_txs_expired_after_block();
+        benchmark->txs_postponed += stats.get_txs_postponed_after_block();
+        benchmark->txs_dropped += stats.get_txs_dropped_after_block();
+      }
+      else
+      {
+        ++benchmark->failed_blocks;
+      }
+    }
+    p2p_block_flow_control::on_worker_done( app );
+  }
+
 private:
   virtual const char* buffer_type() const override { return "pacemaker"; }
+
+  benchmark_data* benchmark = nullptr;
 };
 
 class pacemaker_sync_block_flow_control final : public pacemaker_emit_block_flow_control
@@ -120,17 +288,17 @@ block_emission_condition pacemaker_plugin_impl::block_emission_loop()
         if( _catch_up_offset )
         {
           elog( "Pacemaker exit condition met: failed to emit block because node is not catching up. Now: ${n}; Block ts: ${t}; Last time to emit: ${f}",
-            ( "n", fc::time_point::now() )( "t", block_time() )( "f", catch_up_time() ) );
+            ( "n", now() )( "t", block_time() )( "f", catch_up_time() ) );
         }
         else
         {
           elog( "Pacemaker exit condition met: failed to emit block because max offset was exceeded. Now: ${n}; Block ts: ${t}; Last time to emit: ${f}",
-            ( "n", fc::time_point::now() )( "t", block_time() )( "f", failure_time() ) );
+            ( "n", now() )( "t", block_time() )( "f", failure_time() ) );
         }
         theApp.generate_interrupt_request();
         break;
       case block_emission_condition::no_more_blocks:
-        ilog( "Pacemaker exit condition met: no more blocks left in source." );
+        ilog( "Pacemaker exit condition met: no more blocks left to emit." );
         theApp.generate_interrupt_request();
         break;
       case block_emission_condition::exception_emitting_block:
@@ -150,10 +318,15 @@ block_emission_condition pacemaker_plugin_impl::block_emission_loop()
 
 block_emission_condition pacemaker_plugin_impl::maybe_emit_block()
 {
-  fc::time_point now = fc::time_point::now();
+  fc::time_point now = this->now();
   fc::time_point max_time = _catch_up_offset ? catch_up_time() : failure_time();
   if( now >= max_time )
-    return block_emission_condition::too_late;
+  {
+    // in benchmark mode node that can't keep up is a result to report, not a reason to stop
+    if( !_benchmark )
+      return block_emission_condition::too_late;
+    ++_benchmark->late_blocks;
+  }
   if( _catch_up_offset )
   {
     _catch_up_offset = ( now - block_time() ).count();
@@ -168,23 +341,134 @@ block_emission_condition pacemaker_plugin_impl::maybe_emit_block()
   if( now < earliest_emission_time )
     return block_emission_condition::too_early;
 
+  if( _benchmark )
+  {
+    _benchmark->emission_delay.add( now - earliest_emission_time );
+    ++_benchmark->blocks;
+  }
+
   std::shared_ptr< pacemaker_emit_block_flow_control > block_ctrl;
   if( _catch_up_offset )
-    block_ctrl = std::make_shared< pacemaker_sync_block_flow_control >( _next_block, database::skip_nothing );
+    block_ctrl = std::make_shared< pacemaker_sync_block_flow_control >( _next_block, database::skip_nothing, _benchmark.get() );
   else
-    block_ctrl = std::make_shared< pacemaker_emit_block_flow_control >( _next_block, database::skip_nothing );
+    block_ctrl = std::make_shared< pacemaker_emit_block_flow_control >( _next_block, database::skip_nothing, _benchmark.get() );
   _chain_plugin.accept_block( block_ctrl, false );
   _p2p_plugin.broadcast_block( _next_block );
 
-  _next_block = _source.read_block_by_num( _next_block->get_block_num() + 1 );
+  uint32_t block_num = _next_block->get_block_num();
+  if( _benchmark )
+    _benchmark->last_block = block_num;
+  if( _last_block_num != 0 && block_num >= _last_block_num )
+    return block_emission_condition::no_more_blocks;
+
+  _next_block = _source.read_block_by_num( block_num + 1 );
   if( _next_block.get() == nullptr )
     return block_emission_condition::no_more_blocks;
-  else if( emission_time() <= fc::time_point::now() ) //check if we could emit next block already
+
+  if( _injector )
+  {
+    for( ; _last_injected_block_num < block_num + _inject_ahead; ++_last_injected_block_num )
+    {
+      auto block = _source.read_block_by_num( _last_injected_block_num + 1 );
+      if( block.get() == nullptr || ( _last_block_num != 0 && block->get_block_num() > _last_block_num ) )
+        break;
+      _injector->async( [this, block]() { inject_transactions( block ); } );
+    }
+  }
+
+  if( emission_time() <= this->now() ) //check if we could emit next block already
     return block_emission_condition::lag;
   else
     return block_emission_condition::normal;
 }
 
+void pacemaker_plugin_impl::inject_transactions( const std::shared_ptr<full_block_type>& block )
+{
+  // transactions are pushed to mempool before their block is emitted, so when it arrives they are already
+  // pending and have to be handled by pending transactions restorer
+  for( const auto& source_tx : block->get_full_transactions() )
+  {
+    if( !_running.load( std::memory_order_relaxed ) || theApp.is_interrupt_request() )
+      return;
+
+    // separate object, so the one included in block keeps its own state
+    auto full_tx = full_transaction_type::create_from_signed_transaction( source_tx->get_transaction(),
+      source_tx->is_legacy_pack() ? serialization_type::legacy : serialization_type::hf26, false );
+    try
+    {
+      _chain_plugin.accept_transaction( full_tx, plugins::chain::chain_plugin::lock_type::fc );
+      ++_benchmark->txs_injected;
+    }
+    catch( const fc::canceled_exception& )
+    {
+      return;
+    }
+    catch( const fc::exception& e )
+    {
+      // f.e. transaction that was already included in block, because injector fell behind
+      dlog( "Failed to inject transaction ${id} from block #${b}: ${e}",
+        ( "id", full_tx->get_transaction_id() )( "b", block->get_block_num() )( "e", e.to_string() ) );
+      ++_benchmark->txs_injection_failed;
+    }
+  }
+}
+
+void pacemaker_plugin_impl::simulate_api_load()
+{
+  // imitates typical cheap API call (like condenser_api.get_dynamic_global_properties combined with
+  // lookup of active witnesses) competing for access to state with writer thread
+  while( _running.load( std::memory_order_relaxed ) && !theApp.is_interrupt_request() )
+  {
+    fc::time_point start = fc::time_point::now();
+    _db.with_read_lock( [&]()
+    {
+      const auto& dgpo = _db.get_dynamic_global_properties();
+      _db.find_account( dgpo.current_witness );
+      const auto& idx = _db.get_index< witness_index, by_vote_name >();
+      uint32_t count = 0;
+      for( auto itr = idx.begin(); itr != idx.end() && count < HIVE_MAX_WITNESSES; ++itr, ++count )
+        _db.find_account( itr->owner );
+    } );
+    _benchmark->api_call.add( fc::time_point::now() - start );
+    std::this_thread::sleep_for( std::chrono::microseconds( _api_interval.count() ) );
+  }
+}
+
+void pacemaker_plugin_impl::write_benchmark_report() const
+{
+  fc::mutable_variant_object transactions;
+  transactions
+    ( "injected", _benchmark->txs_injected.load() )
+    ( "injection_failed", _benchmark->txs_injection_failed.load() )
+    ( "reapplied", _benchmark->txs_reapplied.load() )
+    ( "failed_reapply", _benchmark->txs_failed_reapply.load() )
+    ( "expired", _benchmark->txs_expired.load() )
+    ( "postponed", _benchmark->txs_postponed.load() )
+    ( "dropped", _benchmark->txs_dropped.load() );
+
+  fc::mutable_variant_object report;
+  report
+    ( "first_block", _benchmark->first_block )
+    ( "last_block", _benchmark->last_block )
+    ( "blocks", _benchmark->blocks.load() )
+    ( "failed_blocks", _benchmark->failed_blocks.load() )
+    ( "late_blocks", _benchmark->late_blocks.load() )
+    ( "speed_up", _speed_up )
+    ( "wall_time_us", ( fc::time_point::now() - _benchmark->start_time ).count() )
+    ( "emission_delay", _benchmark->emission_delay.get_report() )
+    ( "block_wait", _benchmark->block_wait.get_report() )
+    ( "block_apply", _benchmark->block_apply.get_report() )
+    ( "mempool_reapply", _benchmark->mempool_reapply.get_report() )
+    ( "write_lock_wait", _benchmark->write_lock_wait.get_report() )
+    ( "write_lock_hold", _benchmark->write_lock_hold.get_report() )
+    ( "api_call", _benchmark->api_call.get_report() )
+    ( "transactions", transactions );
+
+  fc::json::save_to_file( fc::variant( report ), _benchmark_report );
+  ilog( "Pacemaker benchmark report for blocks #${f}-#${l} written to ${p}",
+    ( "f", _benchmark->first_block )( "l", _benchmark->last_block )( "p", _benchmark_report ) );
+}
+
 } // detail
 
 pacemaker_plugin::pacemaker_plugin() {}
@@ -198,6 +482,12 @@ void pacemaker_plugin::set_program_options(
     ( "pacemaker-source", bpo::value<bfs::path>(), "path to block_log file - source of block emissions" )
     ( "pacemaker-min-offset", bpo::value<int>()->default_value( -300 ), "minimum time of emission offset from block timestamp in milliseconds, default -300ms" )
     ( "pacemaker-max-offset", bpo::value<int>()->default_value( 20000 ), "maximum time of emission offset from block timestamp in milliseconds, default 20000ms (when exceeded, node will be stopped)" )
+    ( "pacemaker-last-block", bpo::value<uint32_t>()->default_value( 0 ), "last block to emit, node is stopped after it (0 means emission continues until end of source)" )
+    ( "pacemaker-speed-up", bpo::value<double>()->default_value( 0 ), "when nonzero, blocks are emitted according to virtual clock that starts at timestamp of first emitted block and runs given times faster than wall clock (1 replays historical blocks at original pace); 0 means block timestamps are compared with wall clock" )
+    ( "pacemaker-benchmark-report", bpo::value<bfs::path>(), "enables benchmark mode: statistics of block processing, write lock, mempool and API calls are written to given JSON file at shutdown; node that can't keep up with emission is not stopped" )
+    ( "pacemaker-inject-ahead", bpo::value<uint32_t>()->default_value( 0 ), "benchmark mode: number of blocks ahead of emission whose transactions are pushed to mempool before their block (0 means no injection)" )
+    ( "pacemaker-api-threads", bpo::value<uint32_t>()->default_value( 0 ), "benchmark mode: number of threads making synthetic API calls concurrently with block emission" )
+    ( "pacemaker-api-interval", bpo::value<uint32_t>()->default_value( 10 ), "benchmark mode: pause between synthetic API calls of each thread in milliseconds" )
     ;
 }
 
@@ -223,6 +513,36 @@ void pacemaker_plugin::plugin_initialize( const boost::program_options::variable
   my->_max_offset = options.at( "pacemaker-max-offset" ).as< int >() * 1000;
   FC_ASSERT( my->_max_offset > std::min( my->_min_offset, 0l ), "pacemaker-max-offset needs to be positive value greater than pacemaker-min-offset" );
 
+  my->_last_block_num = options.at( "pacemaker-last-block" ).as< uint32_t >();
+  my->_speed_up = options.at( "pacemaker-speed-up" ).as< double >();
+  FC_ASSERT( my->_speed_up >= 0, "pacemaker-speed-up can't be negative" );
+
+  if( options.count( "pacemaker-benchmark-report" ) )
+  {
+    auto rp = options.at( "pacemaker-benchmark-report" ).as<bfs::path>();
+    if( rp.is_relative() )
+      my->_benchmark_report = get_app().data_dir() / rp;
+    else
+      my->_benchmark_report = rp;
+    my->_benchmark = std::make_unique< detail::benchmark_data >();
+    my->_inject_ahead = options.at( "pacemaker-inject-ahead" ).as< uint32_t >();
+    my->_api_threads = options.at( "pacemaker-api-threads" ).as< uint32_t >();
+    my->_api_interval = fc::milliseconds( options.at( "pacemaker-api-interval" ).as< uint32_t >() );
+
+    auto* benchmark = my->_benchmark.get();
+    my->_chain_plugin.set_write_lock_stats_handler( [benchmark]( const fc::microseconds& acquisition_time,
+      const fc::microseconds& hold_time, uint32_t )
+    {
+      benchmark->write_lock_wait.add( acquisition_time );
+      benchmark->write_lock_hold.add( hold_time );
+    } );
+  }
+  else
+  {
+    FC_ASSERT( options.at( "pacemaker-inject-ahead" ).as< uint32_t >() == 0 && options.at( "pacemaker-api-threads" ).as< uint32_t >() == 0,
+      "pacemaker-inject-ahead and pacemaker-api-threads require pacemaker-benchmark-report" );
+  }
+
   //allow up to 1/3 of the block interval for emitting blocks (2x a normal node)
   my->_chain_plugin.set_write_lock_hold_time( HIVE_BLOCK_INTERVAL * 1000 / 3 ); // units = milliseconds
 
@@ -244,7 +564,16 @@ void pacemaker_plugin::plugin_startup()
   my->_next_block = my->_source.read_block_by_num( nextBlock );
   FC_ASSERT( my->_next_block.get() != nullptr, "No block #${n} in data source.", ( "n", nextBlock ) );
 
-  auto now = fc::time_point::now();
+  if( my->_speed_up > 0 )
+  {
+    // start virtual clock so the first block can be emitted right away
+    my->_wall_clock_start = fc::time_point::now();
+    my->_virtual_clock_start = my->emission_time();
+    ilog( "Pacemaker clock starts at ${t} and runs ${s} times faster than wall clock",
+      ( "t", my->_virtual_clock_start )( "s", my->_speed_up ) );
+  }
+
+  auto now = my->now();
   auto max_time = my->failure_time();
   auto block_time = my->block_time();
   if( now >= max_time )
@@ -263,6 +592,34 @@ void pacemaker_plugin::plugin_startup()
       ( "b", nextBlock )( "t", block_time )( now ) );
   }
 
+  if( my->_benchmark )
+  {
+    my->_benchmark->first_block = nextBlock;
+    my->_benchmark->start_time = fc::time_point::now();
+
+    if( my->_inject_ahead > 0 )
+    {
+      my->_injector = std::make_unique< fc::thread >( "pacemaker_injector" );
+      my->_last_injected_block_num = my->_db.head_block_num();
+      for( ; my->_last_injected_block_num < my->_db.head_block_num() + my->_inject_ahead; ++my->_last_injected_block_num )
+      {
+        auto block = my->_source.read_block_by_num( my->_last_injected_block_num + 1 );
+        if( block.get() == nullptr )
+          break;
+        my->_injector->async( [impl = my.get(), block]() { impl->inject_transactions( block ); } );
+      }
+    }
+
+    for( uint32_t i = 0; i < my->_api_threads; ++i )
+    {
+      my->_api_load.emplace_back( [impl = my.get(), i]()
+      {
+        fc::set_thread_name( ( "pacemaker_api_" + std::to_string( i ) ).c_str() );
+        impl->simulate_api_load();
+      } );
+    }
+  }
+
   my->schedule_emission_loop();
 
   ilog("pacemaker plugin: plugin_startup() end");
@@ -273,6 +630,15 @@ void pacemaker_plugin::plugin_shutdown()
   try
   {
     my->_timer.cancel();
+    my->_running.store( false );
+    for( auto& thread : my->_api_load )
+      thread.join();
+    my->_api_load.clear();
+    // pending injection tasks return early once _running is cleared; destruction of the thread waits for them,
+    // so the report below is not written while transactions are still being injected
+    my->_injector.reset();
+    if( my->_benchmark )
+      my->write_benchmark_report();
   }
   catch( fc::exception& e )
   {
@@ -453,9 +453,10 @@ class index_dump_writer final : public snapshot_processor_data<chainbase::snapsh
 class index_dump_reader final : public snapshot_processor_data<chainbase::snapshot_reader>
   {
   public:
-    index_dump_reader(const snapshot_manifest& snapshotManifest, const bfs::path& rootPath) :
+    /// max_threads limits the loading-workers of this index running at once (1 loads files sequentially in the calling thread).
+    index_dump_reader(const snapshot_manifest& snapshotManifest, const bfs::path& rootPath, size_t max_threads) :
       snapshot_processor_data<chainbase::snapshot_reader>(rootPath),
-      _snapshotManifest(snapshotManifest), currentWorker(nullptr) {}
+      _snapshotManifest(snapshotManifest), currentWorker(nullptr), _max_threads(max_threads) {}
 
     index_dump_reader(const index_dump_reader&) = delete;
     index_dump_reader& operator=(const index_dump_reader&) = delete;
@@ -471,6 +472,7 @@ class index_dump_reader final : public snapshot_processor_data<chainbase::snapsh
     const snapshot_manifest& _snapshotManifest;
     std::vector <std::unique_ptr<loading_worker>> _builtWorkers;
     const loading_worker* currentWorker;
+    size_t _max_threads;
   };
 
 class dumping_worker final : public chainbase::snapshot_writer::worker
@@ -737,12 +739,14 @@ void index_dump_writer::store_index_manifest(index_manifest_info* manifest) cons
   ilog("Saved manifest for index: '${d}' containing ${s} items and ${n} saved as next_id", ("d", _indexDescription)("s", manifest->dumpedItems)("n", manifest->indexNextId));
   }
 
+/// Loads objects stored in single SST file of the index snapshot. Workers processing given index can run concurrently.
 class loading_worker final : public chainbase::snapshot_reader::worker
   {
   public:
-    loading_worker(const index_manifest_info& manifestInfo, const bfs::path& inputPath, index_dump_reader& reader) :
+    loading_worker(const index_manifest_info& manifestInfo, const index_manifest_file_info& fileInfo, const bfs::path& inputPath,
+      index_dump_reader& reader) :
       chainbase::snapshot_reader::worker(reader, 0, 0),
-      _manifestInfo(manifestInfo), _controller(reader), _inputPath(inputPath), _load_finished(false)
+      _manifestInfo(manifestInfo), _fileInfo(fileInfo), _controller(reader), _inputPath(inputPath)
       {
       _startId = manifestInfo.firstId;
       _endId = manifestInfo.lastId;
@@ -750,7 +754,7 @@ class loading_worker final : public chainbase::snapshot_reader::worker
 
     virtual ~loading_worker() = default;
 
-    virtual void load_converted_data(worker_common_base::serialized_object_cache* cache) override;
+    virtual size_t visit_converted_data(size_t maxCount, const serialized_object_visitor& visitor) override;
     virtual std::string prettifyObject(const fc::variant& object, const std::vector<char>& buffer) const override
     {
       std::string s;
@@ -766,83 +770,99 @@ class loading_worker final : public chainbase::snapshot_reader::worker
 
     void perform_load();
 
+    /// Used when workers run in the thread pool - holds exception thrown by perform_load to be rethrown by the controller.
+    void safe_perform_load();
+
+    const std::exception_ptr& get_load_failure() const
+      {
+      return _load_failure;
+      }
+
   private:
     const index_manifest_info& _manifestInfo;
+    const index_manifest_file_info& _fileInfo;
     index_dump_reader& _controller;
     bfs::path _inputPath;
     std::unique_ptr<::rocksdb::SstFileReader> _reader;
     std::unique_ptr<::rocksdb::Iterator> _entryIt;
-    bool _load_finished;
+    std::exception_ptr _load_failure;
   };
 
-void loading_worker::load_converted_data(worker_common_base::serialized_object_cache* cache)
+size_t loading_worker::visit_converted_data(size_t maxCount, const serialized_object_visitor& visitor)
   {
   FC_ASSERT(_entryIt);
 
-  const size_t maxSize = get_serialized_object_cache_max_size();
-  cache->reserve(maxSize);
-  for(size_t n = 0; _entryIt->Valid() && n < maxSize; _entryIt->Next(), ++n)
+  size_t n = 0;
+  size_t b = 0;
+  size_t e = 0;
+
+  for(; _entryIt->Valid() && n < maxCount; _entryIt->Next(), ++n)
     {
     auto key = _entryIt->key();
     auto value = _entryIt->value();
 
-    const size_t* keyId = reinterpret_cast<const size_t*>(key.data());
     FC_ASSERT(sizeof(size_t) == key.size());
+    size_t keyId = 0;
+    memcpy(&keyId, key.data(), sizeof(size_t));
 
-    cache->emplace_back(*keyId, std::vector<char>());
-    cache->back().second.insert(cache->back().second.end(), value.data(), value.data() + value.size());
-    }
+    if(n == 0)
+      b = keyId;
+    e = keyId;
 
-  if(cache->empty())
-    {
-    ilog("No objects loaded from storage for index: `${i}'", ("i", _manifestInfo.name));
+    visitor(keyId, value.data(), value.size());
     }
-  else
-    {
-    size_t b = cache->front().first;
-    size_t e = cache->back().first;
 
+  FC_ASSERT(_entryIt->status().ok(), "Error reading SST file for index: `${i}'. Error details: `${e}'.",
+    ("i", _manifestInfo.name)("e", _entryIt->status().ToString()));
+
+  if(n != 0)
     ilog("Loaded objects from range <${b}, ${e}> for index: `${i}'", ("b", b)("e", e)("i", _manifestInfo.name));
-    }
+
+  return n;
   }
 
 void loading_worker::perform_load()
   {
-  if(_manifestInfo.dumpedItems == 0)
+  _reader = std::make_unique< ::rocksdb::SstFileReader>(_controller.get_storage_config());
+
+  bfs::path sstFilePath(_inputPath);
+  sstFilePath /= _fileInfo.relative_path;
+
+  auto status = _reader->Open(sstFilePath.string());
+  if(status.ok())
     {
-    ilog("Snapshot data contains empty-set stored for index: `${i}.", ("i", _manifestInfo.name));
-    return;
+    ilog("Successfully opened index SST file at path: `${p}'", ("p", sstFilePath.string()));
     }
-
-  for(const auto& fileInfo : _manifestInfo.storage_files)
+  else
     {
-    _reader = std::make_unique< ::rocksdb::SstFileReader>(_controller.get_storage_config());
-    
-    bfs::path sstFilePath(_inputPath);
-    sstFilePath /= fileInfo.relative_path;
-    
-    auto status = _reader->Open(sstFilePath.string());
-    if(status.ok())
-      {
-      ilog("Successfully opened index SST file at path: `${p}'", ("p", sstFilePath.string()));
-      }
-    else
-      {
-      elog("Cannot open snapshot index SST file at path: `${p}'. Error details: `${e}'.", ("p", sstFilePath.string())("e", status.ToString()));
-      throw std::exception();
-      }
+    elog("Cannot open snapshot index SST file at path: `${p}'. Error details: `${e}'.", ("p", sstFilePath.string())("e", status.ToString()));
+    throw std::exception();
+    }
 
-    ::rocksdb::ReadOptions rOptions;
-    _entryIt.reset(_reader->NewIterator(rOptions));
-    _entryIt->SeekToFirst();
+  ::rocksdb::ReadOptions rOptions;
+  /// Data is read exactly once, so there is no point to pollute block cache
+  rOptions.fill_cache = false;
+  _entryIt.reset(_reader->NewIterator(rOptions));
+  _entryIt->SeekToFirst();
 
-    auto converter = _controller.get_converter();
-    converter(this);
+  auto converter = _controller.get_converter();
+  converter(this);
+
+  _entryIt.reset();
+  _reader.reset();
 
-    _entryIt.reset();
-    _reader.reset();
+  ilog("Finished processing of SST file at path: `${p}'", ("p", sstFilePath.string()));
+  }
 
-    ilog("Finished processing of SST file at path: `${p}'", ("p", sstFilePath.string()));
+void loading_worker::safe_perform_load()
+  {
+  try
+    {
+    perform_load();
+    }
+  catch(...)
+    {
+    _load_failure = std::current_exception();
     }
   }
 
@@ -866,10 +886,21 @@ index_dump_reader::prepare(const std::string& indexDescription, snapshot_convert
 
   *snapshot_index_next_id = manifestInfo.indexNextId;
 
-  _builtWorkers.emplace_back(std::make_unique<loading_worker>(manifestInfo, _rootPath, *this));
+  if(manifestInfo.dumpedItems == 0)
+    {
+    ilog("Snapshot data contains empty-set stored for index: `${i}.", ("i", manifestInfo.name));
+    return workers();
+    }
 
   workers retVal;
-  retVal.emplace_back(_builtWorkers.front().get());
+
+  for(const auto& fileInfo : manifestInfo.storage_files)
+    {
+    _builtWorkers.emplace_back(std::make_unique<loading_worker>(manifestInfo, fileInfo, _rootPath, *this));
+    retVal.emplace_back(_builtWorkers.back().get());
+    }
+
+  ilog("Prepared ${n} workers to load index holding `${d}' items.", ("d", indexDescription)("n", retVal.size()));
 
   return retVal;
   }
@@ -878,18 +909,55 @@ void index_dump_reader::start(const workers& workers)
   {
   FC_ASSERT(_builtWorkers.size() == workers.size());
 
-  for(size_t i = 0; i < _builtWorkers.size(); ++i)
+  const size_t num_threads = std::min(workers.size(), _max_threads);
+
+  if(num_threads > 1)
     {
-    loading_worker* w = _builtWorkers[i].get();
-    FC_ASSERT(w == workers[i]);
-    currentWorker = w;
-    w->perform_load();
+    boost::asio::io_service ioService;
+    boost::thread_group threadpool;
+    std::unique_ptr<boost::asio::io_service::work> work = std::make_unique<boost::asio::io_service::work>(ioService);
+
+    for(unsigned int i = 0; i < num_threads; ++i)
+      threadpool.create_thread(boost::bind(&boost::asio::io_service::run, &ioService));
+
+    for(size_t i = 0; i < _builtWorkers.size(); ++i)
+      {
+      loading_worker* w = _builtWorkers[i].get();
+      FC_ASSERT(w == workers[i]);
+
+      ioService.post(boost::bind(&loading_worker::safe_perform_load, w));
+      }
+
+    ilog("Waiting for loading-workers jobs completion");
+
+    work.reset();
+
+    threadpool.join_all();
+
+    for(const auto& w : _builtWorkers)
+      {
+      if(w->get_load_failure())
+        {
+        currentWorker = w.get();
+        std::rethrow_exception(w->get_load_failure());
+        }
+      }
+    }
+  else
+    {
+    for(size_t i = 0; i < _builtWorkers.size(); ++i)
+      {
+      loading_worker* w = _builtWorkers[i].get();
+      FC_ASSERT(w == workers[i]);
+      currentWorker = w;
+      w->perform_load();
+      }
     }
   }
 
 size_t index_dump_reader::getCurrentlyProcessedId() const
   {
-  return currentWorker->getProcessedId();
+  return currentWorker != nullptr ? currentWorker->getProcessedId() : 0;
   }
 
 } /// namespace anonymous
@@ -1679,18 +1747,23 @@ void state_snapshot_plugin::impl::load_snapshot_impl(const std::string& snapshot
 
   if (_num_threads > 1)
   {
+    /// Each reader runs its own loading-workers (every one holding a batch of decoded objects), so split the thread budget
+    /// between the readers running at once instead of multiplying it.
+    const size_t readerThreads = std::min<size_t>(_num_threads, indices.size());
+    const size_t workerThreads = std::max<size_t>(1, _num_threads / std::max<size_t>(1, readerThreads));
+
     boost::asio::io_service ioService;
     boost::thread_group threadpool;
     std::unique_ptr<boost::asio::io_service::work> work = std::make_unique<boost::asio::io_service::work>(ioService);
 
-    for(unsigned int i = 0; i < _num_threads; ++i)
+    for(unsigned int i = 0; i < readerThreads; ++i)
       threadpool.create_thread(boost::bind(&boost::asio::io_service::run, &ioService));
 
     std::vector<std::unique_ptr< index_dump_reader>> builtReaders;
 
     for(chainbase::abstract_index* idx : indices)
     {
-      builtReaders.emplace_back(std::make_unique<index_dump_reader>(std::get<0>(snapshotManifest), actualStoragePath));
+      builtReaders.emplace_back(std::make_unique<index_dump_reader>(std::get<0>(snapshotManifest), actualStoragePath, workerThreads));
       index_dump_reader* reader = builtReaders.back().get();
       ioService.post(boost::bind(&impl::safe_spawn_snapshot_load, this, idx, reader));
     }
@@ -1703,7 +1776,7 @@ void state_snapshot_plugin::impl::load_snapshot_impl(const std::string& snapshot
   {
     for(chainbase::abstract_index* idx : indices)
     {
-      std::unique_ptr< index_dump_reader> reader = std::make_unique<index_dump_reader>(std::get<0>(snapshotManifest), actualStoragePath);
+      std::unique_ptr< index_dump_reader> reader = std::make_unique<index_dump_reader>(std::get<0>(snapshotManifest), actualStoragePath, 1 /* max_threads */);
       safe_spawn_snapshot_load(idx, reader.get());
     }
   }
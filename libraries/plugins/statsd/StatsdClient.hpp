@@ -84,6 +84,10 @@ public:
   void send(const std::string &key, const int value, const std::string &type, const float frequency = 1.0f) const
     noexcept;
 
+  //! Send a value that represents given number of samples aggregated locally (no sampling is performed)
+  void sendAggregated(const std::string &key, const int value, const std::string &type, const uint64_t samples) const
+    noexcept;
+
   //!@}
 
 private:
@@ -161,6 +165,20 @@ void StatsdClient::send(const std::string &key, const int value, const std::stri
   m_sender.send(buffer);
 }
 
+void StatsdClient::sendAggregated(const std::string &key, const int value, const std::string &type, const uint64_t samples) const
+  noexcept {
+  char buffer[256];
+  if (samples <= 1) {
+    std::snprintf(buffer, sizeof(buffer), "%s%s:%d|%s", m_prefix.c_str(), key.c_str(), value, type.c_str());
+  } else {
+    // Sampling rate of 1/samples tells the daemon that the value stands for that many samples
+    std::snprintf(
+      buffer, sizeof(buffer), "%s%s:%d|%s|@%g", m_prefix.c_str(), key.c_str(), value, type.c_str(), 1.0 / samples);
+  }
+
+  m_sender.send(buffer);
+}
+
 }  // namespace Statsd
 
 #endif
@@ -2,8 +2,12 @@
 #include <chainbase/forward_declarations.hpp>
 #include <appbase/application.hpp>
 
+#include <fc/reflect/reflect.hpp>
+
 #include <boost/config.hpp>
 
+#include <limits>
+
 #define HIVE_STATSD_PLUGIN_NAME "statsd"
 
 namespace hive { namespace plugins { namespace statsd {
@@ -15,6 +19,25 @@ namespace detail
   class statsd_plugin_impl;
 }
 
+enum class metric_type : uint8_t
+{
+  counter,
+  gauge,
+  timing
+};
+
+typedef uint32_t metric_id;
+constexpr metric_id invalid_metric_id = std::numeric_limits< metric_id >::max();
+
+/// totals of a metric collected since the plugin started
+struct aggregated_metric
+{
+  std::string name;
+  metric_type type = metric_type::counter;
+  uint64_t    count = 0; ///< number of recorded values
+  int64_t     value = 0; ///< sum of values (counter, timing in ms) or last value (gauge)
+};
+
 class statsd_plugin : public appbase::plugin< statsd_plugin >
 {
   public:
@@ -40,8 +63,26 @@ class statsd_plugin : public appbase::plugin< statsd_plugin >
     void gauge(     const std::string& ns, const std::string& stat, const std::string& key, const uint64_t value, const float frequency = 1.0f ) const noexcept;
     void timing(    const std::string& ns, const std::string& stat, const std::string& key, const uint32_t ms,    const float frequency = 1.0f ) const noexcept;
 
+    /**
+      * Resolves metric to id that can be used to record values without building its name. Returns invalid_metric_id
+      * for metrics excluded with whitelist/blacklist. Ids of the same metric are stable for the lifetime of the plugin.
+      */
+    metric_id register_metric( const std::string& ns, const std::string& stat, const std::string& key, metric_type type ) const noexcept;
+    /// Unique within the process (unlike address of the plugin), so ids cached outside of the plugin can be tied to it.
+    uint64_t get_instance_id() const noexcept;
+
+    // Values recorded with ids are aggregated per thread and sent to statsd periodically by background thread
+    void count(  metric_id id, const int64_t delta  ) const noexcept;
+    void gauge(  metric_id id, const uint64_t value ) const noexcept;
+    void timing( metric_id id, const uint32_t ms    ) const noexcept;
+
+    std::vector< aggregated_metric > get_metrics() const;
+
   private:
     std::unique_ptr< detail::statsd_plugin_impl > my;
 };
 
 } } } // hive::plugins::statsd
+
+FC_REFLECT_ENUM( hive::plugins::statsd::metric_type, (counter)(gauge)(timing) )
+FC_REFLECT( hive::plugins::statsd::aggregated_metric, (name)(type)(count)(value) )
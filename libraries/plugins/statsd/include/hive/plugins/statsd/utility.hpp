@@ -4,6 +4,8 @@
 #include <fc/optional.hpp>
 #include <fc/time.hpp>
 
+#include <atomic>
+
 namespace hive { namespace plugins { namespace statsd { namespace util {
 
 using hive::plugins::statsd::statsd_plugin;
@@ -11,14 +13,98 @@ using hive::plugins::statsd::statsd_plugin;
 bool statsd_enabled( appbase::application& app );
 const statsd_plugin& get_statsd( appbase::application& app );
 
+/**
+  * Caches ids of metrics used at given call site (see STATSD_* macros), so their names are only composed on first use.
+  * Site can be reached from many threads with different keys (f.e. name of webserver lane), so each key is cached in
+  * its own immutable entry of lock-free list. Keys passed as pointers have to stay valid and unchanged (literals or
+  * names of long lived objects); number of cached keys is limited, others are resolved on each call, just like keys
+  * that are not string literals.
+  * Ids are only valid for plugin that issued them, while site is shared by all applications in the process (f.e. in
+  * tests), so cached ids are kept in list tied to plugin instance; when other instance reaches the site, new list is
+  * started. Lists of previous instances can still be read by other threads, so they are only freed with the site.
+  */
+class metric_site
+{
+  public:
+    static constexpr uint32_t max_cached_keys = 16;
+
+    ~metric_site()
+    {
+      delete _list.load( std::memory_order_acquire );
+    }
+
+    metric_id get( const statsd_plugin& statsd, const char* ns, const char* stat, const char* key, metric_type type )
+    {
+      entry_list* list = get_list( statsd.get_instance_id() );
+      for( const entry* e = list->entries.load( std::memory_order_acquire ); e != nullptr; e = e->next )
+        if( e->key == key )
+          return e->id;
+
+      metric_id id = statsd.register_metric( ns, stat, key, type );
+      if( list->cached_keys.fetch_add( 1, std::memory_order_relaxed ) < max_cached_keys )
+      {
+        // concurrent callers might both add the same key - harmless, since both entries hold the same id
+        entry* e = new entry{ key, id, list->entries.load( std::memory_order_relaxed ) };
+        while( !list->entries.compare_exchange_weak( e->next, e, std::memory_order_release, std::memory_order_relaxed ) );
+      }
+      return id;
+    }
+
+    metric_id get( const statsd_plugin& statsd, const char* ns, const char* stat, const std::string& key, metric_type type )
+    {
+      return statsd.register_metric( ns, stat, key, type );
+    }
+
+  private:
+    struct entry
+    {
+      const char*   key;
+      metric_id     id;
+      const entry*  next;
+    };
+
+    struct entry_list
+    {
+      entry_list( uint64_t _instance, entry_list* _retired ) : instance( _instance ), retired( _retired ) {}
+      ~entry_list()
+      {
+        for( const entry* e = entries.load( std::memory_order_acquire ); e != nullptr; )
+        {
+          const entry* next = e->next;
+          delete e;
+          e = next;
+        }
+        delete retired;
+      }
+
+      const uint64_t              instance;
+      entry_list*                 retired; ///< list of previous plugin instance
+      std::atomic< const entry* > entries = { nullptr };
+      std::atomic< uint32_t >     cached_keys = { 0 };
+    };
+
+    entry_list* get_list( uint64_t instance )
+    {
+      entry_list* list = _list.load( std::memory_order_acquire );
+      while( list == nullptr || list->instance != instance )
+      {
+        entry_list* fresh = new entry_list( instance, list );
+        if( _list.compare_exchange_strong( list, fresh, std::memory_order_acq_rel, std::memory_order_acquire ) )
+          return fresh;
+        fresh->retired = nullptr;
+        delete fresh;
+      }
+      return list;
+    }
+
+    std::atomic< entry_list* >  _list = { nullptr };
+};
+
 class statsd_timer_helper
 {
   public:
-    statsd_timer_helper( const std::string& ns, const std::string& stat, const std::string& key, float freq, const statsd_plugin& statsd ) :
-      _ns( ns ),
-      _stat( stat ),
-      _key( key ),
-      _freq( freq ),
+    statsd_timer_helper( metric_id id, const statsd_plugin& statsd ) :
+      _id( id ),
       _statsd( statsd )
     {
       _start = fc::time_point::now();
@@ -34,16 +120,13 @@ class statsd_timer_helper
       fc::time_point stop = fc::time_point::now();
       if( !_recorded )
       {
-        _statsd.timing( _ns, _stat, _key, (stop - _start).count() / 1000 , _freq );
+        _statsd.timing( _id, (stop - _start).count() / 1000 );
         _recorded = true;
       }
     }
 
   private:
-    std::string          _ns;
-    std::string          _stat;
-    std::string          _key;
-    float                _freq = 1.0f;
+    metric_id            _id = invalid_metric_id;
     fc::time_point       _start;
     const statsd_plugin& _statsd;
     bool                 _recorded = false;
@@ -56,36 +139,40 @@ inline uint32_t timing_helper( uint32_t time ) { return time; }
 
 } } } } // hive::plugins::statsd::util
 
+// FREQ is kept for compatibility - values are aggregated in process, so all of them are recorded
+
+#define STATSD_METRIC_ID( NAMESPACE, STAT, KEY, TYPE, STATSD )                                 \
+  ( [&]() -> hive::plugins::statsd::metric_id {                                               \
+    static hive::plugins::statsd::util::metric_site site;                                     \
+    return site.get( STATSD, NAMESPACE, STAT, KEY, hive::plugins::statsd::metric_type::TYPE ); \
+  }() )
+
 #define STATSD_INCREMENT( NAMESPACE, STAT, KEY, FREQ, APP )   \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 {                                                        \
-  hive::plugins::statsd::util::get_statsd( APP ).increment( \
-    NAMESPACE, STAT, KEY, FREQ                         \
-  );                                                    \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP ); \
+  statsd.count( STATSD_METRIC_ID( NAMESPACE, STAT, KEY, counter, statsd ), 1 ); \
 }
 
 #define STATSD_DECREMENT( NAMESPACE, STAT, KEY, FREQ, APP )   \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 {                                                        \
-  hive::plugins::statsd::util::get_statsd( APP ).decrement( \
-    NAMESPACE, STAT, KEY, FREQ                         \
-  );                                                    \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP ); \
+  statsd.count( STATSD_METRIC_ID( NAMESPACE, STAT, KEY, counter, statsd ), -1 ); \
 }
 
 #define STATSD_COUNT( NAMESPACE, STAT, KEY, VAL, FREQ, APP )  \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 {                                                        \
-  hive::plugins::statsd::util::get_statsd( APP ).count(     \
-    NAMESPACE, STAT, KEY, VAL, FREQ                    \
-  );                                                    \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP ); \
+  statsd.count( STATSD_METRIC_ID( NAMESPACE, STAT, KEY, counter, statsd ), VAL ); \
 }
 
 #define STATSD_GAUGE( NAMESPACE, STAT, KEY, VAL, FREQ, APP )  \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 {                                                        \
-  hive::plugins::statsd::util::get_statsd( APP ).gauge(     \
-    NAMESPACE, STAT, KEY, VAL, FREQ                    \
-  );                                                    \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP ); \
+  statsd.gauge( STATSD_METRIC_ID( NAMESPACE, STAT, KEY, gauge, statsd ), VAL ); \
 }
 
 // You can only have one statsd timer in the current scope at a time
@@ -93,9 +180,9 @@ if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 fc::optional< hive::plugins::statsd::util::statsd_timer_helper > statsd_timer;  \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )                             \
 {                                                                                \
-  statsd_timer = hive::plugins::statsd::util::statsd_timer_helper(             \
-    NAMESPACE, STAT, KEY, FREQ, hive::plugins::statsd::util::get_statsd( APP )     \
-  );                                                                            \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP );             \
+  statsd_timer = hive::plugins::statsd::util::statsd_timer_helper(                \
+    STATSD_METRIC_ID( NAMESPACE, STAT, KEY, timing, statsd ), statsd );          \
 }
 
 #define STATSD_STOP_TIMER( NAMESPACE, STAT, KEY )        \
@@ -104,9 +191,7 @@ if( hive::plugins::statsd::util::statsd_enabled( APP ) )
 #define STATSD_TIMER( NAMESPACE, STAT, KEY, VAL, FREQ, APP )  \
 if( hive::plugins::statsd::util::statsd_enabled( APP ) )     \
 {                                                        \
-  hive::plugins::statsd::util::get_statsd( APP ).timing(    \
-    NAMESPACE, STAT, KEY,                              \
-    hive::plugins::statsd::util::timing_helper( VAL ),\
-    FREQ                                               \
-  );                                                    \
+  const auto& statsd = hive::plugins::statsd::util::get_statsd( APP ); \
+  statsd.timing( STATSD_METRIC_ID( NAMESPACE, STAT, KEY, timing, statsd ), \
+    hive::plugins::statsd::util::timing_helper( VAL ) ); \
 }
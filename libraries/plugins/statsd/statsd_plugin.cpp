@@ -1,11 +1,15 @@
 #include <hive/plugins/statsd/statsd_plugin.hpp>
 
 #include <fc/network/resolve.hpp>
-#include <fc/thread/thread.hpp>
 
 #include <boost/algorithm/string.hpp>
 
+#include <array>
+#include <condition_variable>
+#include <shared_mutex>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 
 #include "StatsdClient.hpp"
 
@@ -22,30 +26,129 @@ namespace detail
     return ss.str();
   }
 
+  /// timing histogram - bucket 0 holds 0ms, bucket i holds values from [2^(i-1), 2^i) ms, last one everything above
+  constexpr uint32_t timing_buckets = 24;
+
+  inline uint32_t timing_bucket( uint32_t ms )
+  {
+    uint32_t bucket = ms == 0 ? 0 : 32 - __builtin_clz( ms );
+    return std::min( bucket, timing_buckets - 1 );
+  }
+
+  /// value sent to statsd on behalf of all samples in given bucket (middle of the bucket)
+  inline uint32_t bucket_value( uint32_t bucket )
+  {
+    if( bucket <= 1 )
+      return bucket;
+    return ( 1u << ( bucket - 1 ) ) + ( 1u << ( bucket - 2 ) );
+  }
+
+  /**
+    * Array that grows in chunks without moving existing elements, so other threads can read them while new ones are
+    * added. New chunks are only allocated by single writer.
+    */
+  template< typename T >
+  class chunked_array
+  {
+    public:
+      static constexpr uint32_t chunk_size = 64;
+      static constexpr uint32_t max_chunks = 256;
+
+      ~chunked_array()
+      {
+        for( auto& chunk : _chunks )
+          delete[] chunk.load();
+      }
+
+      /// returns element or nullptr if it was not allocated yet
+      T* find( uint32_t idx ) const
+      {
+        if( idx >= chunk_size * max_chunks )
+          return nullptr;
+        T* chunk = _chunks[ idx / chunk_size ].load( std::memory_order_acquire );
+        return chunk == nullptr ? nullptr : chunk + idx % chunk_size;
+      }
+
+      /// returns element allocating it if needed (nullptr when index is out of range)
+      T* get( uint32_t idx )
+      {
+        if( idx >= chunk_size * max_chunks )
+          return nullptr;
+        auto& chunk_ptr = _chunks[ idx / chunk_size ];
+        T* chunk = chunk_ptr.load( std::memory_order_relaxed );
+        if( chunk == nullptr )
+        {
+          chunk = new T[ chunk_size ]();
+          chunk_ptr.store( chunk, std::memory_order_release );
+        }
+        return chunk + idx % chunk_size;
+      }
+
+    private:
+      std::array< std::atomic< T* >, max_chunks > _chunks = {};
+  };
+
+  struct metric_info
+  {
+    std::string             name;
+    metric_type             type = metric_type::counter;
+    std::atomic< uint64_t > gauge_updates = { 0 };
+    std::atomic< uint64_t > gauge_value = { 0 };
+  };
+
+  /// values recorded by one thread - only that thread writes them, so no read-modify-write atomics are needed
+  struct metric_slot
+  {
+    std::atomic< uint64_t > count = { 0 };
+    std::atomic< int64_t >  sum = { 0 };
+    std::atomic< uint64_t > buckets[ timing_buckets ] = {};
+  };
+
+  struct thread_metrics
+  {
+    chunked_array< metric_slot > slots;
+  };
+
+  /// totals of metric over all threads
+  struct metric_totals
+  {
+    uint64_t count = 0;
+    int64_t  sum = 0;
+    uint64_t buckets[ timing_buckets ] = {};
+    uint64_t gauge_updates = 0;
+  };
+
   class statsd_plugin_impl
   {
     public:
       statsd_plugin_impl()
       {
+        static std::atomic< uint64_t > instance_counter = { 0 };
+        _instance = ++instance_counter;
         _shutdown_in_progress.store( false );
       }
 
-      ~statsd_plugin_impl() {}
+      ~statsd_plugin_impl()
+      {
+        stop_flush_thread();
+      }
 
       void start();
       void shutdown();
 
       bool is_accessible() const;
+      /// false for invalid_metric_id and ids not (yet) issued by this instance
+      bool is_registered( metric_id id ) const;
+      uint64_t get_instance() const { return _instance; }
       bool filter_by_namespace( const std::string& ns, const std::string& stat ) const;
 
-      void execute_operation( const std::string& ns, const std::string& stat, const std::function< void() >& op ) const;
+      metric_id register_metric( const std::string& ns, const std::string& stat, const std::string& key, metric_type type ) noexcept;
 
-      void increment( const std::string& ns, const std::string& stat, const std::string& key,                       const float frequency ) const noexcept;
-      void decrement( const std::string& ns, const std::string& stat, const std::string& key,                       const float frequency ) const noexcept;
-      void count(     const std::string& ns, const std::string& stat, const std::string& key, const int64_t delta,  const float frequency ) const noexcept;
-      void gauge(     const std::string& ns, const std::string& stat, const std::string& key, const uint64_t value, const float frequency ) const noexcept;
-      void timing(    const std::string& ns, const std::string& stat, const std::string& key, const uint32_t ms,    const float frequency ) const noexcept;
+      void count(  metric_id id, const int64_t delta ) noexcept;
+      void gauge(  metric_id id, const uint64_t value ) noexcept;
+      void timing( metric_id id, const uint32_t ms ) noexcept;
 
+      std::vector< aggregated_metric > get_metrics();
 
       bool                                               _filter_stats = false;
       bool                                               _blacklist    = false;
@@ -57,8 +160,33 @@ namespace detail
 
       fc::optional< fc::ip::endpoint >                   _statsd_endpoint;
       uint32_t                                           _statsd_batchsize = 1;
+      uint32_t                                           _flush_interval_ms = 1000;
 
       std::unique_ptr< StatsdClient >                    _statsd;
+
+    private:
+      thread_metrics& local_metrics();
+      /// sums values of all metrics with id below given count over all threads
+      std::vector< metric_totals > collect( uint32_t metric_count );
+      void flush();
+      void flush_loop();
+      void stop_flush_thread();
+
+      uint64_t                                           _instance = 0;
+
+      std::shared_mutex                                  _registry_mutex;
+      std::unordered_map< std::string, metric_id >       _metric_ids;
+      chunked_array< metric_info >                       _metrics;
+      std::atomic< uint32_t >                            _metric_count = { 0 };
+
+      std::mutex                                         _threads_mutex;
+      std::vector< std::unique_ptr< thread_metrics > >   _threads;
+
+      std::thread                                        _flush_thread;
+      std::mutex                                         _flush_mutex;
+      std::condition_variable                            _flush_cv;
+      bool                                               _flush_stop = false;
+      std::vector< metric_totals >                       _sent; ///< totals already sent to statsd (used by flush thread only)
   };
 
   void statsd_plugin_impl::start()
@@ -80,6 +208,8 @@ namespace detail
     }
 
     _statsd.reset( new StatsdClient( host, port, "hived.", _statsd_batchsize ) );
+    _flush_stop = false;
+    _flush_thread = std::thread( [this]() { flush_loop(); } );
     _started = true;
   }
 
@@ -89,18 +219,14 @@ namespace detail
 
     _shutdown_in_progress.store( true );
 
-    //Wait until all operations will be finished during 2 seconds
-    uint32_t cnt = 0;
-    const uint32_t cnt_max = 10;
-    while( cnt++ < cnt_max )
-      fc::usleep( fc::milliseconds( 200 ) );
-
+    // values recorded so far are sent with final flush
+    stop_flush_thread();
     _statsd.reset();
   }
 
   bool statsd_plugin_impl::is_accessible() const
   {
-    return !_shutdown_in_progress.load();
+    return !_shutdown_in_progress.load( std::memory_order_relaxed );
   }
 
   bool statsd_plugin_impl::filter_by_namespace( const std::string& ns, const std::string& stat ) const
@@ -132,37 +258,227 @@ namespace detail
     return _blacklist != found;
   }
 
-  void statsd_plugin_impl::execute_operation( const std::string& ns, const std::string& stat, const std::function< void() >& op ) const
+  metric_id statsd_plugin_impl::register_metric( const std::string& ns, const std::string& stat, const std::string& key, metric_type type ) noexcept
+  {
+    if( !filter_by_namespace( ns, stat ) )
+      return invalid_metric_id;
+
+    try
+    {
+      std::string name = compose_key( ns, stat, key );
+      {
+        std::shared_lock< std::shared_mutex > lock( _registry_mutex );
+        auto itr = _metric_ids.find( name );
+        if( itr != _metric_ids.end() )
+          return itr->second;
+      }
+
+      std::unique_lock< std::shared_mutex > lock( _registry_mutex );
+      auto itr = _metric_ids.find( name );
+      if( itr != _metric_ids.end() )
+        return itr->second;
+
+      metric_id id = _metric_count.load( std::memory_order_relaxed );
+      metric_info* info = _metrics.get( id );
+      if( info == nullptr )
+      {
+        wlog( "Too many statsd metrics, ${n} is not recorded", ( "n", name ) );
+        return invalid_metric_id;
+      }
+      info->name = name;
+      info->type = type;
+      _metric_ids.emplace( std::move( name ), id );
+      _metric_count.store( id + 1, std::memory_order_release );
+      return id;
+    }
+    catch( ... )
+    {
+      return invalid_metric_id;
+    }
+  }
+
+  thread_metrics& statsd_plugin_impl::local_metrics()
+  {
+    thread_local uint64_t instance = 0;
+    thread_local thread_metrics* metrics = nullptr;
+
+    if( instance != _instance )
+    {
+      std::lock_guard< std::mutex > guard( _threads_mutex );
+      _threads.emplace_back( new thread_metrics() );
+      metrics = _threads.back().get();
+      instance = _instance;
+    }
+    return *metrics;
+  }
+
+  bool statsd_plugin_impl::is_registered( metric_id id ) const
+  {
+    // ids not issued by this instance (see util::metric_site) must not reach slots
+    return id < _metric_count.load( std::memory_order_acquire );
+  }
+
+  void statsd_plugin_impl::count( metric_id id, const int64_t delta ) noexcept
+  {
+    if( !is_registered( id ) || !is_accessible() )
+      return;
+
+    metric_slot* slot = local_metrics().slots.get( id );
+    if( slot == nullptr )
+      return;
+    slot->count.store( slot->count.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    slot->sum.store( slot->sum.load( std::memory_order_relaxed ) + delta, std::memory_order_relaxed );
+  }
+
+  void statsd_plugin_impl::gauge( metric_id id, const uint64_t value ) noexcept
   {
-    if( !is_accessible() ) return;
-    if( !filter_by_namespace( ns, stat ) ) return;
+    if( !is_registered( id ) || !is_accessible() )
+      return;
 
-    op();
+    metric_info* info = _metrics.find( id );
+    if( info == nullptr )
+      return;
+    info->gauge_value.store( value, std::memory_order_relaxed );
+    info->gauge_updates.fetch_add( 1, std::memory_order_release );
   }
 
-  void statsd_plugin_impl::increment( const std::string& ns, const std::string& stat, const std::string& key, const float frequency ) const noexcept
+  void statsd_plugin_impl::timing( metric_id id, const uint32_t ms ) noexcept
   {
-    execute_operation( ns, stat, [ &, this ](){ _statsd->increment( compose_key( ns, stat, key ), frequency ); } );
+    if( !is_registered( id ) || !is_accessible() )
+      return;
+
+    metric_slot* slot = local_metrics().slots.get( id );
+    if( slot == nullptr )
+      return;
+    slot->count.store( slot->count.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+    slot->sum.store( slot->sum.load( std::memory_order_relaxed ) + ms, std::memory_order_relaxed );
+    auto& bucket = slot->buckets[ timing_bucket( ms ) ];
+    bucket.store( bucket.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
   }
 
-  void statsd_plugin_impl::decrement( const std::string& ns, const std::string& stat, const std::string& key, const float frequency ) const noexcept
+  std::vector< metric_totals > statsd_plugin_impl::collect( uint32_t metric_count )
   {
-    execute_operation( ns, stat, [ &, this ](){ _statsd->decrement( compose_key( ns, stat, key ), frequency ); } );
+    std::vector< metric_totals > totals( metric_count );
+
+    std::lock_guard< std::mutex > guard( _threads_mutex );
+    for( const auto& metrics : _threads )
+    {
+      for( metric_id id = 0; id < metric_count; ++id )
+      {
+        const metric_slot* slot = metrics->slots.find( id );
+        if( slot == nullptr )
+        {
+          // whole chunk is missing
+          id += chunked_array< metric_slot >::chunk_size - id % chunked_array< metric_slot >::chunk_size - 1;
+          continue;
+        }
+        auto& total = totals[ id ];
+        total.count += slot->count.load( std::memory_order_relaxed );
+        total.sum += slot->sum.load( std::memory_order_relaxed );
+        for( uint32_t b = 0; b < timing_buckets; ++b )
+          total.buckets[ b ] += slot->buckets[ b ].load( std::memory_order_relaxed );
+      }
+    }
+    for( metric_id id = 0; id < metric_count; ++id )
+    {
+      const metric_info* info = _metrics.find( id );
+      if( info != nullptr )
+        totals[ id ].gauge_updates = info->gauge_updates.load( std::memory_order_acquire );
+    }
+
+    return totals;
   }
 
-  void statsd_plugin_impl::count( const std::string& ns, const std::string& stat, const std::string& key, const int64_t delta, const float frequency ) const noexcept
+  void statsd_plugin_impl::flush()
   {
-    execute_operation( ns, stat, [ &, this ](){ _statsd->count( compose_key( ns, stat, key ), delta, frequency ); } );
+    const uint32_t metric_count = _metric_count.load( std::memory_order_acquire );
+    auto totals = collect( metric_count );
+    _sent.resize( metric_count );
+
+    for( metric_id id = 0; id < metric_count; ++id )
+    {
+      const metric_info* info_ptr = _metrics.find( id );
+      if( info_ptr == nullptr )
+        continue;
+      const metric_info& info = *info_ptr;
+      const metric_totals& current = totals[ id ];
+      const metric_totals& sent = _sent[ id ];
+
+      switch( info.type )
+      {
+        case metric_type::counter:
+          if( current.sum != sent.sum )
+            _statsd->count( info.name, static_cast< int >( current.sum - sent.sum ) );
+          break;
+        case metric_type::gauge:
+          if( current.gauge_updates != sent.gauge_updates )
+            _statsd->gauge( info.name, info.gauge_value.load( std::memory_order_relaxed ) );
+          break;
+        case metric_type::timing:
+          for( uint32_t b = 0; b < timing_buckets; ++b )
+          {
+            if( current.buckets[ b ] != sent.buckets[ b ] )
+              _statsd->sendAggregated( info.name, bucket_value( b ), "ms", current.buckets[ b ] - sent.buckets[ b ] );
+          }
+          break;
+      }
+    }
+
+    _sent = std::move( totals );
   }
 
-  void statsd_plugin_impl::gauge( const std::string& ns, const std::string& stat, const std::string& key, const uint64_t value, const float frequency ) const noexcept
+  void statsd_plugin_impl::flush_loop()
   {
-    execute_operation( ns, stat, [ &, this ](){ _statsd->gauge( compose_key( ns, stat, key ), value, frequency ); } );
+    std::unique_lock< std::mutex > lock( _flush_mutex );
+    while( !_flush_stop )
+    {
+      _flush_cv.wait_for( lock, std::chrono::milliseconds( _flush_interval_ms ), [this]() { return _flush_stop; } );
+      flush();
+    }
   }
 
-  void statsd_plugin_impl::timing( const std::string& ns, const std::string& stat, const std::string& key, const uint32_t ms, const float frequency ) const noexcept
+  void statsd_plugin_impl::stop_flush_thread()
   {
-    execute_operation( ns, stat, [ &, this ](){ _statsd->timing( compose_key( ns, stat, key ), ms, frequency ); } );
+    if( !_flush_thread.joinable() )
+      return;
+
+    {
+      std::lock_guard< std::mutex > guard( _flush_mutex );
+      _flush_stop = true;
+    }
+    _flush_cv.notify_one();
+    _flush_thread.join();
+  }
+
+  std::vector< aggregated_metric > statsd_plugin_impl::get_metrics()
+  {
+    const uint32_t metric_count = _metric_count.load( std::memory_order_acquire );
+    auto totals = collect( metric_count );
+
+    std::vector< aggregated_metric > result;
+    result.reserve( metric_count );
+    for( metric_id id = 0; id < metric_count; ++id )
+    {
+      const metric_info* info_ptr = _metrics.find( id );
+      if( info_ptr == nullptr )
+        continue;
+      const metric_info& info = *info_ptr;
+      aggregated_metric metric;
+      metric.name = info.name;
+      metric.type = info.type;
+      if( info.type == metric_type::gauge )
+      {
+        metric.count = totals[ id ].gauge_updates;
+        metric.value = info.gauge_value.load( std::memory_order_relaxed );
+      }
+      else
+      {
+        metric.count = totals[ id ].count;
+        metric.value = totals[ id ].sum;
+      }
+      result.emplace_back( std::move( metric ) );
+    }
+    return result;
   }
 }
 
@@ -177,6 +493,7 @@ void statsd_plugin::set_program_options( options_description& cli, options_descr
   cfg.add_options()
     ("statsd-endpoint", bpo::value< std::string >(), "Endpoint to send statsd messages to.")
     ("statsd-batchsize", bpo::value< uint32_t >()->default_value( 1 ), "Size to batch statsd messages." )
+    ("statsd-flush-interval", bpo::value< uint32_t >()->default_value( 1000 ), "Interval (in ms) of sending statistics aggregated in process to statsd." )
     ("statsd-whitelist", bpo::value< vector< std::string > >()->composing(), "Whitelist of statistics to capture.")
     ("statsd-blacklist", bpo::value< vector< std::string > >()->composing(), "Blacklist of statistics to capture.");
 }
@@ -192,6 +509,9 @@ void statsd_plugin::plugin_initialize( const boost::program_options::variables_m
     ilog( "Configured statsd to send to ${ep}", ("ep", endpoints[0]) );
   }
 
+  my->_flush_interval_ms = options.at( "statsd-flush-interval" ).as< uint32_t >();
+  FC_ASSERT( my->_flush_interval_ms > 0, "statsd-flush-interval has to be positive" );
+
   if( options.count( "statsd-whitelist" ) )
   {
     my->_filter_stats = true;
@@ -266,27 +586,57 @@ void statsd_plugin::start_logging()
 
 void statsd_plugin::increment( const std::string& ns, const std::string& stat, const std::string& key, const float frequency ) const noexcept
 {
-  my->increment( ns, stat, key, frequency );
+  my->count( my->register_metric( ns, stat, key, metric_type::counter ), 1 );
 }
 
 void statsd_plugin::decrement( const std::string& ns, const std::string& stat, const std::string& key, const float frequency ) const noexcept
 {
-  my->decrement( ns, stat, key, frequency );
+  my->count( my->register_metric( ns, stat, key, metric_type::counter ), -1 );
 }
 
 void statsd_plugin::count( const std::string& ns, const std::string& stat, const std::string& key, const int64_t delta, const float frequency ) const noexcept
 {
-  my->count( ns, stat, key, delta, frequency );
+  my->count( my->register_metric( ns, stat, key, metric_type::counter ), delta );
 }
 
 void statsd_plugin::gauge( const std::string& ns, const std::string& stat, const std::string& key, const uint64_t value, const float frequency ) const noexcept
 {
-  my->gauge( ns, stat, key, value, frequency );
+  my->gauge( my->register_metric( ns, stat, key, metric_type::gauge ), value );
 }
 
 void statsd_plugin::timing( const std::string& ns, const std::string& stat, const std::string& key, const uint32_t ms, const float frequency ) const noexcept
 {
-  my->timing( ns, stat, key, ms, frequency );
+  my->timing( my->register_metric( ns, stat, key, metric_type::timing ), ms );
+}
+
+uint64_t statsd_plugin::get_instance_id() const noexcept
+{
+  return my->get_instance();
+}
+
+metric_id statsd_plugin::register_metric( const std::string& ns, const std::string& stat, const std::string& key, metric_type type ) const noexcept
+{
+  return my->register_metric( ns, stat, key, type );
+}
+
+void statsd_plugin::count( metric_id id, const int64_t delta ) const noexcept
+{
+  my->count( id, delta );
+}
+
+void statsd_plugin::gauge( metric_id id, const uint64_t value ) const noexcept
+{
+  my->gauge( id, value );
+}
+
+void statsd_plugin::timing( metric_id id, const uint32_t ms ) const noexcept
+{
+  my->timing( id, ms );
+}
+
+std::vector< aggregated_metric > statsd_plugin::get_metrics() const
+{
+  return my->get_metrics();
 }
 
 } } } // hive::plugins::statsd
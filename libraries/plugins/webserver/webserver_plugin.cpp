@@ -3,6 +3,8 @@
 
 #include <hive/plugins/json_rpc/utility.hpp>
 
+#include <hive/plugins/statsd/utility.hpp>
+
 #include <fc/network/ip.hpp>
 #include <fc/log/logger_config.hpp>
 #include <fc/io/json.hpp>
@@ -27,6 +29,9 @@
 
 #include <thread>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <atomic>
 #include <iostream>
 
 using namespace boost::placeholders;
@@ -242,6 +247,95 @@ void tls_server::set_tls_handlers( websocket_server_type& server )
 template<> void tls_server::set_tls_handlers<websocket_server_type_nondeflate>( websocket_server_type_nondeflate& server ){}
 template<> void tls_server::set_tls_handlers<websocket_server_type_deflate>( websocket_server_type_deflate& server ){}
 
+/**
+  * Worker threads with an admission limit. Requests that would have to wait behind `max_queued` others
+  * are refused right away (503) instead of piling up in an unbounded queue.
+  */
+struct request_lane
+{
+  explicit request_lane( const char* _name ) : name( _name ) {}
+
+  bool try_admit()
+  {
+    uint32_t current = queued.load( std::memory_order_relaxed );
+    do
+    {
+      if( max_queued && current >= max_queued )
+        return false;
+    }
+    while( !queued.compare_exchange_weak( current, current + 1, std::memory_order_relaxed ) );
+    return true;
+  }
+
+  void start()
+  {
+    work.reset( new asio::io_service::work( ios ) );
+    for( uint32_t i = 0; i < threads; ++i )
+      thread_pool.create_thread( [this]() { fc::set_thread_name( name ); ios.run(); } );
+  }
+
+  void stop()
+  {
+    ios.stop();
+    thread_pool.join_all();
+  }
+
+  const char*                               name;
+  thread_pool_size_t                        threads = 0;
+  uint32_t                                  max_queued = 0; ///< 0 means no limit
+  std::atomic< uint32_t >                   queued = { 0 };  ///< admitted, but not picked up by a worker yet
+
+  boost::thread_group                       thread_pool;
+  asio::io_service                          ios;
+  std::unique_ptr< asio::io_service::work > work;
+};
+
+const std::string overloaded_message = "Server is overloaded, try again later";
+const std::string overloaded_ws_response =
+  "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32000,\"message\":\"" + overloaded_message + "\"},\"id\":null}";
+
+template< typename connection_type >
+void reject_http_request( connection_type& con )
+{
+  con.set_body( overloaded_message );
+  con.append_header( "Retry-After", "1" );
+  con.append_header( "Connection", "close" );
+  con.set_status( websocketpp::http::status_code::service_unavailable );
+  con.send_http_response();
+}
+
+/**
+  * Answers HTTP request with JSON-RPC response, unless client accepts HIVE_BINARY_API_CONTENT_TYPE and called
+  * method supports binary transport ("Accept: application/x-hive-binary; compression=zstd" asks for compressed payload).
+  */
+template< typename connection_type >
+void set_api_response( plugins::json_rpc::json_rpc_plugin& api, connection_type& con, const std::string& body )
+{
+  const std::string& accept = con.get_request_header( "Accept" );
+  if( accept.find( HIVE_BINARY_API_CONTENT_TYPE ) != std::string::npos )
+  {
+    const auto compression = accept.find( "compression=zstd" ) != std::string::npos ?
+      plugins::json_rpc::binary_compression::zstd : plugins::json_rpc::binary_compression::none;
+    std::string response;
+    const bool is_binary = api.call_binary( body, compression, response );
+    con.set_body( response );
+    con.append_header( "Content-Type", is_binary ? HIVE_BINARY_API_CONTENT_TYPE : "application/json" );
+    return;
+  }
+
+  con.set_body( api.call( body ) );
+  con.append_header( "Content-Type", "application/json" );
+}
+
+struct request_scheduling_config
+{
+  thread_pool_size_t  thread_pool_size = 0;
+  thread_pool_size_t  expensive_thread_pool_size = 0;
+  uint32_t            max_queued_requests = 0;
+  uint32_t            max_ws_requests_per_connection = 0;
+  std::vector< std::string > expensive_methods;
+};
+
 class webserver_base
 {
   public:
@@ -264,9 +358,21 @@ template<typename websocket_server_type>
 class webserver_plugin_impl : public webserver_base
 {
   public:
-    webserver_plugin_impl( thread_pool_size_t _thread_pool_size, appbase::application& app ) :
-      thread_pool_size( _thread_pool_size ), theApp( app )
+    webserver_plugin_impl( const request_scheduling_config& config, appbase::application& app ) :
+      max_ws_requests_per_connection( config.max_ws_requests_per_connection ), theApp( app )
     {
+      regular_lane.threads = config.thread_pool_size;
+      regular_lane.max_queued = config.max_queued_requests;
+      expensive_lane.threads = config.expensive_thread_pool_size;
+      expensive_lane.max_queued = config.max_queued_requests;
+
+      // both "api.method" and legacy "call" requests, where method name is a separate string
+      for( const auto& method : config.expensive_methods )
+      {
+        expensive_patterns.push_back( "\"" + method + "\"" );
+        if( method.find( '.' ) == std::string::npos )
+          expensive_patterns.push_back( "." + method + "\"" );
+      }
     }
 
     void startup() override;
@@ -279,7 +385,12 @@ class webserver_plugin_impl : public webserver_base
     void handle_http_message( websocket_server_type*, connection_hdl );
     void handle_http_request( websocket_local_server_type*, connection_hdl );
 
-    thread_pool_size_t         thread_pool_size;
+    request_lane& select_lane( const std::string& body );
+    template< typename Handler >
+    bool dispatch( const std::string& body, const fc::time_point& arrival_time, Handler&& handler );
+
+    bool acquire_ws_slot( const connection_hdl& hdl );
+    void release_ws_slot( const connection_hdl& hdl );
 
     shared_ptr< std::thread >  http_thread;
     asio::io_service           http_ios;
@@ -293,9 +404,13 @@ class webserver_plugin_impl : public webserver_base
     asio::io_service           ws_ios;
     websocket_server_type      ws_server;
 
-    boost::thread_group        thread_pool;
-    asio::io_service           thread_pool_ios;
-    std::unique_ptr< asio::io_service::work > thread_pool_work;
+    request_lane               regular_lane{ "api" };
+    request_lane               expensive_lane{ "api_expensive" };
+    std::vector< std::string > expensive_patterns;
+
+    uint32_t                   max_ws_requests_per_connection = 0;
+    std::mutex                 ws_requests_mutex;
+    std::map< connection_hdl, uint32_t, std::owner_less< connection_hdl > > ws_requests; ///< requests in progress per websocket connection
 
     plugins::json_rpc::json_rpc_plugin* api = nullptr;
 
@@ -325,10 +440,76 @@ void webserver_plugin_impl<websocket_server_type>::startup()
 template<typename websocket_server_type>
 void webserver_plugin_impl<websocket_server_type>::prepare_threads()
 {
-  thread_pool_work.reset( new asio::io_service::work( this->thread_pool_ios ) );
+  regular_lane.start();
+  expensive_lane.start();
+}
 
-  for( uint32_t i = 0; i < thread_pool_size; ++i )
-    thread_pool.create_thread( [&]() { fc::set_thread_name("api"); thread_pool_ios.run(); } );
+template<typename websocket_server_type>
+request_lane& webserver_plugin_impl<websocket_server_type>::select_lane( const std::string& body )
+{
+  // plain text search is good enough to tell lanes apart and costs far less than parsing the request
+  if( expensive_lane.threads )
+  {
+    for( const auto& pattern : expensive_patterns )
+    {
+      if( body.find( pattern ) != std::string::npos )
+        return expensive_lane;
+    }
+  }
+
+  return regular_lane;
+}
+
+template<typename websocket_server_type>
+template< typename Handler >
+bool webserver_plugin_impl<websocket_server_type>::dispatch( const std::string& body, const fc::time_point& arrival_time, Handler&& handler )
+{
+  request_lane& lane = select_lane( body );
+
+  if( !lane.try_admit() )
+  {
+    STATSD_INCREMENT( "webserver", "rejected", lane.name, 1.0f, theApp );
+    return false;
+  }
+
+  STATSD_GAUGE( "webserver", "queued", lane.name, lane.queued.load( std::memory_order_relaxed ), 1.0f, theApp );
+
+  lane.ios.post( [this, &lane, arrival_time, handler = std::forward< Handler >( handler )]() mutable
+  {
+    lane.queued.fetch_sub( 1, std::memory_order_relaxed );
+    STATSD_TIMER( "webserver", "queue_wait", lane.name, fc::time_point::now() - arrival_time, 1.0f, theApp );
+
+    handler();
+  } );
+
+  return true;
+}
+
+template<typename websocket_server_type>
+bool webserver_plugin_impl<websocket_server_type>::acquire_ws_slot( const connection_hdl& hdl )
+{
+  if( max_ws_requests_per_connection == 0 )
+    return true;
+
+  std::lock_guard< std::mutex > guard( ws_requests_mutex );
+  uint32_t& in_progress = ws_requests[ hdl ];
+  if( in_progress >= max_ws_requests_per_connection )
+    return false;
+
+  ++in_progress;
+  return true;
+}
+
+template<typename websocket_server_type>
+void webserver_plugin_impl<websocket_server_type>::release_ws_slot( const connection_hdl& hdl )
+{
+  if( max_ws_requests_per_connection == 0 )
+    return;
+
+  std::lock_guard< std::mutex > guard( ws_requests_mutex );
+  auto itr = ws_requests.find( hdl );
+  if( itr != ws_requests.end() && --itr->second == 0 )
+    ws_requests.erase( itr );
 }
 
 template<typename websocket_server_type>
@@ -515,8 +696,8 @@ void webserver_plugin_impl<websocket_server_type>::update_ws_endpoint()
 template<typename websocket_server_type>
 void webserver_plugin_impl<websocket_server_type>::stop_webserver()
 {
-  thread_pool_ios.stop();
-  thread_pool.join_all();
+  regular_lane.stop();
+  expensive_lane.stop();
 
   if( ws_thread )
   {
@@ -543,11 +724,25 @@ void webserver_plugin_impl<websocket_server_type>::stop_webserver()
 template<typename websocket_server_type>
 void webserver_plugin_impl<websocket_server_type>::handle_ws_message( websocket_server_type* server, connection_hdl hdl, const typename websocket_server_type::message_ptr& msg )
 {
-  auto con = server->get_con_from_hdl( std::move( hdl ) );
+  auto con = server->get_con_from_hdl( hdl );
+
+  if( !acquire_ws_slot( hdl ) )
+  {
+    STATSD_INCREMENT( "webserver", "rejected", "ws_connection", 1.0f, theApp );
+    con->send( overloaded_ws_response );
+    return;
+  }
 
   fc::time_point arrival_time = fc::time_point::now();
-  thread_pool_ios.post( [con, msg, this, arrival_time]()
+  bool admitted = dispatch( msg->get_payload(), arrival_time, [con, msg, this, hdl, arrival_time]()
   {
+    struct ws_slot_guard
+    {
+      webserver_plugin_impl& impl;
+      const connection_hdl&  hdl;
+      ~ws_slot_guard() { impl.release_ws_slot( hdl ); }
+    } slot_guard{ *this, hdl };
+
     LOG_DELAY(arrival_time, fc::seconds(2), "Excessive delay to begin processing ws API call");
 
     try
@@ -590,6 +785,12 @@ void webserver_plugin_impl<websocket_server_type>::handle_ws_message( websocket_
       }
     }
   });
+
+  if( !admitted )
+  {
+    release_ws_slot( hdl );
+    con->send( overloaded_ws_response );
+  }
 }
 
 template<typename websocket_server_type>
@@ -599,7 +800,7 @@ void webserver_plugin_impl<websocket_server_type>::handle_http_message( websocke
   con->defer_http_response();
 
   fc::time_point arrival_time = fc::time_point::now();
-  thread_pool_ios.post( [con, this, arrival_time]()
+  bool admitted = dispatch( con->get_request_body(), arrival_time, [con, this, arrival_time]()
   {
     LOG_DELAY(arrival_time, fc::seconds(2), "Excessive delay to begin processing API call");
 
@@ -608,8 +809,7 @@ void webserver_plugin_impl<websocket_server_type>::handle_http_message( websocke
 
     try
     {
-      con->set_body( api->call( body ) );
-      con->append_header( "Content-Type", "application/json" );
+      set_api_response( *api, *con, body );
 
       /*
         HTTP/1.1 applications that do not support persistent connections MUST include the "close" connection option in every message. 
@@ -653,6 +853,9 @@ void webserver_plugin_impl<websocket_server_type>::handle_http_message( websocke
     LOG_DELAY_EX(arrival_time, fc::seconds(10), "Excessive delay to process API call ${body}",(body));
     con->send_http_response();
   });
+
+  if( !admitted )
+    reject_http_request( *con );
 }
 
 template<typename websocket_server_type>
@@ -660,14 +863,13 @@ void webserver_plugin_impl<websocket_server_type>::handle_http_request(websocket
   auto con = server->get_con_from_hdl( std::move( hdl ) );
   con->defer_http_response();
 
-  thread_pool_ios.post( [con, this]()
+  bool admitted = dispatch( con->get_request_body(), fc::time_point::now(), [con, this]()
   {
     auto body = con->get_request_body();
 
     try
     {
-      con->set_body( api->call( body ) );
-      con->append_header( "Content-Type", "application/json" );
+      set_api_response( *api, *con, body );
       con->set_status( websocketpp::http::status_code::ok );
     }
     catch( fc::exception& e )
@@ -699,6 +901,9 @@ void webserver_plugin_impl<websocket_server_type>::handle_http_request(websocket
 
     con->send_http_response();
   });
+
+  if( !admitted )
+    reject_http_request( *con );
 }
 
 template<typename websocket_server_type>
@@ -727,6 +932,18 @@ void webserver_plugin::set_program_options( options_description&, options_descri
     ("webserver-ws-deflate", bpo::value<bool>()->default_value( false ), "Enable the RFC-7692 permessage-deflate extension for the WebSocket server (only used if the client requests it).  This may save bandwidth at the expense of CPU")
     ("webserver-thread-pool-size", bpo::value<thread_pool_size_t>()->default_value(32),
       "Number of threads used to handle queries. Default: 32.")
+    ("webserver-expensive-thread-pool-size", bpo::value<thread_pool_size_t>()->default_value(0),
+      "Number of threads used to handle queries to methods listed in webserver-expensive-api, so they cannot starve cheap ones. "
+      "0 means such queries share the regular pool. Default: 0.")
+    ("webserver-expensive-api", bpo::value< std::vector< string > >()->composing()->multitoken(),
+      "Method handled by the expensive pool, either as api.method or just method name (may specify multiple times). "
+      "Default: get_account_history enum_virtual_ops get_ops_in_block get_block_range get_transaction")
+    ("webserver-max-queued-requests", bpo::value<uint32_t>()->default_value(0),
+      "Number of requests allowed to wait for a thread in each pool. Requests over the limit are refused with 503 "
+      "(or JSON-RPC error for websocket). 0 means no limit. Default: 0.")
+    ("webserver-max-ws-requests-per-connection", bpo::value<uint32_t>()->default_value(0),
+      "Number of requests a single websocket connection can have in progress before further ones are refused. "
+      "0 means no limit. Default: 0.")
     ("webserver-https-certificate-file-name", bpo::value< string >(), "File name with a server's certificate." )
     ("webserver-https-key-file-name", bpo::value< string >(), "File name with a server's private key." );
     ;
@@ -735,9 +952,24 @@ void webserver_plugin::set_program_options( options_description&, options_descri
 void webserver_plugin::plugin_initialize( const variables_map& options )
 {
   ilog("initializing webserver plugin");
-  auto thread_pool_size = options.at("webserver-thread-pool-size").as<thread_pool_size_t>();
-  FC_ASSERT(thread_pool_size > 0, "webserver-thread-pool-size must be greater than 0");
-  ilog("configured with ${tps} thread pool size", ("tps", thread_pool_size));
+  detail::request_scheduling_config config;
+  config.thread_pool_size = options.at("webserver-thread-pool-size").as<thread_pool_size_t>();
+  FC_ASSERT(config.thread_pool_size > 0, "webserver-thread-pool-size must be greater than 0");
+  ilog("configured with ${tps} thread pool size", ("tps", config.thread_pool_size));
+
+  config.expensive_thread_pool_size = options.at("webserver-expensive-thread-pool-size").as<thread_pool_size_t>();
+  if( options.count( "webserver-expensive-api" ) )
+    config.expensive_methods = options.at( "webserver-expensive-api" ).as< std::vector< string > >();
+  else
+    config.expensive_methods = { "get_account_history", "enum_virtual_ops", "get_ops_in_block", "get_block_range", "get_transaction" };
+  if( config.expensive_thread_pool_size )
+    ilog("configured with ${tps} thread pool size for ${methods}", ("tps", config.expensive_thread_pool_size)("methods", config.expensive_methods));
+
+  config.max_queued_requests = options.at("webserver-max-queued-requests").as<uint32_t>();
+  config.max_ws_requests_per_connection = options.at("webserver-max-ws-requests-per-connection").as<uint32_t>();
+  if( config.max_queued_requests || config.max_ws_requests_per_connection )
+    ilog("requests over ${queued} queued per pool or ${per_connection} in progress per websocket connection will be refused (0 - no limit)",
+      ("queued", config.max_queued_requests)("per_connection", config.max_ws_requests_per_connection));
 
   auto _ws_deflate_enabled = options.at( "webserver-ws-deflate" ).as< bool >();
   ilog("Compression in webserver is ${_ws_deflate_enabled}", ("_ws_deflate_enabled", _ws_deflate_enabled ? "enabled" : "disabled"));
@@ -748,9 +980,9 @@ void webserver_plugin::plugin_initialize( const variables_map& options )
     FC_ASSERT(options.count( "webserver-https-key-file-name" ), "Option `webserver-https-key-file-name` is required");
 
     if( _ws_deflate_enabled )
-      my.reset( new detail::webserver_plugin_impl<detail::websocket_tls_server_type_deflate>( thread_pool_size, get_app() ) );
+      my.reset( new detail::webserver_plugin_impl<detail::websocket_tls_server_type_deflate>( config, get_app() ) );
     else
-      my.reset( new detail::webserver_plugin_impl<detail::websocket_tls_server_type_nondeflate>( thread_pool_size, get_app() ) );
+      my.reset( new detail::webserver_plugin_impl<detail::websocket_tls_server_type_nondeflate>( config, get_app() ) );
 
     my->tls = detail::tls_server( get_app() );
     my->tls->server_certificate_file_name = options.at( "webserver-https-certificate-file-name" ).as< string >();
@@ -765,9 +997,9 @@ void webserver_plugin::plugin_initialize( const variables_map& options )
       ilog( "Option `webserver-https-key-file-name` is avoided. It's used only for https connection." );
 
     if( _ws_deflate_enabled )
-      my.reset( new detail::webserver_plugin_impl<detail::websocket_server_type_deflate>( thread_pool_size, get_app() ) );
+      my.reset( new detail::webserver_plugin_impl<detail::websocket_server_type_deflate>( config, get_app() ) );
     else
-      my.reset( new detail::webserver_plugin_impl<detail::websocket_server_type_nondeflate>( thread_pool_size, get_app() ) );
+      my.reset( new detail::webserver_plugin_impl<detail::websocket_server_type_nondeflate>( config, get_app() ) );
   }
 
   if( options.count( "webserver-http-endpoint" ) || options.count( "webserver-https-endpoint" ) )
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <hive/protocol/operations.hpp>
+#include <hive/protocol/asset.hpp>
+#include <hive/protocol/authority.hpp>
+#include <hive/protocol/misc_utilities.hpp>
+
+#include <fc/io/json_encode.hpp>
+
+namespace hive { namespace protocol {
+
+/**
+  * Output format of fc::json_encode that gives the same text as to_variant with legacy transaction serialization
+  * (as used by condenser_api), but renders native protocol objects directly - no legacy_* mirror objects and no
+  * intermediate variants except for members of types it has no specialization for.
+  */
+struct legacy_json_format {};
+
+} } // hive::protocol
+
+namespace fc {
+
+/// switches format (and serialization mode for members that still go through to_variant) like to_variant of the wrapper does
+template< typename Format, typename T >
+struct json_encoder< Format, hive::protocol::serializer_wrapper< T > >
+{
+  static void encode( std::string& out, const hive::protocol::serializer_wrapper< T >& wrapper, uint32_t depth )
+  {
+    mode_guard guard( wrapper.transaction_serialization );
+    if( wrapper.transaction_serialization == hive::protocol::transaction_serialization_type::legacy )
+      json_encode< hive::protocol::legacy_json_format >( out, wrapper.value, depth );
+    else
+      json_encode< json_default_format >( out, wrapper.value, depth );
+  }
+};
+
+template< typename Format, typename Storage >
+struct json_encoder< Format, hive::protocol::fixed_string_impl< Storage > >
+{
+  static void encode( std::string& out, const hive::protocol::fixed_string_impl< Storage >& value, uint32_t )
+  {
+    json::append_string( out, std::string( value ) );
+  }
+};
+
+template< typename Format >
+struct json_encoder< Format, hive::protocol::public_key_type >
+{
+  static void encode( std::string& out, const hive::protocol::public_key_type& value, uint32_t )
+  {
+    json::append_string( out, std::string( value ) );
+  }
+};
+
+template<>
+struct json_encoder< hive::protocol::legacy_json_format, hive::protocol::asset >
+{
+  static void encode( std::string& out, const hive::protocol::asset& value, uint32_t )
+  {
+    json::append_string( out, hive::protocol::legacy_asset( value ).to_string() );
+  }
+};
+
+template< uint32_t _SYMBOL >
+struct json_encoder< hive::protocol::legacy_json_format, hive::protocol::tiny_asset< _SYMBOL > >
+{
+  static void encode( std::string& out, const hive::protocol::tiny_asset< _SYMBOL >& value, uint32_t )
+  {
+    json::append_string( out, hive::protocol::legacy_asset( value.to_asset() ).to_string() );
+  }
+};
+
+/// [ "name", { members } ] - see extended_variant_creator_functor
+template<>
+struct json_encoder< hive::protocol::legacy_json_format, hive::protocol::operation >
+{
+  struct visitor
+  {
+    typedef void result_type;
+
+    std::string& out;
+    uint32_t     depth;
+
+    template< typename Operation >
+    void operator()( const Operation& op )const
+    {
+      static const std::string prefix = "[\"" +
+        hive::protocol::trim_legacy_typename_namespace( fc::get_typename< Operation >::name() ) + "\",";
+      out += prefix;
+      // operations don't have custom to_variant, just their members can
+      json_encode_object< hive::protocol::legacy_json_format >( out, op, depth );
+      out += ']';
+    }
+  };
+
+  static void encode( std::string& out, const hive::protocol::operation& value, uint32_t depth )
+  {
+    value.visit( visitor{ out, depth } );
+  }
+};
+
+} // fc
+
+FC_JSON_DIRECT_ENCODE( hive::protocol::authority )
+FC_JSON_DIRECT_ENCODE( hive::protocol::price )
@@ -152,6 +152,15 @@ namespace hive { namespace protocol {
 namespace fc
 {
   using hive::protocol::operation;
+
+  /// Votes, custom_jsons, transfers and most virtual operations are stored inline, while rare big operations
+  /// (comments, account creation/update, pow) are allocated separately, so operation takes 128 instead of 352 bytes.
+  template<>
+  struct static_variant_storage_traits< operation >
+  {
+    static constexpr size_t inline_capacity = 112;
+  };
+
   template<>
   struct serialization_functor< operation >
   {
@@ -63,6 +63,10 @@ void set_logging_program_options( boost::program_options::options_description& o
       "\"level\" - level of reporting, see log_level enum values\n"
       "\"appenders\" - list of designated appenders"
       )
+    ("log-async-queue-size", boost::program_options::value< uint32_t >()->default_value( 0 ),
+      "Number of log messages that can wait to be written by background logging thread. "
+      "0 means messages are written synchronously by threads that log them. "
+      "When the queue is full, new messages are dropped (and their number reported) instead of blocking.")
     ;
 }
 
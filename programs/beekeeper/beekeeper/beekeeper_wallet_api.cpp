@@ -54,6 +54,7 @@ class beekeeper_api_impl
       (list_created_wallets)
       (get_public_keys)
       (sign_digest)
+      (sign_digests)
       (get_info)
       (create_session)
       (close_session)
@@ -187,6 +188,18 @@ DEFINE_API_IMPL( beekeeper_api_impl, sign_digest )
   return { _wallet_mgr->sign_digest( args.token, args.wallet_name, args.sig_digest, create( args.public_key ), prefix ) };
 }
 
+DEFINE_API_IMPL( beekeeper_api_impl, sign_digests )
+{
+  std::shared_lock guard( mtx );
+
+  std::vector<std::pair<std::string, public_key_type>> _digests;
+  _digests.reserve( args.digests.size() );
+  for( const auto& _digest : args.digests )
+    _digests.emplace_back( _digest.sig_digest, create( _digest.public_key ) );
+
+  return { _wallet_mgr->sign_digests( args.token, args.wallet_name, _digests, prefix ) };
+}
+
 DEFINE_API_IMPL( beekeeper_api_impl, get_info )
 {
   std::shared_lock guard( mtx );
@@ -269,6 +282,7 @@ DEFINE_LOCKLESS_APIS( beekeeper_wallet_api,
   (list_created_wallets)
   (get_public_keys)
   (sign_digest)
+  (sign_digests)
   (get_info)
   (create_session)
   (close_session)
@@ -308,6 +308,23 @@ namespace beekeeper {
     return sign_digest_impl( token, sig_digest, public_key, std::optional<std::string>( wallet_name ) );
   }
 
+  std::string beekeeper_api::sign_digests( const std::string& token, const std::vector<std::string>& sig_digests, const std::vector<std::string>& public_keys )
+  {
+    auto _method = [&, this]()
+    {
+      FC_ASSERT( sig_digests.size() == public_keys.size(), "Number of digests (${d}) differs from number of public keys (${k})", ("d", sig_digests.size())("k", public_keys.size()) );
+
+      std::vector<std::pair<std::string, public_key_type>> _digests;
+      _digests.reserve( sig_digests.size() );
+      for( size_t _idx = 0; _idx < sig_digests.size(); ++_idx )
+        _digests.emplace_back( sig_digests[ _idx ], create( public_keys[ _idx ] ) );
+
+      sign_digests_return _result = { _impl->app.get_wallet_manager()->sign_digests( token, std::optional<std::string>(), _digests, prefix ) };
+      return to_string( _result );
+    };
+    return exception_handler( _method );
+  }
+
   std::string beekeeper_api::get_info( const std::string& token )
   {
     auto _method = [&, this]()
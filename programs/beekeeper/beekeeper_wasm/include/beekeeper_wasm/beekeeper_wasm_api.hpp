@@ -81,6 +81,7 @@ class beekeeper_api final
 
     std::string sign_digest( const std::string& token, const std::string& sig_digest, const std::string& public_key );
     std::string sign_digest( const std::string& token, const std::string& sig_digest, const std::string& public_key, const std::string& wallet_name );
+    std::string sign_digests( const std::string& token, const std::vector<std::string>& sig_digests, const std::vector<std::string>& public_keys );
 
     std::string get_info( const std::string& token );
     std::string get_version();
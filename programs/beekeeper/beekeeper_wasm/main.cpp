@@ -219,6 +219,18 @@ EMSCRIPTEN_BINDINGS(beekeeper_api_instance) {
     .function("sign_digest(token, sig_digest, public_key)", select_overload<std::string(const std::string&, const std::string&, const std::string&)>(&beekeeper_api::sign_digest))              //(1)
     .function("sign_digest(token, sig_digest, public_key, wallet_name)", select_overload<std::string(const std::string&, const std::string&, const std::string&, const std::string&)>(&beekeeper_api::sign_digest)) //(2)
 
+    /*
+      ****signing many digests at once****
+      PARAMS:
+        token:        a token representing a session
+        sig_digests:  digests of transactions
+        public_keys:  public keys corresponding to private keys that are stored in wallets, i-th key is used for signing of i-th digest
+      RESULT:
+        { "signatures":["1f69e091fc79b0e8d1812fc662f12076561f9e38ffc212b901ae90fe559f863ad266fe459a8e946cff9bbe7e56ce253bbfab0cccdde944edc1d05161c61ae86340"]}
+        signatures: signatures in the same order as digests
+    */
+    .function("sign_digests(token, sig_digests, public_keys)", &beekeeper_api::sign_digests)
+
     /*
       ****information about a session****
       PARAMS:
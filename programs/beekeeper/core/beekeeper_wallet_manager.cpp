@@ -115,6 +115,22 @@ signature_type beekeeper_wallet_manager::sign_digest( const std::string& token,
   return sessions->get_wallet_manager( token )->sign_digest( wallet_name, digest_type( sig_digest ), public_key, prefix );
 }
 
+std::vector<signature_type> beekeeper_wallet_manager::sign_digests( const std::string& token, const std::optional<std::string>& wallet_name, const std::vector<std::pair<std::string, public_key_type>>& digests, const std::string& prefix )
+{
+  FC_ASSERT( digests.size(), "`digests` can't be empty" );
+
+  std::vector<std::pair<digest_type, public_key_type>> _digests;
+  _digests.reserve( digests.size() );
+  for( const auto& _digest : digests )
+  {
+    FC_ASSERT( _digest.first.size(), "`sig_digest` can't be empty" );
+    _digests.emplace_back( digest_type( _digest.first ), _digest.second );
+  }
+
+  sessions->check_timeout( token );
+  return sessions->get_wallet_manager( token )->sign_digests( wallet_name, _digests, prefix );
+}
+
 info beekeeper_wallet_manager::get_info( const std::string& token )
 {
   return sessions->get_info( token );
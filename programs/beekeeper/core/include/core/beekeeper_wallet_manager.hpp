@@ -68,6 +68,18 @@ public:
    */
   signature_type sign_digest( const std::string& token, const std::optional<std::string>& wallet_name, const std::string& sig_digest, const public_key_type& public_key, const std::string& prefix );
 
+  /**
+   *
+   * Sign many sig_digests at once. Private keys are looked up once per distinct public key and signing is spread between threads.
+   * @param token       Session's identifier.
+   * @param wallet_name A name of a wallet where private keys are stored. Optional. If not given, then private keys are searched in all unlocked wallets.
+   * @param digests     Pairs of a signature digest and a public key corresponding to a private key that should sign it.
+   * @param prefix      A prefix of a public key
+   * @return            Signatures in the same order as `digests`.
+   * @throws            An exception `fc::exception` if any of corresponding private keys is not found in unlocked wallet/wallets (nothing is signed then).
+   */
+  std::vector<signature_type> sign_digests( const std::string& token, const std::optional<std::string>& wallet_name, const std::vector<std::pair<std::string, public_key_type>>& digests, const std::string& prefix );
+
   /**
    *
    * Create a new wallet.
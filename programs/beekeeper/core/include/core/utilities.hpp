@@ -112,6 +112,14 @@ namespace utility
   }
 
   std::string get_revision();
+
+  /**
+   * Calls `work( begin, end )` for consecutive ranges covering [0, count), ranges are processed in parallel by calling
+   * thread and threads of a pool shared by all calls (created once, one thread less than hardware concurrency).
+   * Number of ranges is limited by pool size and by `min_items_per_thread` (small batches are processed on calling
+   * thread). WASM build is always single threaded. First exception thrown by `work` is rethrown.
+   */
+  void parallel_for( size_t count, size_t min_items_per_thread, const std::function<void( size_t, size_t )>& work );
 }
 
 struct session_token_type
@@ -221,6 +229,21 @@ struct sign_digest_args: public session_token_type
 };
 using sign_digest_return = signature_return;
 
+struct digest_to_sign
+{
+  std::string sig_digest;
+  std::string public_key;
+};
+struct sign_digests_args: public session_token_type
+{
+  std::vector<digest_to_sign> digests;
+  std::optional<std::string> wallet_name;
+};
+struct sign_digests_return
+{
+  std::vector<signature_type> signatures;
+};
+
 using get_info_args   = session_token_type;
 using get_info_return = info;
 using get_version_args   = void_type;
@@ -319,6 +342,7 @@ namespace fc
   void to_variant( const beekeeper::list_wallets_return& var, fc::variant& vo );
   void to_variant( const beekeeper::public_key_details& var, fc::variant& vo );
   void to_variant( const beekeeper::signature_return& var, fc::variant& vo );
+  void to_variant( const beekeeper::sign_digests_return& var, fc::variant& vo );
   void to_variant( const beekeeper::init_data& var, fc::variant& vo );
   void to_variant( const beekeeper::has_matching_private_key_return& var, fc::variant& vo );
   void to_variant( const beekeeper::encrypt_data_return& var, fc::variant& vo );
@@ -353,6 +377,9 @@ FC_REFLECT( beekeeper::list_wallets_return, (wallets) )
 FC_REFLECT( beekeeper::get_public_keys_return, (keys) )
 FC_REFLECT_DERIVED( beekeeper::sign_digest_args, (beekeeper::session_token_type), (sig_digest)(public_key)(wallet_name) )
 FC_REFLECT( beekeeper::signature_return, (signature) )
+FC_REFLECT( beekeeper::digest_to_sign, (sig_digest)(public_key) )
+FC_REFLECT_DERIVED( beekeeper::sign_digests_args, (beekeeper::session_token_type), (digests)(wallet_name) )
+FC_REFLECT( beekeeper::sign_digests_return, (signatures) )
 FC_REFLECT( beekeeper::create_session_args, (salt)(notifications_endpoint) )
 FC_REFLECT_DERIVED( beekeeper::get_public_keys_args, (beekeeper::session_token_type), (wallet_name) )
 FC_REFLECT_DERIVED( beekeeper::has_matching_private_key_args, (beekeeper::wallet_args), (public_key) )
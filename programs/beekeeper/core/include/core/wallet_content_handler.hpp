@@ -156,6 +156,10 @@ class wallet_content_handler
        */
       bool remove_key( const public_key_type& public_key );
 
+      /* Returns a private key corresponding to the given public_key (if it is in the wallet)
+      */
+      std::optional<private_key_type> try_get_private_key( const public_key_type& public_key ) const;
+
       /* Attempts to sign a digest via the given public_key
       */
       std::optional<signature_type> try_sign_digest( const digest_type& sig_digest, const public_key_type& public_key );
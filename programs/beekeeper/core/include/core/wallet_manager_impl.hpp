@@ -37,6 +37,7 @@ class wallet_manager_impl {
     std::vector<std::string> import_keys( const std::string& name, const std::vector<std::string>& wif_keys, const std::string& prefix );
     void remove_key( const std::string& name, const public_key_type& public_key );
     signature_type sign_digest( const std::optional<std::string>& wallet_name, const digest_type& sig_digest, const public_key_type& public_key, const std::string& prefix );
+    std::vector<signature_type> sign_digests( const std::optional<std::string>& wallet_name, const std::vector<std::pair<digest_type, public_key_type>>& digests, const std::string& prefix );
     bool has_matching_private_key( const std::string& wallet_name, const public_key_type& public_key );
     std::string encrypt_data( const public_key_type& from_public_key, const public_key_type& to_public_key, const std::string& wallet_name, const std::string& content, const std::optional<unsigned int>& nonce, const std::string& prefix );
     std::string decrypt_data( const public_key_type& from_public_key, const public_key_type& to_public_key, const std::string& wallet_name, const std::string& encrypted_content );
@@ -50,6 +51,7 @@ class wallet_manager_impl {
 
     const uint32_t max_password_length  = 128;
     const std::string file_ext          = ".wallet";
+    const size_t min_digests_per_thread = 64;
 
     boost::filesystem::path wallet_directory;
 
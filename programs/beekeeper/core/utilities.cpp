@@ -4,6 +4,14 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 namespace beekeeper {
 
   bool public_key_details::operator<( const public_key_details& obj ) const
@@ -17,6 +25,147 @@ namespace beekeeper {
     {
       return fc::git_revision_sha;
     }
+
+#ifndef __EMSCRIPTEN__
+    namespace
+    {
+      /**
+       * Threads shared by all `parallel_for` calls. Created once with one thread less than hardware concurrency
+       * (calling thread does its share of work), so concurrent calls never run more threads than that in total.
+       */
+      class worker_pool
+      {
+        public:
+
+          static worker_pool& instance()
+          {
+            static worker_pool _pool( std::max( std::thread::hardware_concurrency(), 1u ) - 1 );
+            return _pool;
+          }
+
+          size_t size() const { return _workers.size(); }
+
+          void post( std::function<void()>&& task )
+          {
+            {
+              std::lock_guard<std::mutex> _guard( _mtx );
+              _tasks.emplace_back( std::move( task ) );
+            }
+            _cv.notify_one();
+          }
+
+          ~worker_pool()
+          {
+            {
+              std::lock_guard<std::mutex> _guard( _mtx );
+              _stopping = true;
+            }
+            _cv.notify_all();
+            for( auto& _worker : _workers )
+              _worker.join();
+          }
+
+        private:
+
+          explicit worker_pool( size_t threads )
+          {
+            _workers.reserve( threads );
+            for( size_t i = 0; i < threads; ++i )
+              _workers.emplace_back( [this]() { run(); } );
+          }
+
+          void run()
+          {
+            while( true )
+            {
+              std::function<void()> _task;
+              {
+                std::unique_lock<std::mutex> _lock( _mtx );
+                _cv.wait( _lock, [this]() { return _stopping || !_tasks.empty(); } );
+                if( _tasks.empty() )
+                  return;
+                _task = std::move( _tasks.front() );
+                _tasks.pop_front();
+              }
+              _task();
+            }
+          }
+
+          std::mutex                          _mtx;
+          std::condition_variable             _cv;
+          std::deque<std::function<void()>>   _tasks;
+          bool                                _stopping = false;
+          std::vector<std::thread>            _workers;
+      };
+
+      struct parallel_for_state
+      {
+        parallel_for_state( size_t count, size_t chunk ) : count( count ), chunk( chunk ), remaining( ( count + chunk - 1 ) / chunk ) {}
+
+        const size_t              count;
+        const size_t              chunk;
+        std::atomic<size_t>       next_begin{ 0 };
+
+        std::mutex                mtx;
+        std::condition_variable   done;
+        size_t                    remaining;
+        std::exception_ptr        exception;
+      };
+
+      /// processes chunks until none is left; chunks are taken by whoever comes first, so calling thread never waits for chunk nobody started
+      void process_chunks( parallel_for_state& state, const std::function<void( size_t, size_t )>& work )
+      {
+        while( true )
+        {
+          const size_t _begin = state.next_begin.fetch_add( state.chunk );
+          if( _begin >= state.count )
+            return;
+
+          std::exception_ptr _exception;
+          try
+          {
+            work( _begin, std::min( _begin + state.chunk, state.count ) );
+          }
+          catch(...)
+          {
+            _exception = std::current_exception();
+          }
+
+          std::lock_guard<std::mutex> _guard( state.mtx );
+          if( _exception && !state.exception )
+            state.exception = _exception;
+          if( --state.remaining == 0 )
+            state.done.notify_one();
+        }
+      }
+    }
+#endif
+
+    void parallel_for( size_t count, size_t min_items_per_thread, const std::function<void( size_t, size_t )>& work )
+    {
+      size_t _threads = 1;
+#ifndef __EMSCRIPTEN__
+      _threads = std::min<size_t>( worker_pool::instance().size() + 1, count / std::max<size_t>( min_items_per_thread, 1 ) );
+#endif
+      if( _threads <= 1 )
+      {
+        work( 0, count );
+        return;
+      }
+
+#ifndef __EMSCRIPTEN__
+      // state outlives the call, because pool task can start after calling thread took all chunks and returned
+      auto _state = std::make_shared<parallel_for_state>( count, ( count + _threads - 1 ) / _threads );
+      for( size_t i = 1; i < _threads; ++i )
+        worker_pool::instance().post( [_state, &work]() { process_chunks( *_state, work ); } );
+      process_chunks( *_state, work );
+
+      std::unique_lock<std::mutex> _lock( _state->mtx );
+      _state->done.wait( _lock, [&]() { return _state->remaining == 0; } );
+      if( _state->exception )
+        std::rethrow_exception( _state->exception );
+#endif
+    }
   }
 
 }
@@ -82,6 +231,12 @@ namespace fc
     vo = v;
   }
 
+  void to_variant( const beekeeper::sign_digests_return& var, fc::variant& vo )
+  {
+    variant v = mutable_variant_object( "signatures", var.signatures );
+    vo = v;
+  }
+
   void to_variant( const beekeeper::init_data& var, fc::variant& vo )
   {
     variant v = mutable_variant_object( "status", var.status )( "version", var.version );
@@ -79,10 +79,9 @@ public:
   }
 
   /*
-    Imports the private key into the wallet
-    @returns `true` if the key matches a current key `false` otherwise
+    Converts WIF into private key and derives its public key (the expensive part of importing)
   */
-  std::pair<std::string, bool> import_key( const std::string& wif_key, const std::string& prefix )
+  key_detail_pair create_key_detail( const std::string& wif_key, const std::string& prefix ) const
   {
     auto priv = private_key_type::wif_to_key( wif_key );
     if( !priv.valid() )
@@ -90,15 +89,21 @@ public:
       FC_ASSERT( false, "Key can't be constructed" );
     }
 
-    public_key_type _wif_pub_key = priv->get_public_key();
+    return std::make_pair( priv->get_public_key(), std::make_pair( *priv, prefix ) );
+  }
 
-    key_detail_pair _new_item = std::make_pair( _wif_pub_key, std::make_pair( *priv, prefix ) );
-    std::string _str_wif_pub_key = utility::public_key::to_string( _new_item );
+  /*
+    Inserts already derived key into the wallet
+    @returns `true` if the key matches a current key `false` otherwise
+  */
+  std::pair<std::string, bool> insert_key( key_detail_pair&& new_item )
+  {
+    std::string _str_wif_pub_key = utility::public_key::to_string( new_item );
 
-    auto itr = _keys.find( _wif_pub_key );
+    auto itr = _keys.find( new_item.first );
     if( itr == _keys.end() )
     {
-      _keys.emplace( _new_item );
+      _keys.emplace( std::move( new_item ) );
       return { _str_wif_pub_key, true };
     }
 
@@ -108,13 +113,30 @@ public:
     return { _str_wif_pub_key, false };
   }
 
+  /*
+    Imports the private key into the wallet
+    @returns `true` if the key matches a current key `false` otherwise
+  */
+  std::pair<std::string, bool> import_key( const std::string& wif_key, const std::string& prefix )
+  {
+    return insert_key( create_key_detail( wif_key, prefix ) );
+  }
+
   std::vector<std::string> import_keys( const std::vector<std::string>& wif_keys, const std::string& prefix )
   {
+    //Derivation of public keys dominates the cost of big imports, so it is done in parallel before any key is inserted.
+    std::vector<key_detail_pair> _new_items( wif_keys.size() );
+    utility::parallel_for( wif_keys.size(), min_keys_per_thread, [&]( size_t begin, size_t end )
+    {
+      for( size_t _idx = begin; _idx < end; ++_idx )
+        _new_items[ _idx ] = create_key_detail( wif_keys[ _idx ], prefix );
+    } );
+
     std::vector<std::string> _result;
 
-    for( auto& wif_key : wif_keys )
+    for( auto& _new_item : _new_items )
     {
-      auto _status = import_key( wif_key, prefix );
+      auto _status = insert_key( std::move( _new_item ) );
       if( _status.second )
         _result.emplace_back( _status.first );
     }
@@ -205,6 +227,8 @@ public:
   mode_t        _old_umask;
 #endif
   const std::string _wallet_filename_extension = ".wallet";
+
+  const size_t min_keys_per_thread = 256;
 };
 
 }
@@ -361,6 +385,11 @@ private_key_type wallet_content_handler::get_private_key( public_key_type pubkey
   return my->get_private_key( pubkey );
 }
 
+std::optional<private_key_type> wallet_content_handler::try_get_private_key( const public_key_type& public_key ) const
+{
+  return my->try_get_private_key( public_key );
+}
+
 std::optional<signature_type> wallet_content_handler::try_sign_digest( const digest_type& sig_digest, const public_key_type& public_key )
 {
   return my->try_sign_digest( sig_digest, public_key );
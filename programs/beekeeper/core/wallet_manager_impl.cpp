@@ -360,6 +360,72 @@ signature_type wallet_manager_impl::sign_digest( const std::optional<std::string
   return sign( [&]( const wallet_content_handler_session& wallet ){ return wallet.get_content()->try_sign_digest( sig_digest, public_key ); }, wallet_name, public_key, prefix );
 }
 
+std::vector<signature_type> wallet_manager_impl::sign_digests( const std::optional<std::string>& wallet_name, const std::vector<std::pair<digest_type, public_key_type>>& digests, const std::string& prefix )
+{
+  //Every needed private key is looked up only once, no matter how many digests it signs.
+  std::map<public_key_type, std::optional<private_key_type>> _key_index;
+  for( const auto& _digest : digests )
+    _key_index.emplace( _digest.second, std::optional<private_key_type>() );
+
+  auto _process_wallet = [&]( const wallet_content_handler_session& wallet )
+  {
+    if( wallet.is_locked() )
+      return;
+    for( auto& _item : _key_index )
+    {
+      if( !_item.second )
+        _item.second = wallet.get_content()->try_get_private_key( _item.first );
+    }
+  };
+
+  if( wallet_name )
+  {
+    auto _wallet = content_deliverer.find( token, *wallet_name );
+    if( _wallet )
+    {
+      auto __wallet = *_wallet;
+      FC_ASSERT( __wallet );
+
+      _process_wallet( *__wallet );
+    }
+  }
+  else
+  {
+    const auto& _idx = content_deliverer.items.get<by_token>();
+    auto _itr = _idx.find( token );
+
+    while( _itr != _idx.end() && _itr->get_token() == token )
+    {
+      _process_wallet( *_itr );
+      ++_itr;
+    }
+  }
+
+  std::vector<const private_key_type*> _private_keys;
+  _private_keys.reserve( digests.size() );
+  for( const auto& _digest : digests )
+  {
+    const auto& _private_key = _key_index[ _digest.second ];
+    if( !_private_key )
+    {
+      if( wallet_name )
+        FC_ASSERT( false, "Public key ${public_key} not found in ${wallet} wallet", ("wallet", *wallet_name)("public_key", utility::public_key::to_string( _digest.second, prefix )));
+      else
+        FC_ASSERT( false, "Public key ${public_key} not found in unlocked wallets", ("public_key", utility::public_key::to_string( _digest.second, prefix )));
+    }
+    _private_keys.emplace_back( &( *_private_key ) );
+  }
+
+  std::vector<signature_type> _result( digests.size() );
+  utility::parallel_for( digests.size(), min_digests_per_thread, [&]( size_t begin, size_t end )
+  {
+    for( size_t _idx = begin; _idx < end; ++_idx )
+      _result[ _idx ] = _private_keys[ _idx ]->sign_compact( digests[ _idx ].first );
+  } );
+
+  return _result;
+}
+
 bool wallet_manager_impl::has_matching_private_key( const std::string& wallet_name, const public_key_type& public_key )
 {
   auto _wallet = content_deliverer.find( token, wallet_name );
@@ -20,7 +20,6 @@
 
 #include <boost/program_options.hpp>
 #include <boost/scope_exit.hpp>
-#include <boost/thread/barrier.hpp>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -37,6 +36,7 @@
 #include <queue>
 #include <atomic>
 #include <algorithm>
+#include <functional>
 
 #define CREATE_APP_AND_THREAD_POOL                                                                             \
   appbase::application theApp;                                                                                 \
@@ -82,6 +82,7 @@ struct extended_signed_block : public extended_signed_block_header
 struct block_log_hashes
 {
   fc::optional<fc::sha256> final_hash;
+  fc::optional<fc::sha256> merkle_root;
   std::map<uint32_t, fc::sha256> checkpoints;
 };
 typedef std::map<fc::path, block_log_hashes> block_logs_and_hashes_type;
@@ -123,6 +124,204 @@ void append_full_block_data(const std::shared_ptr<hive::chain::full_block_type>
   start_offset += uncompressed.raw_size + sizeof(start_offset);
 }
 
+// Runs task(i) for every i in [0, tasks_count) on up to threads_num threads, handing out tasks in ascending order.
+// After the first failure no new tasks are started, and the exception is rethrown in the calling thread.
+void run_in_parallel(const unsigned threads_num, const size_t tasks_count, const std::function<void(size_t)> &task, const std::string &thread_name)
+{
+  std::atomic<size_t> next_task = {0};
+  std::atomic<bool> failed = {false};
+  std::exception_ptr first_exception;
+  std::mutex exception_mutex;
+
+  const auto worker = [&](const unsigned worker_num)
+  {
+    const std::string name = thread_name + "_" + std::to_string(worker_num);
+    fc::set_thread_name(name.c_str()); // tells the OS the thread's name
+    fc::thread::current().set_name(name); // tells fc the thread's name for logging
+
+    for (size_t i = next_task++; i < tasks_count && !failed.load(std::memory_order_relaxed); i = next_task++)
+    {
+      try
+      {
+        task(i);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> guard(exception_mutex);
+        if (!first_exception)
+          first_exception = std::current_exception();
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  const unsigned workers_count = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads_num, tasks_count)));
+  std::vector<std::thread> workers;
+  workers.reserve(workers_count);
+  for (unsigned i = 0; i < workers_count; ++i)
+    workers.emplace_back(worker, i);
+  for (std::thread &worker_thread : workers)
+    worker_thread.join();
+
+  if (first_exception)
+    std::rethrow_exception(first_exception);
+}
+
+// Blocks are read from block_log in ranges of that size by the parallel operations (each worker decompresses its own blocks).
+constexpr uint32_t BLOCKS_READ_AT_ONCE = 1000;
+
+// Merkle checksum of block log is built over leaves of MERKLE_LEAF_BLOCKS consecutive blocks, aligned to absolute block
+// numbers (leaf n holds blocks n * MERKLE_LEAF_BLOCKS + 1 ... (n + 1) * MERKLE_LEAF_BLOCKS). Since part files of a split block
+// log are aligned the same way, leaves never cross files and all of them can be hashed independently. Leaf hash is sha256 of
+// uncompressed blocks, without offsets that legacy block_log puts after each block (those depend on all preceding blocks).
+// Leaf hashes are combined pairwise into a root (odd hash is promoted to the next level) and roots of part files are combined
+// the same way into checksum of the whole split block log.
+constexpr uint32_t MERKLE_LEAF_BLOCKS = 100000;
+static_assert(BLOCKS_IN_SPLIT_BLOCK_LOG_FILE % MERKLE_LEAF_BLOCKS == 0, "merkle leaves must not cross part files");
+
+fc::sha256 calculate_merkle_root(std::vector<fc::sha256> hashes)
+{
+  if (hashes.empty())
+    return fc::sha256();
+
+  size_t current_number_of_hashes = hashes.size();
+  while (current_number_of_hashes > 1)
+  {
+    const size_t i_max = current_number_of_hashes - (current_number_of_hashes & 1);
+    size_t k = 0;
+    for (size_t i = 0; i < i_max; i += 2)
+    {
+      fc::sha256::encoder encoder;
+      encoder.write(hashes[i].data(), hashes[i].data_size());
+      encoder.write(hashes[i + 1].data(), hashes[i + 1].data_size());
+      hashes[k++] = encoder.result();
+    }
+    if (current_number_of_hashes & 1)
+      hashes[k++] = hashes[i_max];
+    current_number_of_hashes = k;
+  }
+  return hashes.front();
+}
+
+fc::sha256 hash_merkle_leaf(const hive::chain::block_log &log, const uint32_t first_block_num, const uint32_t last_block_num)
+{
+  fc::sha256::encoder encoder;
+  for (uint32_t block_num = first_block_num; block_num <= last_block_num; block_num += BLOCKS_READ_AT_ONCE)
+  {
+    const uint32_t count = std::min(BLOCKS_READ_AT_ONCE, last_block_num - block_num + 1);
+    const auto full_blocks = log.read_block_range_by_num(block_num, count);
+    FC_ASSERT(full_blocks.size() == count, "Unable to read blocks ${block_num} - ${last}", (block_num)("last", block_num + count - 1));
+    for (const std::shared_ptr<hive::chain::full_block_type> &full_block : full_blocks)
+    {
+      const hive::chain::uncompressed_block_data &uncompressed = full_block->get_uncompressed_block();
+      encoder.write(uncompressed.raw_bytes.get(), uncompressed.raw_size);
+    }
+  }
+  return encoder.result();
+}
+
+// Part files found in given directory, ordered by part number.
+std::vector<fc::path> get_block_log_part_files(const fc::path &block_log_dir)
+{
+  std::map<uint32_t, fc::path> part_files;
+  for (fc::directory_iterator it(block_log_dir); it != fc::directory_iterator(); ++it)
+  {
+    const uint32_t part_number = block_log_info::is_part_file(*it);
+    if (part_number)
+      part_files[part_number] = *it;
+  }
+  FC_ASSERT(!part_files.empty(), "No block_log part files found in ${block_log_dir}", (block_log_dir));
+
+  std::vector<fc::path> result;
+  for (const auto &[part_number, part_file] : part_files)
+    result.push_back(part_file);
+  return result;
+}
+
+// Computes merkle roots of given block log files (in the same order). Leaves of all files are hashed by a single set of
+// workers, so even a single (legacy) file keeps all of them busy.
+std::vector<fc::sha256> merkle_checksum_block_logs(const std::vector<fc::path> &block_logs, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+{
+  struct merkle_leaf
+  {
+    size_t log_index;
+    uint32_t first_block_num;
+    uint32_t last_block_num;
+  };
+
+  std::vector<std::unique_ptr<hive::chain::block_log>> logs;
+  std::vector<merkle_leaf> leaves;
+  std::vector<size_t> first_leaf_of_log;
+  for (const fc::path &block_log : block_logs)
+  {
+    auto log = std::make_unique<hive::chain::block_log>(app);
+    log->open(block_log, thread_pool, true);
+    FC_ASSERT(log->head(), "Cannot operate on empty block_log ${block_log}", (block_log));
+
+    const uint32_t head_block_num = log->head()->get_block_num();
+    first_leaf_of_log.push_back(leaves.size());
+    for (uint32_t first_block_num = block_log_info::get_first_block_num_for_file_name(block_log); first_block_num <= head_block_num;)
+    {
+      const uint32_t leaf_last_block_num = std::min(head_block_num, ((first_block_num - 1) / MERKLE_LEAF_BLOCKS + 1) * MERKLE_LEAF_BLOCKS);
+      leaves.push_back({logs.size(), first_block_num, leaf_last_block_num});
+      first_block_num = leaf_last_block_num + 1;
+    }
+    logs.push_back(std::move(log));
+  }
+  first_leaf_of_log.push_back(leaves.size());
+
+  std::vector<fc::sha256> leaf_hashes(leaves.size());
+  std::atomic<size_t> hashed_leaves = {0};
+  run_in_parallel(threads_num, leaves.size(), [&](const size_t i)
+  {
+    const merkle_leaf &leaf = leaves[i];
+    leaf_hashes[i] = hash_merkle_leaf(*logs[leaf.log_index], leaf.first_block_num, leaf.last_block_num);
+    const size_t done = ++hashed_leaves;
+    if (done % 10 == 0)
+      dlog("hashed ${done} of ${total} merkle leaves", (done)("total", leaves.size()));
+  }, "merkle");
+
+  std::vector<fc::sha256> roots;
+  for (size_t i = 0; i < logs.size(); ++i)
+    roots.push_back(calculate_merkle_root(std::vector<fc::sha256>(leaf_hashes.begin() + first_leaf_of_log[i], leaf_hashes.begin() + first_leaf_of_log[i + 1])));
+  return roots;
+}
+
+// Merkle root of a block log file, or of a whole split block log when given a directory.
+fc::sha256 merkle_checksum(const fc::path &block_log, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+{
+  if (fc::is_directory(block_log))
+    return calculate_merkle_root(merkle_checksum_block_logs(get_block_log_part_files(block_log), threads_num, app, thread_pool));
+  return merkle_checksum_block_logs({block_log}, threads_num, app, thread_pool).front();
+}
+
+void merkle_checksum_block_log(const fc::path &block_log, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+{
+  try
+  {
+    if (fc::is_directory(block_log))
+    {
+      const std::vector<fc::path> part_files = get_block_log_part_files(block_log);
+      const std::vector<fc::sha256> part_roots = merkle_checksum_block_logs(part_files, threads_num, app, thread_pool);
+      for (size_t i = 0; i < part_files.size(); ++i)
+      {
+        ilog("Merkle root: ${root} ${block_log}", ("root", part_roots[i].str())("block_log", part_files[i]));
+        std::cout << part_roots[i].str() << " " << part_files[i].generic_string() << "@merkle\n";
+      }
+      const fc::sha256 root = calculate_merkle_root(part_roots);
+      ilog("Merkle root: ${root} ${block_log}", ("root", root.str())(block_log));
+      std::cout << root.str() << " " << block_log.generic_string() << "@merkle\n";
+    }
+    else
+    {
+      const fc::sha256 root = merkle_checksum_block_logs({block_log}, threads_num, app, thread_pool).front();
+      ilog("Merkle root: ${root} ${block_log}", ("root", root.str())(block_log));
+      std::cout << root.str() << " " << block_log.generic_string() << "@merkle\n";
+    }
+  }
+  FC_LOG_AND_RETHROW()
+}
+
 void checksum_block_log(const fc::path &block_log, fc::optional<uint32_t> checkpoint_every_n_blocks, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
 {
   try
@@ -172,10 +371,23 @@ void checksum_block_log(const fc::path &block_log, fc::optional<uint32_t> checkp
   FC_LOG_AND_RETHROW()
 }
 
-bool validate_block_log_checksum(const fc::path &block_log, const block_log_hashes &hashes_to_validate, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+bool validate_block_log_checksum(const fc::path &block_log, const block_log_hashes &hashes_to_validate, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
 {
   try
   {
+    bool merkle_root_matched = true;
+    if (hashes_to_validate.merkle_root)
+    {
+      merkle_root_matched = merkle_checksum(block_log, threads_num, app, thread_pool) == *hashes_to_validate.merkle_root;
+      if (merkle_root_matched)
+        ilog("${block_log}@merkle: OK", (block_log));
+      else
+        elog("${block_log}@merkle: FAILED", (block_log));
+
+      if (!hashes_to_validate.final_hash && hashes_to_validate.checkpoints.empty())
+        return merkle_root_matched;
+    }
+
     hive::chain::block_log log(app);
     log.open(block_log, thread_pool, true);
     FC_ASSERT(log.head(), "Cannot operate on empty block_log");
@@ -257,7 +469,7 @@ bool validate_block_log_checksum(const fc::path &block_log, const block_log_hash
         wlog("all checksums matched, but your block log contains ${block_num} blocks past the last checkpoint", ("block_num", head_block_num - *last_good_checkpoint_block_number));
     }
 
-    return all_hashes_matched;
+    return all_hashes_matched && merkle_root_matched;
   }
   FC_CAPTURE_AND_RETHROW()
 }
@@ -284,15 +496,22 @@ block_logs_and_hashes_type parse_checkpoints(const fc::path &checkpoints_file)
           std::string filename_and_block_num = line.substr(filename_start);
           std::string filename;
           fc::optional<uint32_t> block_number;
+          bool is_merkle_root = false;
           size_t asperand_pos = filename_and_block_num.find('@');
           if (asperand_pos != std::string::npos)
           {
             filename = filename_and_block_num.substr(0, asperand_pos);
-            block_number = stoul(filename_and_block_num.substr(asperand_pos + 1));
+            const std::string suffix = filename_and_block_num.substr(asperand_pos + 1);
+            if (suffix == "merkle")
+              is_merkle_root = true;
+            else
+              block_number = stoul(suffix);
           }
           else
             filename = filename_and_block_num;
-          if (block_number)
+          if (is_merkle_root)
+            result[filename].merkle_root = hash;
+          else if (block_number)
             result[filename].checkpoints[*block_number] = hash;
           else
             result[filename].final_hash = hash;
@@ -304,19 +523,26 @@ block_logs_and_hashes_type parse_checkpoints(const fc::path &checkpoints_file)
   FC_CAPTURE_AND_RETHROW()
 }
 
-bool validate_block_log_checksums_from_file(const fc::path &checksums_file, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+bool validate_block_log_checksums_from_file(const fc::path &checksums_file, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
 {
   try
   {
-    block_logs_and_hashes_type hashes_in_checksums_file = parse_checkpoints(checksums_file);
-    unsigned fail_count = 0;
-    for (const auto &[block_log, hashes_to_validate] : hashes_in_checksums_file)
-      if (!validate_block_log_checksum(block_log, hashes_to_validate, app, thread_pool))
+    const block_logs_and_hashes_type hashes_in_checksums_file = parse_checkpoints(checksums_file);
+    const std::vector<block_logs_and_hashes_type::value_type> block_logs_to_validate(hashes_in_checksums_file.begin(), hashes_in_checksums_file.end());
+    // block logs (usually part files of split block log) are independent, so they are validated concurrently; workers left
+    // over when there are fewer files than jobs are shared out to merkle checksums computed within each of them
+    const unsigned threads_per_block_log = std::max<unsigned>(1, threads_num / std::max<size_t>(1, std::min<size_t>(threads_num, block_logs_to_validate.size())));
+    std::atomic<unsigned> fail_count = {0};
+    run_in_parallel(threads_num, block_logs_to_validate.size(), [&](const size_t i)
+    {
+      const auto &[block_log, hashes_to_validate] = block_logs_to_validate[i];
+      if (!validate_block_log_checksum(block_log, hashes_to_validate, threads_per_block_log, app, thread_pool))
         ++fail_count;
+    }, "validate");
     if (fail_count)
     {
       std::cerr << "checksums file had " << fail_count << " checksums that did NOT match\n";
-      elog("checksums file had ${fail_count} checksums that did NOT match", (fail_count));
+      elog("checksums file had ${fail_count} checksums that did NOT match", ("fail_count", fail_count.load()));
     }
     else
     {
@@ -329,7 +555,7 @@ bool validate_block_log_checksums_from_file(const fc::path &checksums_file, appb
 }
 
 bool compare_block_logs(const fc::path &first_filename, const fc::path &second_filename,
-                        const int32_t first_block_arg, const int32_t last_block_arg, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
+                        const int32_t first_block_arg, const int32_t last_block_arg, const unsigned threads_num, appbase::application &app, hive::chain::blockchain_worker_thread_pool &thread_pool)
 {
   try
   {
@@ -361,64 +587,55 @@ bool compare_block_logs(const fc::path &first_filename, const fc::path &second_f
     const uint32_t first_block_to_compare = first_log_first_block_num;
     const uint32_t last_block_to_compare = first_log_last_block_num;
 
-    // set up to loop through all the blocks.  we'll be doing two for_each_block calls in parallel,
-    // and we don't know whether we'll get the blocks from the first or second block log first.
-    // when we get the block, store it in the variable below.  once we have both, compare
-    std::shared_ptr<hive::chain::full_block_type> first_full_block;
-    std::shared_ptr<hive::chain::full_block_type> second_full_block;
+    // split the range into chunks compared independently by worker threads, each of them reading its blocks from both
+    // block logs and decompressing them itself.  Chunks are handed out in order, so once a difference is found, only
+    // chunks below it still need to be finished to tell the first differing block
+    constexpr uint32_t COMPARE_CHUNK_BLOCKS = 10000;
+    const size_t chunks_count = (last_block_to_compare - first_block_to_compare) / COMPARE_CHUNK_BLOCKS + 1;
 
-    // if our compare fails, store the fact in these variables
-    fc::optional<uint32_t> mismatch_on_block_number;
-    std::atomic<bool> mismatch_detected = {false};
+    // if our compare fails, store the lowest differing block number here
+    std::atomic<uint32_t> mismatch_on_block_number = {std::numeric_limits<uint32_t>::max()};
 
-    const auto compare_blocks = [&]()
+    const auto report_mismatch = [&](const uint32_t block_num)
     {
-      const hive::chain::uncompressed_block_data &first_uncompressed = first_full_block->get_uncompressed_block();
-      const hive::chain::uncompressed_block_data &second_uncompressed = second_full_block->get_uncompressed_block();
-      if (first_uncompressed.raw_size != second_uncompressed.raw_size ||
-          memcmp(first_uncompressed.raw_bytes.get(), second_uncompressed.raw_bytes.get(), first_uncompressed.raw_size) != 0)
-      {
-        mismatch_on_block_number = first_full_block->get_block_num();
-        mismatch_detected.store(true, std::memory_order_release);
-      }
-      // not strictly necessary
-      first_full_block = nullptr;
-      second_full_block = nullptr;
+      uint32_t current = mismatch_on_block_number.load(std::memory_order_relaxed);
+      while (block_num < current && !mismatch_on_block_number.compare_exchange_weak(current, block_num, std::memory_order_relaxed))
+        ;
     };
 
-    boost::barrier sync_point(2, compare_blocks);
-
-    const auto generate_block_processor = [&](std::shared_ptr<hive::chain::full_block_type> &destination)
+    run_in_parallel(threads_num, chunks_count, [&](const size_t chunk)
     {
-      return [&](const std::shared_ptr<hive::chain::full_block_type> &full_block)
+      const uint32_t chunk_first_block_num = first_block_to_compare + static_cast<uint32_t>(chunk * COMPARE_CHUNK_BLOCKS);
+      const uint32_t chunk_last_block_num = std::min(last_block_to_compare, chunk_first_block_num + (COMPARE_CHUNK_BLOCKS - 1));
+      for (uint32_t block_num = chunk_first_block_num; block_num <= chunk_last_block_num; block_num += BLOCKS_READ_AT_ONCE)
       {
-        destination = full_block;
-        sync_point.wait();
-        return !mismatch_detected.load(std::memory_order_relaxed);
-      };
-    };
-
-    // walk through the blocks, comparing as we go
-    std::thread first_enumerator_thread([&]()
-                                        {
-      fc::set_thread_name("compare_1"); // tells the OS the thread's name
-      fc::thread::current().set_name("compare_1"); // tells fc the thread's name for logging
-      first_block_log.for_each_block(first_block_to_compare, last_block_to_compare, generate_block_processor(first_full_block), hive::chain::block_log::for_each_purpose::decompressing, thread_pool); });
+        if (block_num > mismatch_on_block_number.load(std::memory_order_relaxed))
+          return; // difference already found below this point
 
-    std::thread second_enumerator_thread([&]()
-                                         {
-      fc::set_thread_name("compare_2"); // tells the OS the thread's name
-      fc::thread::current().set_name("compare_2"); // tells fc the thread's name for logging
-      second_block_log.for_each_block(first_block_to_compare, last_block_to_compare, generate_block_processor(second_full_block), hive::chain::block_log::for_each_purpose::decompressing, thread_pool); });
+        const uint32_t count = std::min(BLOCKS_READ_AT_ONCE, chunk_last_block_num - block_num + 1);
+        const auto first_full_blocks = first_block_log.read_block_range_by_num(block_num, count);
+        const auto second_full_blocks = second_block_log.read_block_range_by_num(block_num, count);
+        FC_ASSERT(first_full_blocks.size() == count && second_full_blocks.size() == count, "Unable to read blocks ${block_num} - ${last}", (block_num)("last", block_num + count - 1));
 
-    first_enumerator_thread.join();
-    second_enumerator_thread.join();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+          const hive::chain::uncompressed_block_data &first_uncompressed = first_full_blocks[i]->get_uncompressed_block();
+          const hive::chain::uncompressed_block_data &second_uncompressed = second_full_blocks[i]->get_uncompressed_block();
+          if (first_uncompressed.raw_size != second_uncompressed.raw_size ||
+              memcmp(first_uncompressed.raw_bytes.get(), second_uncompressed.raw_bytes.get(), first_uncompressed.raw_size) != 0)
+          {
+            report_mismatch(block_num + i);
+            return;
+          }
+        }
+      }
+    }, "compare");
 
     // check the results
-    if (mismatch_detected.load(std::memory_order_relaxed))
+    if (mismatch_on_block_number.load(std::memory_order_relaxed) != std::numeric_limits<uint32_t>::max())
     {
-      elog("${first_filename} and ${second_filename} differ at block: ${mismatch_on_block_number}", (first_filename)(second_filename)(mismatch_on_block_number));
-      std::cerr << "Both block_logs differ at block: " << *mismatch_on_block_number << "\n";
+      elog("${first_filename} and ${second_filename} differ at block: ${mismatch_on_block_number}", (first_filename)(second_filename)("mismatch_on_block_number", mismatch_on_block_number.load()));
+      std::cerr << "Both block_logs differ at block: " << mismatch_on_block_number.load() << "\n";
       return false;
     }
     else
@@ -467,12 +684,8 @@ bool truncate_block_log(const fc::path &block_log_filename, uint32_t new_head_bl
 // flags/offset byte that's written at the end of each block.  Used for when you have a corrupt block log
 // and need to find the last complete block.
 // if it looked reasonable, returns the start of the block it would point at
-fc::optional<uint64_t> is_data_at_file_position_a_plausible_offset_and_flags(int block_log_fd, uint64_t offset_of_pos_and_flags)
+fc::optional<uint64_t> is_plausible_offset_and_flags(uint64_t block_offset_with_flags, uint64_t offset_of_pos_and_flags)
 {
-  uint64_t block_offset_with_flags;
-  hive::utilities::perform_read(block_log_fd, (char *)&block_offset_with_flags, sizeof(block_offset_with_flags),
-                                offset_of_pos_and_flags, "read block offset");
-
   const auto [offset, flags] = hive::chain::detail::split_block_start_pos_with_flags(block_offset_with_flags);
   ddump((offset));
 
@@ -497,6 +710,14 @@ fc::optional<uint64_t> is_data_at_file_position_a_plausible_offset_and_flags(int
   return offset_is_plausible && flags_are_plausible && dictionary_is_plausible ? offset : fc::optional<uint64_t>();
 }
 
+fc::optional<uint64_t> is_data_at_file_position_a_plausible_offset_and_flags(int block_log_fd, uint64_t offset_of_pos_and_flags)
+{
+  uint64_t block_offset_with_flags;
+  hive::utilities::perform_read(block_log_fd, (char *)&block_offset_with_flags, sizeof(block_offset_with_flags),
+                                offset_of_pos_and_flags, "read block offset");
+  return is_plausible_offset_and_flags(block_offset_with_flags, offset_of_pos_and_flags);
+}
+
 bool find_end(const fc::path &block_log_filename)
 {
   try
@@ -513,10 +734,19 @@ bool find_end(const fc::path &block_log_filename)
     const uint64_t block_log_size = file_stats.st_size;
     FC_ASSERT(block_log_size >= (ssize_t)sizeof(uint64_t));
 
+    // the end of the last complete block can't be further back than the max block size, so read all of that at once
+    // instead of reading candidate positions one by one
+    const uint64_t tail_size = std::min<uint64_t>(block_log_size, HIVE_MAX_BLOCK_SIZE + sizeof(uint64_t));
+    const uint64_t tail_offset = block_log_size - tail_size;
+    std::unique_ptr<char[]> tail(new char[tail_size]);
+    hive::utilities::perform_read(block_log_fd, tail.get(), tail_size, tail_offset, "read end of block log");
+
     uint64_t offset_of_pos_and_flags = block_log_size - sizeof(uint64_t);
     for (int i = 0; i < HIVE_MAX_BLOCK_SIZE; ++i)
     {
-      fc::optional<uint64_t> possible_start_of_block = is_data_at_file_position_a_plausible_offset_and_flags(block_log_fd, offset_of_pos_and_flags);
+      uint64_t block_offset_with_flags;
+      memcpy(&block_offset_with_flags, tail.get() + (offset_of_pos_and_flags - tail_offset), sizeof(block_offset_with_flags));
+      fc::optional<uint64_t> possible_start_of_block = is_plausible_offset_and_flags(block_offset_with_flags, offset_of_pos_and_flags);
       if (possible_start_of_block)
       {
         dlog("found possible end of the block log, double-checking...");
@@ -930,7 +1160,7 @@ bool merge_block_logs(const fc::path &input_block_log_dir, const fc::path &outpu
 int main(int argc, char **argv)
 {
   boost::program_options::options_description minor_options("Minor options");
-  minor_options.add_options()("jobs,j", boost::program_options::value<unsigned>()->default_value(4), "The number of worker threads to spawn. (max 16)");
+  minor_options.add_options()("jobs,j", boost::program_options::value<unsigned>()->default_value(4), "The number of worker threads to spawn. (0 means one per available core)");
   minor_options.add_options()("help,h", "Print usage instructions");
   minor_options.add_options()("version,v", "Print version info.");
   minor_options.add_options()("log-path,l", boost::program_options::value<boost::filesystem::path>()->value_name("filename")->default_value("./block_log_util.log"), "Path to log file. All logs are saved into this file.");
@@ -960,6 +1190,7 @@ int main(int argc, char **argv)
   // args for sha256sum subcommand
   boost::program_options::options_description sha256sum_options("sha256sum options");
   sha256sum_options.add_options()("checkpoint", boost::program_options::value<uint32_t>()->value_name("n"), "Print the SHA256 every n blocks");
+  sha256sum_options.add_options()("merkle", "Print merkle root of block contents instead of SHA256 of the file, computed using all jobs. Accepts directory with split block log, printing roots of all part files and the combined one.");
 
   // args for compare subcommand
   boost::program_options::options_description cmp_options("compare options");
@@ -1063,8 +1294,8 @@ int main(int argc, char **argv)
     update_options_map(block_log_operations);
     update_options_map(additional_operations);
 
-    const unsigned threads_num = options_map["jobs"].as<unsigned>();
-    FC_ASSERT(threads_num <= 16, "jobs limit is 16, cannot use ${threads_num}", (threads_num));
+    const unsigned jobs = options_map["jobs"].as<unsigned>();
+    const unsigned threads_num = jobs ? jobs : std::max(1u, std::thread::hardware_concurrency());
     options_map.erase("jobs");
 
     fc::logging_config logging_config;
@@ -1114,7 +1345,7 @@ int main(int argc, char **argv)
       CREATE_APP_AND_THREAD_POOL
 
       dlog("block_log_util will perform verify-checksums-from-file operation on file: ${path_to_file}", (path_to_file));
-      return validate_block_log_checksums_from_file(path_to_file, theApp, thread_pool) ? 0 : 1;
+      return validate_block_log_checksums_from_file(path_to_file, threads_num, theApp, thread_pool) ? 0 : 1;
     }
     else if (options_map.count("merge-block-logs"))
     {
@@ -1206,7 +1437,7 @@ int main(int argc, char **argv)
         const fc::path second_block_log_path = options_map["second-block-log"].as<boost::filesystem::path>();
         const auto [first_block, last_block] = get_first_and_last_block_from_options();
         dlog("block_log_util will perform compare operation between block_log: ${block_log_path} and ${second_block_log_path}, from: ${first_block}, to: ${last_block}", (block_log_path)(second_block_log_path)(first_block)(last_block));
-        return compare_block_logs(block_log_path, second_block_log_path, first_block, last_block, theApp, thread_pool) ? 0 : 1;
+        return compare_block_logs(block_log_path, second_block_log_path, first_block, last_block, threads_num, theApp, thread_pool) ? 0 : 1;
       }
       else if (options_map.count("find-end"))
       {
@@ -1261,8 +1492,13 @@ int main(int argc, char **argv)
       {
         update_options_map(sha256sum_options);
         const fc::optional<uint32_t> checkpoint_every_n_blocks = options_map.count("checkpoint") ? options_map["checkpoint"].as<uint32_t>() : fc::optional<uint32_t>();
-        dlog("block_log_util will perform sha256sum operation on block_log: ${block_log_path}, checkpoint_every_n_blocks: ${checkpoint_every_n_blocks}", (block_log_path)(checkpoint_every_n_blocks));
-        checksum_block_log(block_log_path, checkpoint_every_n_blocks, theApp, thread_pool);
+        const bool merkle = options_map.count("merkle") != 0;
+        FC_ASSERT(!merkle || !checkpoint_every_n_blocks, "'--merkle' cannot be used with '--checkpoint'");
+        dlog("block_log_util will perform sha256sum operation on block_log: ${block_log_path}, checkpoint_every_n_blocks: ${checkpoint_every_n_blocks}, merkle: ${merkle}", (block_log_path)(checkpoint_every_n_blocks)(merkle));
+        if (merkle)
+          merkle_checksum_block_log(block_log_path, threads_num, theApp, thread_pool);
+        else
+          checksum_block_log(block_log_path, checkpoint_every_n_blocks, theApp, thread_pool);
       }
       else if (options_map.count("split"))
       {
@@ -0,0 +1,167 @@
+/**
+ * Compares allocation of index nodes straight from segment manager (chainbase::allocator) with allocation from
+ * node pools (chainbase::node_allocator, used by generic_index for nodes of its containers and undo state).
+ * First measures bare allocate/deallocate of node sized blocks, then multi_index_container with the two allocators
+ * under churn resembling state of a running node: objects are created and removed all the time, so after a while
+ * new nodes fill holes left by removed ones. Scan of the whole container at the end shows effect on locality.
+ */
+
+#include <chainbase/allocators.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bfs = boost::filesystem;
+namespace bmi = boost::multi_index;
+
+namespace {
+
+/// roughly size of typical state object (f.e. comment vote)
+struct item
+{
+  item( uint64_t _id, uint64_t _key ) : id( _id ), key( _key ) {}
+
+  uint64_t id = 0;
+  uint64_t key = 0;
+  char     payload[ 64 ] = {};
+};
+
+struct by_key;
+
+template< typename Allocator >
+using item_index = bmi::multi_index_container< item,
+  bmi::indexed_by<
+    bmi::ordered_unique< bmi::member< item, uint64_t, &item::id > >,
+    bmi::ordered_non_unique< bmi::tag< by_key >, bmi::member< item, uint64_t, &item::key > >
+  >,
+  Allocator
+>;
+
+template< typename Action >
+void measure( const std::string& name, uint64_t operations, Action&& action )
+{
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t checksum = action();
+  const auto duration = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start );
+
+  std::cout << name << ": " << double( duration.count() ) / operations << " ns/op (checksum " << checksum << ")" << std::endl;
+}
+
+template< typename Allocator >
+void benchmark_allocator( const std::string& name, Allocator allocator, size_t count, uint32_t rounds )
+{
+  typedef typename Allocator::pointer pointer;
+  std::vector< pointer > nodes( count );
+  std::mt19937 generator( 42 );
+
+  measure( name + " allocate/deallocate", uint64_t( count ) * rounds * 2, [&]()
+  {
+    for( auto& node : nodes )
+      node = allocator.allocate( 1 );
+    for( uint32_t round = 1; round < rounds; ++round )
+    {
+      // free random half and allocate it again
+      for( size_t i = 0; i < count / 2; ++i )
+      {
+        auto& node = nodes[ generator() % count ];
+        if( node == nullptr )
+          continue;
+        allocator.deallocate( node, 1 );
+        node = nullptr;
+      }
+      for( auto& node : nodes )
+        if( node == nullptr )
+          node = allocator.allocate( 1 );
+    }
+    for( auto& node : nodes )
+      allocator.deallocate( node, 1 );
+    return uint64_t( count );
+  } );
+}
+
+template< typename Index, typename Allocator >
+void benchmark_index( const std::string& name, const Allocator& allocator, size_t count, uint32_t rounds )
+{
+  Index index( allocator );
+  std::mt19937 generator( 42 );
+  uint64_t next_id = 0;
+
+  measure( name + " emplace/erase", uint64_t( count ) * rounds, [&]()
+  {
+    for( size_t i = 0; i < count; ++i )
+      index.emplace( next_id++, generator() );
+    for( uint32_t round = 1; round < rounds; ++round )
+    {
+      // remove random tenth of objects, then create as many new ones
+      auto& by_key_idx = index.template get< by_key >();
+      for( size_t i = 0; i < count / 10; ++i )
+      {
+        auto it = by_key_idx.lower_bound( generator() );
+        if( it != by_key_idx.end() )
+          by_key_idx.erase( it );
+      }
+      while( index.size() < count )
+        index.emplace( next_id++, generator() );
+    }
+    return uint64_t( index.size() );
+  } );
+
+  measure( name + " scan by key", uint64_t( index.size() ) * rounds, [&]()
+  {
+    uint64_t checksum = 0;
+    for( uint32_t round = 0; round < rounds; ++round )
+      for( const auto& i : index.template get< by_key >() )
+        checksum += i.id;
+    return checksum;
+  } );
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  const size_t count = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 1000000;
+  const uint32_t rounds = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 10;
+  const bfs::path dir = bfs::temp_directory_path() / bfs::unique_path();
+
+  try
+  {
+    bfs::create_directories( dir );
+    const size_t file_size = ( count * 512 ) + ( 64 << 20 );
+    std::cout << "objects: " << count << ", rounds: " << rounds << ", sizeof(item): " << sizeof( item ) << std::endl;
+
+    {
+      chainbase::bip::managed_mapped_file segment( chainbase::bip::create_only, ( dir / "allocator.bin" ).generic_string().c_str(), file_size );
+      benchmark_allocator( "segment manager", chainbase::allocator< item >( segment.get_segment_manager() ), count, rounds );
+      benchmark_allocator( "node pool", chainbase::node_allocator< item >( segment.get_segment_manager() ), count, rounds );
+    }
+    {
+      chainbase::bip::managed_mapped_file segment( chainbase::bip::create_only, ( dir / "index.bin" ).generic_string().c_str(), file_size );
+      benchmark_index< item_index< chainbase::allocator< item > > >( "segment manager",
+        chainbase::allocator< item >( segment.get_segment_manager() ), count, rounds );
+    }
+    {
+      chainbase::bip::managed_mapped_file segment( chainbase::bip::create_only, ( dir / "pooled_index.bin" ).generic_string().c_str(), file_size );
+      benchmark_index< item_index< chainbase::node_allocator< item > > >( "node pool",
+        chainbase::node_allocator< item >( segment.get_segment_manager() ), count, rounds );
+    }
+  }
+  catch( const std::exception& e )
+  {
+    std::cerr << e.what() << std::endl;
+    bfs::remove_all( dir );
+    return 1;
+  }
+
+  bfs::remove_all( dir );
+  return 0;
+}
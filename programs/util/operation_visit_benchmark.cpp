@@ -0,0 +1,217 @@
+/**
+ * Measures cost of visiting hive::protocol::operation (static_variant with close to a hundred alternatives) for
+ * operation mix resembling mainnet blocks: votes and custom_jsons dominate, most of the rest are virtual
+ * operations generated by them. For comparison the same visitor is dispatched with recursive chain of tag
+ * compares, the way static_variant used to do it. Also reports memory taken by the mix once decoded.
+ */
+
+#include <hive/protocol/operations.hpp>
+#include <hive/protocol/forward_impacted.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <malloc.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace hive::protocol;
+
+namespace {
+
+/// cheap visitor, so the measurement is dominated by dispatch itself
+struct size_visitor
+{
+  typedef uint64_t result_type;
+
+  template< typename T >
+  uint64_t operator()( const T& )const { return sizeof( T ); }
+};
+
+template< int64_t N, typename... Ts >
+struct linear_dispatch;
+
+template< int64_t N, typename T, typename... Ts >
+struct linear_dispatch< N, T, Ts... >
+{
+  template< typename Visitor >
+  static typename Visitor::result_type apply( const operation& op, const Visitor& v )
+  {
+    if( op.which() == N )
+      return v( op.get< T >() );
+    return linear_dispatch< N + 1, Ts... >::apply( op, v );
+  }
+};
+
+template< int64_t N >
+struct linear_dispatch< N >
+{
+  template< typename Visitor >
+  static typename Visitor::result_type apply( const operation&, const Visitor& )
+  {
+    FC_THROW_EXCEPTION( fc::assert_exception, "Invalid tag" );
+  }
+};
+
+template< typename Variant >
+struct linear_visit;
+
+template< typename... Ts >
+struct linear_visit< fc::static_variant< Ts... > >
+{
+  template< typename Visitor >
+  static typename Visitor::result_type apply( const operation& op, const Visitor& v )
+  {
+    return linear_dispatch< 0, Ts... >::apply( op, v );
+  }
+};
+
+std::vector< operation > build_operation_mix( size_t count )
+{
+  const asset hive_amount( 1000, HIVE_SYMBOL );
+  const asset vests_amount( 1000000, VESTS_SYMBOL );
+
+  vote_operation vote;
+  vote.voter = "alice";
+  vote.author = "bob";
+  vote.permlink = "some-post-permlink";
+  vote.weight = HIVE_100_PERCENT;
+
+  custom_json_operation custom_json;
+  custom_json.required_posting_auths.insert( "alice" );
+  custom_json.id = "follow";
+  custom_json.json = "[\"follow\",{\"follower\":\"alice\",\"following\":\"bob\",\"what\":[\"blog\"]}]";
+
+  comment_operation comment;
+  comment.parent_author = "bob";
+  comment.parent_permlink = "some-post-permlink";
+  comment.author = "alice";
+  comment.permlink = "re-some-post-permlink";
+  comment.body = "Nice post!";
+
+  transfer_operation transfer;
+  transfer.from = "alice";
+  transfer.to = "bob";
+  transfer.amount = hive_amount;
+  transfer.memo = "memo";
+
+  claim_reward_balance_operation claim;
+  claim.account = "alice";
+  claim.reward_vests = vests_amount;
+
+  limit_order_create_operation order;
+  order.owner = "alice";
+  order.amount_to_sell = hive_amount;
+  order.min_to_receive = asset( 300, HBD_SYMBOL );
+
+  feed_publish_operation feed;
+  feed.publisher = "alice";
+  feed.exchange_rate = price( asset( 300, HBD_SYMBOL ), hive_amount );
+
+  effective_comment_vote_operation effective_vote;
+  effective_vote.voter = "alice";
+  effective_vote.author = "bob";
+  effective_vote.permlink = "some-post-permlink";
+
+  curation_reward_operation curation;
+  curation.curator = "alice";
+  curation.author = "bob";
+  curation.permlink = "some-post-permlink";
+
+  author_reward_operation author_reward;
+  author_reward.author = "bob";
+  author_reward.permlink = "some-post-permlink";
+
+  producer_reward_operation producer_reward( "alice", vests_amount );
+
+  // approximate shares (in percent) of operations in recent mainnet blocks, including virtual ones
+  const std::vector< std::pair< operation, uint32_t > > mix = {
+    { vote, 30 }, { effective_vote, 30 }, { custom_json, 25 }, { comment, 3 }, { transfer, 3 },
+    { curation, 3 }, { claim, 2 }, { author_reward, 1 }, { order, 1 }, { feed, 1 }, { producer_reward, 1 }
+  };
+  std::vector< uint32_t > weights;
+  for( const auto& item : mix )
+    weights.push_back( item.second );
+
+  std::mt19937 generator( 42 );
+  std::discrete_distribution< size_t > distribution( weights.begin(), weights.end() );
+  std::vector< operation > result;
+  result.reserve( count );
+  for( size_t i = 0; i < count; ++i )
+    result.push_back( mix[ distribution( generator ) ].first );
+  return result;
+}
+
+template< typename Action >
+void measure( const char* name, const std::vector< operation >& ops, uint32_t rounds, Action&& action )
+{
+  uint64_t checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for( uint32_t round = 0; round < rounds; ++round )
+    for( const auto& op : ops )
+      checksum += action( op );
+  const auto duration = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - start );
+
+  std::cout << name << ": " << double( duration.count() ) / ( double( ops.size() ) * rounds ) << " ns/op"
+            << " (checksum " << checksum << ")" << std::endl;
+}
+
+/// heap taken by operations unpacked from their binary form, like in decoded blocks and transactions
+void measure_footprint( const std::vector< operation >& ops )
+{
+  std::vector< std::vector< char > > packed;
+  packed.reserve( ops.size() );
+  for( const auto& op : ops )
+    packed.emplace_back( fc::raw::pack_to_vector( op ) );
+
+  // big blocks are mmapped and not counted as part of regular heap
+  const auto heap_in_use = []() { const auto info = mallinfo2(); return info.uordblks + info.hblkhd; };
+  const auto before = heap_in_use();
+  std::vector< operation > decoded( ops.size() );
+  for( size_t i = 0; i < ops.size(); ++i )
+    fc::raw::unpack_from_vector( packed[i], decoded[i] );
+  const auto after = heap_in_use();
+
+  std::cout << "sizeof(operation): " << sizeof( operation ) << " bytes, decoded operation mix: "
+            << double( after - before ) / ops.size() << " bytes/op" << std::endl;
+}
+
+} // namespace
+
+int main( int argc, char** argv )
+{
+  const size_t count = argc > 1 ? std::strtoull( argv[1], nullptr, 10 ) : 100000;
+  const uint32_t rounds = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 100;
+
+  try
+  {
+    const auto ops = build_operation_mix( count );
+    std::cout << "operation alternatives: " << operation::count() << ", operations: " << ops.size()
+              << ", rounds: " << rounds << std::endl;
+    measure_footprint( ops );
+
+    const size_visitor visitor;
+    measure( "visit (static_variant)", ops, rounds, [&]( const operation& op ) { return op.visit( visitor ); } );
+    measure( "visit (recursive compare chain)", ops, rounds,
+      [&]( const operation& op ) { return linear_visit< operation >::apply( op, visitor ); } );
+    measure( "fc::raw::pack_size", ops, rounds / 10 + 1,
+      [&]( const operation& op ) { return fc::raw::pack_size( op ); } );
+    measure( "operation_get_impacted_accounts", ops, rounds / 10 + 1, [&]( const operation& op )
+    {
+      fc::flat_set< account_name_type > impacted;
+      hive::app::operation_get_impacted_accounts( op, impacted );
+      return impacted.size();
+    } );
+  }
+  catch( const fc::exception& e )
+  {
+    std::cerr << e.to_detail_string() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
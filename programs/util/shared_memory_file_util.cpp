@@ -7,10 +7,12 @@
 #include <fc/log/console_appender.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/filesystem.hpp>
+#include <fc/string.hpp>
 
 #include <chainbase/chainbase.hpp>
 
 #include <hive/chain/util/decoded_types_data_storage.hpp>
+#include <hive/chain/util/shared_memory_compaction.hpp>
 
 #include <hive/chain/account_object.hpp>
 #include <hive/chain/block_summary_object.hpp>
@@ -36,6 +38,8 @@
 
 #include <chrono>
 #include <fstream>
+#include <functional>
+#include <set>
 #include <sstream>
 #include <iostream>
 
@@ -230,7 +234,7 @@ namespace shared_memory_file_util
   public:
     App(const boost::filesystem::path &_path_to_shared_memory_file_dir, const boost::filesystem::path &_output_dir, const bool _get_all_data,
         const bool _get_decoded_state_objects_data, const bool _get_details, const bool _get_blockchain_config, const bool _list_plugins,
-        const bool _list_indices, const bool _dump_indices, const uint8_t _dump_threads);
+        const bool _list_indices, const bool _dump_indices, const uint8_t _dump_threads, const bool _compact, const size_t _compact_file_size);
     ~App();
     void work();
 
@@ -245,11 +249,19 @@ namespace shared_memory_file_util
     const bool list_indices;
     const bool dump_indices;
     const uint8_t dump_threads;
+    const bool compact;
+    const size_t compact_file_size;
+
+    // for each index detected in shared memory file: adds the same index to other database (used when compacting)
+    std::vector<std::function<void(chainbase::database&)>> detected_index_adders;
+    // names under which detected indices are stored in shared memory file
+    std::set<std::string> detected_index_segment_names;
 
     void read_decoded_state_objects_data() const;
     void read_shared_memory_file_details();
     void initialize_indices();
     void perform_dump_indices();
+    void compact_shared_memory_file();
     void read_blockchain_config() const;
     void read_plugins() const;
     void log_result(const std::string& content, const std::string& content_type, const std::string& filename) const;
@@ -262,6 +274,8 @@ namespace shared_memory_file_util
       try
       {
         db.add_index<T>();
+        detected_index_adders.emplace_back([](chainbase::database& target) { target.add_index<T>(); });
+        detected_index_segment_names.insert(boost::core::demangle(typeid(typename chainbase::generic_index<T>::value_type).name()));
         const std::string index_name = boost::core::demangle(typeid(T).name());
         // ilog("Index: ${index} is in the shared memory file", ("index", index_name));
         return index_name;
@@ -277,13 +291,14 @@ namespace shared_memory_file_util
 
   App::App(const boost::filesystem::path &_path_to_shared_memory_file_dir, const boost::filesystem::path &_output_dir, const bool _get_all_data,
         const bool _get_decoded_state_objects_data, const bool _get_details, const bool _get_blockchain_config, const bool _list_plugins,
-        const bool _list_indices, const bool _dump_indices, const uint8_t _dump_threads)
+        const bool _list_indices, const bool _dump_indices, const uint8_t _dump_threads, const bool _compact, const size_t _compact_file_size)
       : output_dir(_output_dir), extract_all_data(_get_all_data), extract_decoded_state_objects_data(_get_decoded_state_objects_data),
         extract_shm_details(_get_details), extract_blockchain_config(_get_blockchain_config), list_plugins(_list_plugins),
-        list_indices(_list_indices), dump_indices(_dump_indices), dump_threads(_dump_threads)
+        list_indices(_list_indices), dump_indices(_dump_indices), dump_threads(_dump_threads),
+        compact(_compact), compact_file_size(_compact_file_size)
   {
-    if (extract_all_data || dump_indices)
-      FC_ASSERT(output_dir != fc::path(), "If extracting all data or dumping indices, output directory must be specified");
+    if (extract_all_data || dump_indices || compact)
+      FC_ASSERT(output_dir != fc::path(), "If extracting all data, dumping indices or compacting, output directory must be specified");
 
     if (output_dir != fc::path())
     {
@@ -464,6 +479,44 @@ namespace shared_memory_file_util
     dlog("Dumping indicies finished.");
   }
 
+  void App::compact_shared_memory_file()
+  {
+    hive::chain::util::verify_shared_memory_compactable(db, detected_index_segment_names);
+
+    const fc::path target_dir = fc::absolute(output_dir);
+    FC_ASSERT(!fc::exists(target_dir / "shared_memory.bin"), "${target_dir} already contains shared memory file.", (target_dir));
+
+    // objects put one after another need about as much memory as live ones in source, plus room for index headers
+    const size_t used_size = db.get_max_memory() - db.get_free_memory();
+    const size_t target_size = compact_file_size ? compact_file_size : used_size + used_size / 8 + 16 * 1024 * 1024;
+    ilog("Compacting shared memory file: ${used_size} bytes in use out of ${file_size}, new file size: ${target_size}",
+      (used_size)("file_size", db.get_max_memory())(target_size));
+
+    chainbase::database target;
+    target.open(target_dir, 0, target_size);
+    for (const auto& add_index : detected_index_adders)
+      add_index(target);
+
+    try
+    {
+      hive::chain::util::compact_shared_memory(db, target);
+    }
+    catch (const boost::interprocess::bad_alloc&)
+    {
+      FC_THROW("New shared memory file of ${target_size} bytes is too small, use --compact-file-size to set bigger size.", (target_size));
+    }
+
+    const size_t compacted_used_size = target.get_max_memory() - target.get_free_memory();
+    target.flush();
+    target.close();
+
+    std::stringstream ss;
+    ss << "Compacted shared memory file written to " << target_dir.generic_string() << "\n"
+       << "before: file size " << db.get_max_memory() << " bytes, in use " << used_size << " bytes\n"
+       << "after:  file size " << target_size << " bytes, in use " << compacted_used_size << " bytes\n";
+    std::cout << ss.str();
+  }
+
   void App::read_blockchain_config() const
   {
     const std::string blockchain_config_pretty = fc::json::to_pretty_string(fc::json::from_string(db.get_blockchain_config_from_shm(), fc::json::format_validation_mode::full));
@@ -480,7 +533,7 @@ namespace shared_memory_file_util
   {
     const auto started_at = std::chrono::steady_clock::now();
 
-    if (extract_all_data || list_indices || dump_indices)
+    if (extract_all_data || list_indices || dump_indices || compact)
       initialize_indices();
 
     if (extract_all_data || extract_decoded_state_objects_data)
@@ -498,6 +551,9 @@ namespace shared_memory_file_util
     if (extract_all_data || dump_indices)
       perform_dump_indices();
 
+    if (compact)
+      compact_shared_memory_file();
+
     const auto ended_at = std::chrono::steady_clock::now();
     dlog("Work finished in ${seconds} seconds.", ("seconds", std::chrono::duration_cast<std::chrono::seconds>(ended_at - started_at).count()));
   }
@@ -519,6 +575,8 @@ int main(int argc, char **argv)
   shared_memory_file_util_options.add_options()("list-indices", "List all indices detected in shared memory file");
   shared_memory_file_util_options.add_options()("dump-indices", "Dump data from all indices into files.");
   shared_memory_file_util_options.add_options()("dump-threads", boost::program_options::value<unsigned>()->value_name("Number")->default_value(1), "Number of threads for dumping process. (Max 16)");
+  shared_memory_file_util_options.add_options()("compact", "Rebuilds shared memory file into output directory, with objects of each index packed next to each other (without memory freed in source) and file shrunk to size of live data.");
+  shared_memory_file_util_options.add_options()("compact-file-size", boost::program_options::value<std::string>()->value_name("Size"), "Size of compacted shared memory file (f.e. 24G). By default live size of source file with some margin.");
 
   try
   {
@@ -572,6 +630,8 @@ int main(int argc, char **argv)
     if (dump_threads > 16)
       FC_THROW("dump_threads: ${dump_threads} exceeds limit - only 16 is allowed.", (dump_threads));
 
+    const size_t compact_file_size = options_map.count("compact-file-size") ? fc::parse_size(options_map["compact-file-size"].as<std::string>()) : 0;
+
     shared_memory_file_util::App app(options_map["input"].as<boost::filesystem::path>(),         // _path_to_shared_memory_file_dir
                                      options_map.count("output") ? options_map["output"].as<boost::filesystem::path>() : boost::filesystem::path(),        // _output_dir
                                      options_map.count("get-all-data") ? true : false,           // _get_all_data
@@ -581,7 +641,9 @@ int main(int argc, char **argv)
                                      options_map.count("list-plugins") ? true : false,           // _list_plugins
                                      options_map.count("list-indices") ? true : false,           // _list_indices
                                      options_map.count("dump-indices") ? true : false,           // _dump_indices
-                                     static_cast<uint8_t>(dump_threads)                          // _dump_threads
+                                     static_cast<uint8_t>(dump_threads),                         // _dump_threads
+                                     options_map.count("compact") ? true : false,                // _compact
+                                     compact_file_size                                           // _compact_file_size
     );
 
     app.work();
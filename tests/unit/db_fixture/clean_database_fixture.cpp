@@ -33,6 +33,9 @@ clean_database_fixture::clean_database_fixture(
         config_line_t( { "shared-file-size",
           { std::to_string( 1024 * 1024 * shared_file_size_in_mb ) } }
         ),
+        config_line_t( { "shared-file-in-memory",
+          { "true" } }
+        ),
         config_line_t( { "block-log-split",
           { std::to_string( block_log_split ) } }
         )
@@ -47,6 +50,9 @@ clean_database_fixture::clean_database_fixture(
         config_line_t( { "shared-file-size",
           { std::to_string( 1024 * 1024 * shared_file_size_in_mb ) } }
         ),
+        config_line_t( { "shared-file-in-memory",
+          { "true" } }
+        ),
         config_line_t( { "block-log-split",
           { std::to_string( block_log_split ) } }
         )
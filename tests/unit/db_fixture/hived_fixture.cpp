@@ -10,10 +10,42 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <algorithm>
+#include <filesystem>
+
 namespace bpo = boost::program_options;
 
 namespace hive { namespace chain {
 
+namespace {
+
+std::string get_data_dir_arg( int argc, char** argv )
+{
+  std::string data_dir;
+  for( int i = 1; i + 1 < argc; ++i )
+  {
+    const std::string arg = argv[ i ];
+    if( arg == "--data-dir" || arg == "-d" )
+      data_dir = argv[ i + 1 ];
+  }
+  FC_ASSERT( !data_dir.empty() );
+  return data_dir;
+}
+
+void copy_base_block_log( const fc::path& from, const fc::path& to )
+{
+  fc::create_directories( to );
+  for( const auto& entry : std::filesystem::directory_iterator( from.string() ) )
+  {
+    const std::string name = entry.path().filename().string();
+    if( entry.is_regular_file() && name.rfind( "shared_memory", 0 ) != 0 )
+      std::filesystem::copy_file( entry.path(), std::filesystem::path( to.string() ) / name,
+        std::filesystem::copy_options::overwrite_existing );
+  }
+}
+
+} // namespace
+
 hived_fixture::hived_fixture( bool remove_db_files /*= true*/, bool disable_p2p /*= true*/)
   : _disable_p2p( disable_p2p ), _remove_db_files( remove_db_files )
 {}
@@ -76,6 +108,19 @@ void hived_fixture::postponed_init_impl( bool remove_db_files, config_arg_overri
         { "rc-stats-report-type", { "NONE" } }
       };
 
+      if( !_base_state_dir.empty() )
+      {
+        BOOST_REQUIRE_MESSAGE( std::none_of( config_arg_overrides.cbegin(), config_arg_overrides.cend(),
+          []( const config_arg_override_t::value_type& item ) { return item.first == "shared-file-dir"; } ),
+          "Fixture started from base state must not use its own shared-file-dir" );
+        // block log has to match the state, so it is copied (state itself is used in place)
+        copy_base_block_log( _base_state_dir / "blockchain", fc::path( get_data_dir_arg( argc, argv ) ) / "blockchain" );
+        config_arg_overrides.emplace_back( config_arg_override_t::value_type(
+          { "shared-file-dir", { ( _base_state_dir / "blockchain" ).string() } } ) );
+        config_arg_overrides.emplace_back( config_arg_override_t::value_type(
+          { "shared-file-copy-on-write", { "true" } } ) );
+      }
+
       if (std::find_if(config_arg_overrides.cbegin(), config_arg_overrides.cend(),
           [=](const config_arg_override_t::value_type& item) -> bool { return item.first == "shared-file-size"; }) == config_arg_overrides.cend())
       {
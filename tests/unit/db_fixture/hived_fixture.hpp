@@ -65,6 +65,13 @@ struct hived_fixture : public database_fixture
   void set_data_dir( const std::string& data_dir ) { _data_dir = data_dir; };
   const fc::path& get_data_dir() const { return _data_dir; };
 
+  /**
+   * When called prior to postponed_init, node starts from the state of other (already stopped) node with given
+   * data dir - its shared memory file is mapped copy-on-write and its block log is copied. The prepared state is
+   * never modified, so it can be reused by any number of fixtures (also in parallel processes).
+   */
+  void set_base_state( const fc::path& base_data_dir ) { _base_state_dir = base_data_dir; };
+
   const hive::chain::block_read_i& get_block_reader() const;
   virtual hive::plugins::chain::chain_plugin& get_chain_plugin() const override;
 
@@ -76,6 +83,7 @@ struct hived_fixture : public database_fixture
     hive::plugins::chain::chain_plugin* _chain = nullptr;
     const hive::chain::block_read_i* _block_reader = nullptr;
     bool _remove_db_files = true;
+    fc::path _base_state_dir;
 };
 
 namespace test
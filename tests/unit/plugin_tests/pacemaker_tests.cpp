@@ -6,6 +6,8 @@
 
 #include <hive/plugins/pacemaker/pacemaker_plugin.hpp>
 
+#include <fc/io/json.hpp>
+
 #include "../db_fixture/hived_fixture.hpp"
 
 using namespace hive::chain;
@@ -175,5 +177,67 @@ BOOST_AUTO_TEST_CASE( pacemaker_basic_test )
   FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE( pacemaker_benchmark_test )
+{
+  try
+  {
+    const int ALL_BLOCKS = HIVE_MAX_WITNESSES + 20;
+    const int LAST_BLOCK = ALL_BLOCKS - 5;
+    const int TX_COUNT = 10;
+
+    initialize( [&]( hived_fixture& builder )
+    {
+      builder.generate_blocks( HIVE_MAX_WITNESSES );
+      for( int i = 0; i < TX_COUNT; ++i )
+      {
+        custom_json_operation op;
+        op.required_auths.insert( HIVE_INIT_MINER_NAME );
+        op.id = "benchmark";
+        op.json = "{\"i\":" + std::to_string( i ) + "}";
+
+        hive::protocol::signed_transaction tx;
+        tx.set_expiration( builder.db->head_block_time() + HIVE_MAX_TIME_UNTIL_EXPIRATION );
+        tx.operations.push_back( op );
+        builder.push_transaction( tx, init_account_priv_key );
+        if( i % 2 )
+          builder.generate_block();
+      }
+      builder.generate_blocks( ALL_BLOCKS - builder.db->head_block_num() );
+    },
+    - 2 * ALL_BLOCKS * HIVE_BLOCK_INTERVAL, // historical blocks, they will be emitted on virtual clock
+    {
+      config_line_t( { "pacemaker-speed-up", { "20" } } ),
+      config_line_t( { "pacemaker-last-block", { std::to_string( LAST_BLOCK ) } } ),
+      config_line_t( { "pacemaker-benchmark-report", { "benchmark.json" } } ),
+      config_line_t( { "pacemaker-inject-ahead", { "2" } } ),
+      config_line_t( { "pacemaker-api-threads", { "2" } } )
+    } );
+
+    // pacemaker requests interrupt once last block is emitted and writes report during shutdown
+    theApp.wait4interrupt_request();
+    theApp.quit( true );
+    db = nullptr; // prevent fixture destructor from accessing database after it was closed
+
+    fc::path report_file = get_data_dir() / "benchmark.json";
+    BOOST_REQUIRE( fc::exists( report_file ) );
+    auto report = fc::json::from_file( report_file, fc::json::format_validation_mode::full ).get_object();
+    ilog( "Benchmark report: ${r}", ( "r", report ) );
+
+    BOOST_REQUIRE_EQUAL( report[ "first_block" ].as< uint32_t >(), 1u );
+    BOOST_REQUIRE_EQUAL( report[ "last_block" ].as< uint32_t >(), uint32_t( LAST_BLOCK ) );
+    BOOST_REQUIRE_EQUAL( report[ "blocks" ].as< uint32_t >(), uint32_t( LAST_BLOCK ) );
+    BOOST_REQUIRE_EQUAL( report[ "failed_blocks" ].as< uint32_t >(), 0u );
+    BOOST_REQUIRE_EQUAL( report[ "block_apply" ].get_object()[ "count" ].as< uint32_t >(), uint32_t( LAST_BLOCK ) );
+    BOOST_REQUIRE_GT( report[ "write_lock_hold" ].get_object()[ "count" ].as< uint32_t >(), 0u );
+    BOOST_REQUIRE_GT( report[ "api_call" ].get_object()[ "count" ].as< uint32_t >(), 0u );
+    const auto& transactions = report[ "transactions" ].get_object();
+    BOOST_REQUIRE_EQUAL( transactions[ "injected" ].as< uint32_t >() + transactions[ "injection_failed" ].as< uint32_t >(),
+      uint32_t( TX_COUNT ) );
+    // with the speed up whole range should take few seconds, not original 3s per block
+    BOOST_REQUIRE_LT( report[ "wall_time_us" ].as< int64_t >(), int64_t( LAST_BLOCK ) * HIVE_BLOCK_INTERVAL * 1000000 / 2 );
+  }
+  FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 #endif
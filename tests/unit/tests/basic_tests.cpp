@@ -56,11 +56,14 @@
 #include <fc/reflect/typename.hpp>
 #include <fc/static_variant.hpp>
 #include <fc/optional.hpp>
+#include <fc/io/json_decode.hpp>
 #include "../db_fixture/clean_database_fixture.hpp"
 
 #include <algorithm>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>
 
 using namespace hive;
 using namespace hive::chain;
@@ -84,6 +87,17 @@ struct dummy : public object< 1111, dummy >
   CHAINBASE_OBJECT( dummy );
   };
 
+struct observer_test_plugin : appbase::plugin< observer_test_plugin >
+{
+  static const std::string& name() { static std::string name = "observer_test"; return name; }
+private: //only needed for registration of observers
+  virtual void set_program_options( appbase::options_description& cli, appbase::options_description& cfg ) override {}
+  virtual void plugin_for_each_dependency( plugin_processor&& processor ) override {}
+  virtual void plugin_initialize( const appbase::variables_map& options ) override {}
+  virtual void plugin_startup() override {}
+  virtual void plugin_shutdown() override {}
+};
+
 struct __test_for_alignment
 {
   char            m1;
@@ -93,11 +107,28 @@ struct __test_for_alignment
   char            m5;
 };
 
+struct __test_json_direct_decode
+{
+  vector< account_name_type > accounts;
+  uint32_t                    limit = 7;
+  int16_t                     offset = 0;
+  fc::optional< bool >        active;
+  vector< std::pair< account_name_type, string > > comments;
+  asset                       amount;
+  fc::variant                 start;
+};
+
 }
 
+FC_REFLECT( __test_json_direct_decode, (accounts)(limit)(offset)(active)(comments)(amount)(start) )
+FC_JSON_DIRECT_DECODE( __test_json_direct_decode )
+
+using __test_boxed_static_variant = fc::static_variant<int, __test_for_alignment, std::string>;
+
 namespace fc
 {
 template<> struct get_typename<__test_for_alignment> { static const char* name() { return "__test_for_alignment"; } };
+template<> struct static_variant_storage_traits<__test_boxed_static_variant> { static constexpr size_t inline_capacity = sizeof(std::string); };
 }
 
 BOOST_FIXTURE_TEST_SUITE( basic_tests, clean_database_fixture )
@@ -820,6 +851,49 @@ BOOST_AUTO_TEST_CASE( fc_static_variant_alignment )
   BOOST_CHECK_EQUAL( t[0].get<__test_for_alignment>().m4, t[1].get<__test_for_alignment>().m2 );
 }
 
+BOOST_AUTO_TEST_CASE( fc_static_variant_boxed_alternatives )
+{
+  BOOST_CHECK_EQUAL( sizeof(__test_boxed_static_variant), 8u + sizeof(std::string) );
+  BOOST_CHECK_EQUAL( alignof(__test_boxed_static_variant), 8u );
+  BOOST_CHECK_EQUAL( sizeof(hive::protocol::operation), 128u ); //big operations are kept outside
+
+  __test_boxed_static_variant t[2];
+  t[0] = __test_for_alignment();
+  t[0].get<__test_for_alignment>().m2 = 7;
+  t[1] = t[0];
+  t[0].get<__test_for_alignment>().m2 = 8;
+  BOOST_CHECK_EQUAL( t[1].get<__test_for_alignment>().m2, 7 );
+  BOOST_CHECK_EQUAL( t[1].get<__test_for_alignment>().m4, 4 );
+  BOOST_CHECK_EQUAL( t[0].get<__test_for_alignment>().m2, 8 );
+
+  // moving boxed alternative takes over its allocation instead of allocating new one
+  const __test_for_alignment* boxed = &t[1].get<__test_for_alignment>();
+  __test_boxed_static_variant moved( std::move( t[1] ) );
+  BOOST_CHECK_EQUAL( &moved.get<__test_for_alignment>(), boxed );
+  BOOST_CHECK_EQUAL( moved.get<__test_for_alignment>().m2, 7 );
+  __test_boxed_static_variant move_assigned;
+  move_assigned = std::move( moved );
+  BOOST_CHECK_EQUAL( &move_assigned.get<__test_for_alignment>(), boxed );
+  BOOST_CHECK_EQUAL( move_assigned.get<__test_for_alignment>().m4, 4 );
+  moved = __test_for_alignment(); // moved-from variant can be assigned to
+  BOOST_CHECK_EQUAL( moved.get<__test_for_alignment>().m2, 2 );
+  t[1] = std::string( "inline" );
+  BOOST_CHECK_EQUAL( t[1].get<std::string>(), "inline" );
+  t[0] = t[1];
+  BOOST_CHECK_EQUAL( t[0].get<std::string>(), "inline" );
+
+  vote_operation vote;
+  vote.voter = "alice";
+  account_create_operation create;
+  create.new_account_name = "bob";
+  vector< operation > ops = { vote, create };
+  vector< operation > decoded;
+  fc::raw::unpack_from_vector( fc::raw::pack_to_vector( ops ), decoded );
+  BOOST_REQUIRE_EQUAL( decoded.size(), 2u );
+  BOOST_CHECK( decoded[0].get< vote_operation >().voter == "alice" );
+  BOOST_CHECK( decoded[1].get< account_create_operation >().new_account_name == "bob" );
+}
+
 BOOST_AUTO_TEST_CASE( fc_optional_alignment )
 {
   using test_optional = fc::optional<__test_for_alignment>;
@@ -984,6 +1058,48 @@ BOOST_AUTO_TEST_CASE( fc_json_is_valid )
   BOOST_CHECK(!fc::json::is_valid("[\"object_1\" \"object_2\" \"object_3\" \"object_4\"]", fc::json::format_validation_mode::full));
 }
 
+BOOST_AUTO_TEST_CASE( fc_json_direct_decode )
+{
+  const auto decode = []( const std::string& json )
+  {
+    __test_json_direct_decode result;
+    fc::json::read( json, [&]( fc::json_value_reader& reader ) { fc::json_decode( reader, result ); } );
+    return fc::json::to_string( result );
+  };
+  const auto from_variant = []( const std::string& json )
+  {
+    return fc::json::to_string( fc::json::from_string( json, fc::json::format_validation_mode::full ).as< __test_json_direct_decode >() );
+  };
+
+  for( const std::string& json : {
+    std::string( "{}" ),
+    std::string( "{\"accounts\":[\"alice\",\"bob\"],\"limit\":10,\"offset\":-2,\"active\":true}" ),
+    std::string( "{\"limit\":\"42\",\"offset\":\"-3\",\"active\":null,\"unknown\":{\"a\":[1,2.5,\"x\"]}}" ),
+    std::string( "{\"comments\":[[\"alice\",\"permlink\"]],\"amount\":{\"amount\":\"1000\",\"precision\":3,\"nai\":\"@@000000021\"}}" ),
+    std::string( "{\"start\":[\"alice\",{\"x\":1}],\"limit\":1,\"limit\":2,\"accounts\":[\"\\u0061lice\"]}" ) } )
+  {
+    BOOST_TEST_MESSAGE( json );
+    BOOST_CHECK_EQUAL( decode( json ), from_variant( json ) );
+  }
+
+  BOOST_CHECK_THROW( decode( "{} {}" ), fc::parse_error_exception );
+  BOOST_CHECK_THROW( decode( "{\"unknown\":tru}" ), fc::parse_error_exception );
+  BOOST_CHECK_THROW( decode( "{\"accounts\":[\"alice\",]}" ), fc::parse_error_exception );
+  BOOST_CHECK_THROW( decode( "{\"accounts\":{}}" ), fc::bad_cast_exception );
+
+  // fragments of a document can be parsed while the outer one is still in use
+  fc::json::read( "{\"id\":1,\"params\":{\"limit\":3}}", [&]( fc::json_value_reader& request )
+  {
+    request.for_each_field( [&]( std::string_view key, fc::json_value_reader& field )
+    {
+      if( key == "params" )
+        BOOST_CHECK_EQUAL( decode( std::string( field.get_raw_json() ) ), from_variant( "{\"limit\":3}" ) );
+      else
+        BOOST_CHECK_EQUAL( field.get_int64(), 1 );
+    } );
+  } );
+}
+
 BOOST_AUTO_TEST_CASE( decoding_types_mechanism_test )
 {
   hive::chain::util::decoded_types_data_storage dtds;
@@ -1853,4 +1969,121 @@ BOOST_AUTO_TEST_CASE( authorization_redirections )
 #undef CREATE_ACCOUNT
 }
 
+BOOST_AUTO_TEST_CASE( operation_profiler_attribution )
+{
+  try
+  {
+    BOOST_TEST_MESSAGE( "--- Testing: operation_profiler_attribution" );
+
+    ACTORS( (alice)(bob) )
+    fund( "alice", ASSET( "10.000 TESTS" ) );
+    generate_block();
+
+    auto& profiler = db->get_operation_profiler();
+    BOOST_REQUIRE( !profiler.is_enabled() );
+    BOOST_REQUIRE( profiler.get_entries().empty() );
+
+    profiler.set_enabled( true );
+    transfer( "alice", "bob", ASSET( "1.000 TESTS" ), "", alice_private_key );
+    generate_block();
+    profiler.set_enabled( false );
+
+    const auto find_entry = []( const std::vector< util::operation_profiler::entry >& entries,
+      const std::string& operation, const std::string& phase ) -> const util::operation_profiler::entry*
+    {
+      for( const auto& e : entries )
+        if( e.operation == operation && e.phase == phase )
+          return &e;
+      return nullptr;
+    };
+
+    const auto entries = profiler.get_entries();
+    const auto* evaluator = find_entry( entries, "transfer_operation", "evaluator" );
+    BOOST_REQUIRE( evaluator != nullptr );
+    BOOST_REQUIRE_GT( evaluator->count, 0u );
+    BOOST_REQUIRE_GE( evaluator->time_ns, evaluator->self_time_ns );
+    BOOST_REQUIRE( find_entry( entries, "transfer_operation", "rc" ) != nullptr );
+    BOOST_REQUIRE( find_entry( entries, "transaction", "rc" ) != nullptr );
+    for( const auto& e : entries )
+      BOOST_REQUIRE_EQUAL( e.plugin.empty(), e.phase != "pre" && e.phase != "post" );
+    BOOST_REQUIRE( profiler.get_folded_stacks().find( "transfer_operation;evaluator " ) != std::string::npos );
+
+    /// nothing is measured while disabled
+    transfer( "alice", "bob", ASSET( "1.000 TESTS" ), "", alice_private_key );
+    generate_block();
+    BOOST_REQUIRE_EQUAL( find_entry( profiler.get_entries(), "transfer_operation", "evaluator" )->count, evaluator->count );
+
+    profiler.reset();
+    BOOST_REQUIRE( profiler.get_entries().empty() );
+    BOOST_REQUIRE( profiler.get_folded_stacks().empty() );
+  }
+  FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( notification_observers_delivery )
+{
+  try
+  {
+    BOOST_TEST_MESSAGE( "--- Testing: notification_observers_delivery" );
+
+    ACTORS( (alice)(bob) )
+    fund( "alice", ASSET( "10.000 TESTS" ) );
+    generate_block();
+
+    observer_test_plugin plugin;
+    // below are only touched by observer thread until flush_observers()
+    std::set< std::thread::id > threads;
+    std::vector< std::string > memos;
+    std::vector< uint32_t > blocks;
+    std::vector< const block_observation* > block_copies, failing_copies;
+    bool thrown = false;
+
+    auto operation_conn = db->add_post_apply_operation_observer( [&]( const operation_observation& note )
+    {
+      threads.insert( std::this_thread::get_id() );
+      if( note.op.which() == operation::tag< transfer_operation >::value )
+        memos.push_back( note.op.get< transfer_operation >().memo );
+    }, plugin );
+    auto block_conn = db->add_post_apply_block_observer( [&]( const block_observation& note )
+    {
+      threads.insert( std::this_thread::get_id() );
+      blocks.push_back( note.full_block->get_block_num() == note.block_num ? note.block_num : 0 );
+      block_copies.push_back( &note );
+    }, plugin );
+    auto failing_conn = db->add_post_apply_block_observer( [&]( const block_observation& note )
+    {
+      failing_copies.push_back( &note );
+      if( !thrown )
+      {
+        thrown = true;
+        FC_ASSERT( false, "observer failure must not affect block processing" );
+      }
+    }, plugin );
+
+    const uint32_t first_block = db->head_block_num() + 1;
+    transfer( "alice", "bob", ASSET( "1.000 TESTS" ), "observed", alice_private_key );
+    generate_blocks( 3 );
+    db->flush_observers();
+
+    BOOST_REQUIRE( thrown );
+    BOOST_REQUIRE_EQUAL( threads.size(), 1u );
+    BOOST_REQUIRE( *threads.begin() != std::this_thread::get_id() );
+    // operation of pending transaction is observed once, when its block is applied
+    BOOST_REQUIRE_EQUAL( std::count( memos.begin(), memos.end(), "observed" ), 1 );
+    BOOST_REQUIRE_EQUAL( blocks.size(), 3u );
+    for( uint32_t i = 0; i < blocks.size(); ++i )
+      BOOST_REQUIRE_EQUAL( blocks[i], first_block + i );
+    // all observers of given notification share the same copy of it
+    BOOST_REQUIRE( block_copies == failing_copies );
+
+    chain::util::disconnect_signal( operation_conn );
+    chain::util::disconnect_signal( block_conn );
+    chain::util::disconnect_signal( failing_conn );
+    db->flush_observers();
+    generate_block();
+    BOOST_REQUIRE_EQUAL( blocks.size(), 3u );
+  }
+  FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2050,6 +2050,86 @@ BOOST_AUTO_TEST_CASE(import_keys)
   } FC_LOG_AND_RETHROW()
 }
 
+BOOST_AUTO_TEST_CASE(sign_digests)
+{
+  try
+  {
+    test_utils::beekeeper_mgr b_mgr;
+    b_mgr.remove_wallets();
+
+    const uint64_t _timeout = 90;
+    const uint32_t _session_limit = 64;
+    auto _prefix = "STM";
+
+    appbase::application app;
+
+    beekeeper_wallet_manager _beekeeper = b_mgr.create_wallet( app, _timeout, _session_limit );
+    BOOST_REQUIRE( _beekeeper.start() );
+
+    auto _token = _beekeeper.create_session( "salt", std::optional<std::string>() );
+
+    const std::string _wallet_name = "wallet-0";
+    const std::string _wallet_name_2 = "wallet-1";
+
+    _beekeeper.create( _token, _wallet_name, std::optional<std::string>(), false/*is_temporary*/ );
+    _beekeeper.create( _token, _wallet_name_2, std::optional<std::string>(), false/*is_temporary*/ );
+
+    const size_t _nr_keys = 8;
+    std::vector<public_key_type> _public_keys;
+
+    for( size_t i = 0; i < _nr_keys; ++i )
+    {
+      auto _priv = fc::ecc::private_key::generate();
+      _beekeeper.import_key( _token, ( i % 2 ) ? _wallet_name : _wallet_name_2, _priv.key_to_wif(), _prefix );
+      _public_keys.emplace_back( _priv.get_public_key() );
+    }
+
+    const size_t _nr_digests = 500;
+    std::vector<std::pair<std::string, public_key_type>> _digests;
+
+    for( size_t i = 0; i < _nr_digests; ++i )
+      _digests.emplace_back( fc::sha256::hash( std::to_string( i ) ).str(), _public_keys[ i % _nr_keys ] );
+
+    {
+      BOOST_TEST_MESSAGE( "Keys are searched in all unlocked wallets" );
+      auto _signatures = _beekeeper.sign_digests( _token, std::optional<std::string>(), _digests, _prefix );
+      BOOST_REQUIRE_EQUAL( _signatures.size(), _nr_digests );
+
+      for( size_t i = 0; i < _nr_digests; ++i )
+      {
+        auto _signature = _beekeeper.sign_digest( _token, std::optional<std::string>(), _digests[i].first, _digests[i].second, _prefix );
+        BOOST_REQUIRE( _signatures[i] == _signature );
+      }
+    }
+    {
+      BOOST_TEST_MESSAGE( "Keys from other wallet are not visible when a wallet is given" );
+      BOOST_REQUIRE_THROW( _beekeeper.sign_digests( _token, _wallet_name, _digests, _prefix ), fc::exception );
+
+      std::vector<std::pair<std::string, public_key_type>> _digests_wallet;
+      for( size_t i = 1; i < _nr_digests; i += 2 )
+        _digests_wallet.emplace_back( _digests[i] );
+
+      auto _signatures = _beekeeper.sign_digests( _token, _wallet_name, _digests_wallet, _prefix );
+      BOOST_REQUIRE_EQUAL( _signatures.size(), _digests_wallet.size() );
+      for( size_t i = 0; i < _digests_wallet.size(); ++i )
+        BOOST_REQUIRE( _signatures[i] == _beekeeper.sign_digest( _token, _wallet_name, _digests_wallet[i].first, _digests_wallet[i].second, _prefix ) );
+    }
+    {
+      BOOST_TEST_MESSAGE( "Unknown key or invalid digest rejects whole batch" );
+      auto _digests_unknown = _digests;
+      _digests_unknown.emplace_back( fc::sha256::hash( "unknown" ).str(), fc::ecc::private_key::generate().get_public_key() );
+      BOOST_REQUIRE_THROW( _beekeeper.sign_digests( _token, std::optional<std::string>(), _digests_unknown, _prefix ), fc::exception );
+
+      auto _digests_invalid = _digests;
+      _digests_invalid.emplace_back( "", _public_keys[0] );
+      BOOST_REQUIRE_THROW( _beekeeper.sign_digests( _token, std::optional<std::string>(), _digests_invalid, _prefix ), fc::exception );
+
+      BOOST_REQUIRE_THROW( _beekeeper.sign_digests( _token, std::optional<std::string>(), {}, _prefix ), fc::exception );
+    }
+
+  } FC_LOG_AND_RETHROW()
+}
+
 BOOST_AUTO_TEST_CASE(has_wallet)
 {
   try
@@ -1,11 +1,18 @@
 #ifdef IS_TEST_NET
 #include <boost/test/unit_test.hpp>
 
+#include <hive/chain/hive_fwd.hpp>
+
 #include <hive/chain/block_log.hpp>
 #include <hive/chain/block_storage_interface.hpp>
+#include <hive/chain/block_summary_object.hpp>
+#include <hive/chain/irreversible_block_data.hpp>
+#include <hive/chain/util/shared_memory_compaction.hpp>
 #include <hive/plugins/state_snapshot/state_snapshot_plugin.hpp>
 #include <hive/plugins/block_api/block_api.hpp>
 
+#include <fc/bitutil.hpp>
+
 #include "../db_fixture/hived_fixture.hpp"
 
 using namespace hive::chain;
@@ -1085,5 +1092,183 @@ BOOST_AUTO_TEST_CASE( snapshot_replay_split_to_zero )
   }
 }
 
+BOOST_AUTO_TEST_CASE( copy_on_write_base_state )
+{
+  try {
+    ilog( "Testing fixtures started from prepared copy-on-write state." );
+
+    fc::temp_directory base_dir( hive::utilities::temp_directory_path() );
+    uint32_t base_lib = 0;
+    { // Prepare base state once.
+      hived_fixture fixture( true /*remove blockchain*/ );
+      fixture.set_data_dir( base_dir.path().string() );
+      fixture.postponed_init();
+      for( int i = 0; i < 10; ++i )
+        fixture.generate_block();
+      base_lib = fixture.db->get_last_irreversible_block_num();
+    }
+
+    for( int run = 0; run < 2; ++run )
+    {
+      fc::temp_directory clone_dir( hive::utilities::temp_directory_path() );
+      hived_fixture fixture( true /*remove blockchain*/ );
+      fixture.set_data_dir( clone_dir.path().string() );
+      fixture.set_base_state( base_dir.path() );
+      fixture.postponed_init();
+
+      // Every clone starts from the same state, regardless of what previous one did.
+      BOOST_REQUIRE_EQUAL( fixture.db->get_last_irreversible_block_num(), base_lib );
+      BOOST_REQUIRE_EQUAL( fixture.get_block_reader().head_block()->get_block_num(), base_lib );
+      const uint32_t head = fixture.db->head_block_num();
+      for( int i = 0; i < 5; ++i )
+        fixture.generate_block();
+      BOOST_REQUIRE_EQUAL( fixture.db->head_block_num(), head + 5 );
+    }
+  } catch (fc::exception& e) {
+    edump((e.to_detail_string()));
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( artifacts_remap_and_truncate )
+{
+  try {
+    appbase::application app;
+    hive::chain::blockchain_worker_thread_pool thread_pool = hive::chain::blockchain_worker_thread_pool( app );
+    fc::temp_directory data_dir( hive::utilities::temp_directory_path() );
+    const fc::path log_path = data_dir.path() / block_log_file_name_info::_legacy_file_name;
+
+    block_log log( app );
+    log.open( log_path, thread_pool, false /*read_only*/, false /*write_fallback*/, false /*auto_open_artifacts*/ );
+    auto artifacts = block_log_artifacts::open( log_path, log, false /*read_only*/, false /*write_fallback*/,
+      false /*full_match_verification*/, app, thread_pool );
+
+    auto make_id = []( uint32_t block_num )
+    {
+      block_id_type id;
+      id._hash[0] = fc::endian_reverse_u32( block_num );
+      id._hash[1] = block_num;
+      return id;
+    };
+    auto position = []( uint32_t block_num ) { return uint64_t( block_num ) * 100; };
+
+    // enough blocks for the file to outgrow initial mapping of writable artifacts (64MB), so it is remapped
+    const uint32_t block_count = 3000000;
+    block_log_artifacts::artifact_data_container_t batch;
+    for( uint32_t block_num = 1; block_num <= block_count; ++block_num )
+    {
+      batch.emplace_back( block_num, position( block_num ), block_log_artifacts::block_attributes_t(), make_id( block_num ) );
+      if( batch.size() == 100000 )
+      {
+        artifacts->store_block_artifacts( batch, false /*is_at_live_sync*/ );
+        batch.clear();
+      }
+    }
+    BOOST_REQUIRE_EQUAL( artifacts->read_head_block_num(), block_count );
+
+    for( uint32_t block_num : { 1u, 2u, block_count / 2, block_count - 1 } )
+    {
+      const auto block_artifacts = artifacts->read_block_artifacts( block_num );
+      BOOST_CHECK_EQUAL( block_artifacts.block_log_file_pos, position( block_num ) );
+      BOOST_CHECK( block_artifacts.block_id == make_id( block_num ) );
+      BOOST_CHECK_EQUAL( block_artifacts.block_serialized_data_size, 100 - sizeof( uint64_t ) );
+    }
+    BOOST_CHECK_EQUAL( artifacts->read_block_artifacts( block_count - 100, 99 ).size(), 99u );
+
+    // chunks past new end of file are still covered by the mapping, but reading them would raise SIGBUS
+    const uint32_t new_head = 1000;
+    artifacts->truncate( new_head );
+    BOOST_REQUIRE_EQUAL( artifacts->read_head_block_num(), new_head );
+    BOOST_CHECK_EQUAL( artifacts->read_block_artifacts( new_head - 1 ).block_log_file_pos, position( new_head - 1 ) );
+    BOOST_CHECK_THROW( artifacts->read_block_artifacts( block_count / 2 ), fc::assert_exception );
+    BOOST_CHECK_THROW( artifacts->read_block_artifacts( new_head - 10, 20 ), fc::assert_exception );
+
+    // file grows again from the new head
+    for( uint32_t block_num = new_head + 1; block_num <= new_head + 10; ++block_num )
+      artifacts->store_block_artifacts( block_num, position( block_num ), block_log_artifacts::block_attributes_t(),
+        make_id( block_num ), true /*is_at_live_sync*/ );
+    BOOST_CHECK_EQUAL( artifacts->read_block_artifacts( new_head + 5 ).block_log_file_pos, position( new_head + 5 ) );
+  } catch (fc::exception& e) {
+    edump((e.to_detail_string()));
+    throw;
+  }
+}
+
+BOOST_AUTO_TEST_CASE( compact_shared_memory_file )
+{
+  try {
+    fc::temp_directory source_dir( hive::utilities::temp_directory_path() );
+    fc::temp_directory target_dir( hive::utilities::temp_directory_path() );
+    const std::set< std::string > index_segment_names = { boost::core::demangle( typeid( block_summary_object ).name() ) };
+
+    auto make_id = []( uint32_t block_num )
+    {
+      block_id_type id;
+      id._hash[0] = fc::endian_reverse_u32( block_num );
+      id._hash[1] = block_num;
+      return id;
+    };
+    const std::string block_bytes = "irreversible block";
+
+    chainbase::database source;
+    source.open( source_dir.path(), 0, 8 * 1024 * 1024 );
+    source.add_index< block_summary_index >();
+    source.with_write_lock( [&]()
+    {
+      // leave holes in the segment
+      for( uint32_t i = 0; i < 1000; ++i )
+        source.create< block_summary_object >( [&]( block_summary_object& o ) { o.block_id = make_id( i ); } );
+      for( uint32_t i = 0; i < 1000; i += 3 )
+        source.remove( source.get< block_summary_object >( block_summary_object::id_type( i ) ) );
+    } );
+    auto segment_manager = source.get_segment_manager();
+    auto irreversible = segment_manager->construct< irreversible_block_data_type >( "irreversible" )(
+      chainbase::allocator< irreversible_block_data_type >( segment_manager ) );
+    irreversible->_irreversible_block_num = 42;
+    irreversible->_irreversible_block_data._byte_size = block_bytes.size();
+    irreversible->_irreversible_block_data._block_bytes.assign( block_bytes.begin(), block_bytes.end() );
+    irreversible->_irreversible_block_data._block_id = make_id( 42 );
+
+    // file made by chainbase holds its internal objects ("environment", "format") that compaction accepts
+    hive::chain::util::verify_shared_memory_compactable( source, index_segment_names );
+    BOOST_CHECK_THROW( hive::chain::util::verify_shared_memory_compactable( source, {} ), fc::assert_exception );
+
+    {
+      chainbase::database target;
+      target.open( target_dir.path(), 0, 8 * 1024 * 1024 );
+      target.add_index< block_summary_index >();
+      hive::chain::util::compact_shared_memory( source, target );
+      target.flush();
+      target.close();
+    }
+
+    // compacted file can be opened again and compacted once more
+    chainbase::database target;
+    target.open( target_dir.path() );
+    target.add_index< block_summary_index >();
+    hive::chain::util::verify_shared_memory_compactable( target, index_segment_names );
+
+    const auto& source_index = source.get_index< block_summary_index, by_id >();
+    const auto& target_index = target.get_index< block_summary_index, by_id >();
+    BOOST_REQUIRE_EQUAL( target_index.size(), source_index.size() );
+    for( const auto& o : source_index )
+      BOOST_REQUIRE( target.get< block_summary_object >( o.get_id() ).block_id == o.block_id );
+
+    const auto target_irreversible = target.get_segment_manager()->find< irreversible_block_data_type >( "irreversible" ).first;
+    BOOST_REQUIRE( target_irreversible != nullptr );
+    BOOST_REQUIRE_EQUAL( target_irreversible->_irreversible_block_num, 42u );
+    const auto& target_data = target_irreversible->_irreversible_block_data;
+    BOOST_REQUIRE_EQUAL( target_data._byte_size, block_bytes.size() );
+    BOOST_REQUIRE( std::equal( target_data._block_bytes.begin(), target_data._block_bytes.end(), block_bytes.begin(), block_bytes.end() ) );
+    BOOST_REQUIRE( target_data._block_id == make_id( 42 ) );
+
+    target.close();
+    source.close();
+  } catch (fc::exception& e) {
+    edump((e.to_detail_string()));
+    throw;
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 #endif
@@ -30,6 +30,7 @@
 #include <hive/chain/database.hpp>
 
 #include <hive/protocol/asset.hpp>
+#include <hive/protocol/legacy_json.hpp>
 #include <hive/plugins/condenser_api/condenser_api_legacy_objects.hpp>
 
 #include <fc/crypto/digest.hpp>
@@ -550,6 +551,53 @@ BOOST_AUTO_TEST_CASE( legacy_operation_test )
   FC_LOG_AND_RETHROW();
 }
 
+BOOST_AUTO_TEST_CASE( legacy_json_encode_test )
+{
+  try
+  {
+    // direct encoding has to give exactly the same text as going through variant
+    transfer_operation transfer;
+    transfer.from = "alice";
+    transfer.to = "bob";
+    transfer.amount = asset( 1234, HBD_SYMBOL );
+    transfer.memo = "line\n\"quoted\"\t\x01";
+
+    limit_order_create2_operation order;
+    order.owner = "alice";
+    order.orderid = std::numeric_limits< uint32_t >::max();
+    order.amount_to_sell = asset( 1000, HIVE_SYMBOL );
+    order.exchange_rate = price( asset( 1, HIVE_SYMBOL ), asset( 2, HBD_SYMBOL ) );
+    order.expiration = fc::time_point_sec( 1600000000 );
+
+    comment_options_operation options;
+    options.author = "alice";
+    options.permlink = "test";
+    options.max_accepted_payout = asset( 1000000000, HBD_SYMBOL );
+    comment_payout_beneficiaries beneficiaries;
+    beneficiaries.beneficiaries.push_back( beneficiary_route_type( "bob", HIVE_100_PERCENT ) );
+    options.extensions.insert( beneficiaries );
+
+    account_update_operation update;
+    update.account = "alice";
+    update.owner = authority( 1, public_key_type(), 1, "bob", 2 );
+    update.memo_key = public_key_type();
+
+    interest_operation interest( "alice", asset( 5, HBD_SYMBOL ), true );
+
+    std::vector< operation > ops = { transfer, order, options, update, interest };
+
+    for( auto mode : { transaction_serialization_type::legacy, transaction_serialization_type::hf26 } )
+    {
+      std::vector< serializer_wrapper< std::vector< operation > > > wrapped = { { ops, mode } };
+
+      std::string encoded;
+      fc::json_encode< fc::json_default_format >( encoded, wrapped );
+      BOOST_REQUIRE_EQUAL( encoded, fc::json::to_string( fc::variant( wrapped ) ) );
+    }
+  }
+  FC_LOG_AND_RETHROW();
+}
+
 BOOST_AUTO_TEST_CASE( block_header_test )
 {
   try